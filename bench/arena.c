@@ -0,0 +1,37 @@
+// Florestan's Benchmarks: the arena
+//
+// © dongwanpianist
+//
+// Small-object churn, the work an arena is for: one "request" allocates COUNT blocks of 8 to 256 bytes, writes each,
+// and then lets all of them go, with one arena_reset() ("arena_churn") or one free() per block ("malloc_churn").
+// The arena is warmed up by the first repetitions, so the measurement is of a steady workload that keeps its chunks;
+// with FLORESTAN_TRACKED_ALLOC the blocks carry their headers and the chunks are registered, as they would be.
+
+#include "bench.h"
+#include "florestan/arena.h"
+
+#define __BENCH_ARENA(N, ...) { \
+    size_t n = bench_count(N); \
+    size_t* sizes = bench_array(size_t, n); \
+    char** blocks = bench_array(char*, n); \
+    uint64_t state = N; \
+    size_t bytes = 0; \
+    for (size_t i = 0; i < n; i++) bytes += sizes[i] = 8 + __bench_random(&state) % 249; \
+    memory_arena a; \
+    arena_init(&a, 0); \
+    bench_measure("arena_churn/" #N, bytes, \
+        for (size_t i = 0; i < n; i++) { blocks[i] = arena_new(&a, char, sizes[i]); blocks[i][0] = (char)i; } \
+        bench_keep(blocks[n - 1]); \
+        arena_reset(&a)); \
+    arena_destroy(&a); \
+    bench_measure("malloc_churn/" #N, bytes, \
+        for (size_t i = 0; i < n; i++) { blocks[i] = malloc(sizes[i]); blocks[i][0] = (char)i; } \
+        bench_keep(blocks[n - 1]); \
+        for (size_t i = 0; i < n; i++) free(blocks[i])); \
+    bench_free(sizes); \
+    bench_free(blocks); \
+}
+
+void bench_arena(void) {
+    BENCH_SIZES(__BENCH_ARENA, )
+}
@@ -0,0 +1,147 @@
+// Florestan's Benchmarks
+//
+// © dongwanpianist
+//
+// One executable, florestan_bench, times every type-generic operation of the library for every element type
+// it supports and a few array sizes, with counters_measure(): a warm-up, then one clock reading around each repetition,
+// and the median and the 99th percentile of those kept under a name like "array_sum/int/4096".
+// The results go to one CSV or JSON file (counters_dump), with the hook counters as well when built with FLORESTAN_COUNTERS.
+//
+// Each suite is a bench_<name>() in its own file, listed in main.c; the macros below spell out the types and sizes,
+// so that every (operation, type, size) gets a measurement of its own under a string literal name.
+//
+// 1. BENCH_TYPES(X, ...), BENCH_SOURCES(X, ...)
+//      * X(NAME, TYPE, ...) and X(..., NAME, TYPE) for the 14 element types, in the library's order;
+//        the second list is for the inner loop of a pair of types
+// 2. BENCH_SIZES(X, ...)
+//      * X(COUNT, ...) for 64, 4096 and 262144 elements: in L1, in L2, and out in memory
+//    BENCH_THREADS(X, ...)
+//      * X(THREADS, ...) for pools of 1, 2, 4, ... 64 threads; the suites skip those over bench_threads
+// 3. bench_count(COUNT) -> size_t
+//      * COUNT, out of line: the library sees a count only known at run time, as it would from any caller
+// 4. bench_measure(NAME, BYTES, STATEMENT)
+//      * counters_measure() with as many repetitions as bench_repetitions(BYTES) gives
+// 5. bench_array(TYPE, COUNT) -> TYPE*, bench_free(POINTER)
+//      * COUNT zeroed elements from the allocator allocated_info() knows in this build (tracked_, sized_ or plain calloc)
+// 6. bench_fill(POINTER, COUNT), bench_fill_random(POINTER, COUNT)
+//      * small non-negative values, so that any type converts to any other;
+//        or the same pseudo-random 64-bit numbers in every run, converted to the element type
+// 7. bench_keep(POINTER), bench_keep_number(VALUE)
+//      * out of line, so the compiler cannot drop a result nobody reads
+// 8. bench_quiet_begin(), bench_quiet_end()
+//      * stdout goes to the null device in between, for printtype()
+// 9. bench_quick, bench_memory, bench_threads
+//      * -q, -m and -t: fewer repetitions, the bytes a suite may allocate for one measurement,
+//        and the most threads a pool may have
+
+#ifndef FLORESTAN_BENCH_H
+#define FLORESTAN_BENCH_H
+#include "florestan/type_traits.h"
+#include "florestan/counters.h"
+#ifdef FLORESTAN_TRACKED_ALLOC
+    #include "florestan/alloc_registry.h"
+#endif
+#ifdef FLORESTAN_SIZED_ALLOC
+    #include "florestan/sized_alloc.h"
+#endif
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_TYPES(X, ...) \
+    X(char,    char,               __VA_ARGS__) \
+    X(schar,   signed char,        __VA_ARGS__) \
+    X(uchar,   unsigned char,      __VA_ARGS__) \
+    X(short,   short,              __VA_ARGS__) \
+    X(ushort,  unsigned short,     __VA_ARGS__) \
+    X(int,     int,                __VA_ARGS__) \
+    X(uint,    unsigned int,       __VA_ARGS__) \
+    X(long,    long,               __VA_ARGS__) \
+    X(ulong,   unsigned long,      __VA_ARGS__) \
+    X(llong,   long long,          __VA_ARGS__) \
+    X(ullong,  unsigned long long, __VA_ARGS__) \
+    X(float,   float,              __VA_ARGS__) \
+    X(double,  double,             __VA_ARGS__) \
+    X(ldouble, long double,        __VA_ARGS__)
+// The same list once more: a macro cannot expand inside its own expansion.
+#define BENCH_SOURCES(X, ...) \
+    X(__VA_ARGS__, char,    char) \
+    X(__VA_ARGS__, schar,   signed char) \
+    X(__VA_ARGS__, uchar,   unsigned char) \
+    X(__VA_ARGS__, short,   short) \
+    X(__VA_ARGS__, ushort,  unsigned short) \
+    X(__VA_ARGS__, int,     int) \
+    X(__VA_ARGS__, uint,    unsigned int) \
+    X(__VA_ARGS__, long,    long) \
+    X(__VA_ARGS__, ulong,   unsigned long) \
+    X(__VA_ARGS__, llong,   long long) \
+    X(__VA_ARGS__, ullong,  unsigned long long) \
+    X(__VA_ARGS__, float,   float) \
+    X(__VA_ARGS__, double,  double) \
+    X(__VA_ARGS__, ldouble, long double)
+#define BENCH_SIZES(X, ...) \
+    X(64,     __VA_ARGS__) \
+    X(4096,   __VA_ARGS__) \
+    X(262144, __VA_ARGS__)
+#define BENCH_THREADS(X, ...) \
+    X(1, __VA_ARGS__) \
+    X(2, __VA_ARGS__) \
+    X(4, __VA_ARGS__) \
+    X(8, __VA_ARGS__) \
+    X(16, __VA_ARGS__) \
+    X(32, __VA_ARGS__) \
+    X(64, __VA_ARGS__)
+
+extern bool bench_quick;
+extern size_t bench_memory;
+extern size_t bench_threads;
+size_t bench_count(size_t n);
+size_t bench_repetitions(size_t bytes);
+void bench_keep(const void* p);
+void bench_keep_number(long double value);
+void bench_quiet_begin(void);
+void bench_quiet_end(void);
+void* __bench_checked(void* p);
+uint64_t __bench_random(uint64_t* state);
+
+#define bench_measure(label, bytes, ...) counters_measure(label, bench_repetitions(bytes), (bytes), __VA_ARGS__)
+
+#if defined(FLORESTAN_SIZED_ALLOC)
+    #define bench_array(T, n) ((T*)__bench_checked(sized_calloc((n), sizeof(T))))
+    #define bench_free(p) sized_free(p)
+#elif defined(FLORESTAN_TRACKED_ALLOC)
+    #define bench_array(T, n) ((T*)__bench_checked(tracked_calloc((n), sizeof(T))))
+    #define bench_free(p) tracked_free(p)
+#else
+    #define bench_array(T, n) ((T*)__bench_checked(calloc((n), sizeof(T))))
+    #define bench_free(p) free(p)
+#endif
+
+#define bench_fill(p, n) do { \
+    for (size_t __bench_i = 0; __bench_i < (n); __bench_i++) (p)[__bench_i] = (__bench_i * 2654435761u >> 8) % 100; \
+} while (0)
+#define bench_fill_random(p, n) do { \
+    uint64_t __bench_state = 0x9E3779B97F4A7C15u; \
+    for (size_t __bench_i = 0; __bench_i < (n); __bench_i++) (p)[__bench_i] = (long long)__bench_random(&__bench_state); \
+} while (0)
+
+// The suites, in the order main.c runs them.
+void bench_types(void);
+void bench_reduce(void);
+void bench_sort(void);
+void bench_sort_scale(void);
+void bench_convert(void);
+void bench_scan(void);
+void bench_search(void);
+void bench_compress(void);
+void bench_layout(void);
+void bench_hash_map(void);
+void bench_text(void);
+void bench_containers(void);
+void bench_registry(void);
+void bench_arena(void);
+void bench_parallel(void);
+
+#endif
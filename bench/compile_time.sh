@@ -0,0 +1,98 @@
+#!/bin/sh
+# Florestan's Benchmarks: compile time of <florestan/type_traits.h>
+#
+# © dongwanpianist
+#
+# bench/compile_time.sh [USES [RUNS]]
+#      * writes one C file per trait macro with USES uses of it (1000 by default) and one with all of them,
+#        and times the compiler's -E and -c on each, against this tree's header and the one before the X-macro tables
+#      * prints the fastest of RUNS runs (5 by default) in milliseconds, one row per file
+#      * CC and CFLAGS as usual (cc and -O2); BASELINE is the git revision of the old header (b6b6fe0, the first commit)
+#      * run it from anywhere inside the repository: the old header comes from git show
+#
+# The old header gives its enum an underlying type, as C23 does: a compiler without that part of C23
+# gets the copy without it, the same as <florestan/type_traits.h> now does for itself.
+
+set -eu
+
+USES=${1:-1000}
+RUNS=${2:-5}
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:--O2}
+BASELINE=${BASELINE:-b6b6fe0}
+
+ROOT=$(git rev-parse --show-toplevel)
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+STD=
+for std in -std=c23 -std=c2x; do
+    if echo 'int x;' | "$CC" $std -x c -c - -o /dev/null 2>/dev/null; then STD=$std; break; fi
+done
+[ -n "$STD" ] || { echo "compile_time.sh: $CC knows neither -std=c23 nor -std=c2x" >&2; exit 1; }
+
+mkdir -p "$WORK/baseline/florestan"
+git -C "$ROOT" show "$BASELINE:florestan/type_traits.h" > "$WORK/baseline/florestan/type_traits.h"
+if ! echo 'enum e: unsigned char { a };' | "$CC" $STD -x c -c - -o /dev/null 2>/dev/null; then
+    sed 's/enum methods: unsigned char/enum methods/' "$WORK/baseline/florestan/type_traits.h" > "$WORK/type_traits.h"
+    mv "$WORK/type_traits.h" "$WORK/baseline/florestan/type_traits.h"
+fi
+
+# The macros both headers have, each with the operands it takes: a value of every kind for the type tests,
+# and pointers or arrays for the ones that look at a block.
+MACROS='__is_void __is_bool __is_char __is_schar __is_uchar __is_short __is_ushort __is_int __is_uint
+__is_long __is_ulong __is_llong __is_ullong __is_float __is_double __is_ldouble
+__is_const __is_const_pointer __pointer_depth __sizeof __type_num printtype allocated_info alloc_sizeof'
+
+# generate FILE MACRO...: USES statements, each macro in turn on the next operand.
+generate() {
+    file=$1
+    shift
+    {
+        echo '#include "florestan/type_traits.h"'
+        echo 'volatile unsigned long long sink;'
+        echo 'void traits(int i, const double d, char* s, int** pp, const long double* const ld, unsigned short* us, float* f) {'
+        echo '    int array[8] = { 0 };'
+        echo '    (void)i; (void)d; (void)s; (void)pp; (void)ld; (void)us; (void)f; (void)array;'
+        awk -v uses="$USES" -v macros="$*" 'BEGIN {
+            count = split(macros, macro, " ")
+            values = split("i d s pp ld us f array", value, " ")
+            blocks = split("s pp us f array", block, " ")
+            for (k = 0; k < uses; k++) {
+                m = macro[k % count + 1]
+                if (m == "printtype") printf "    printtype(%s);\n", value[k % values + 1]
+                else if (m == "allocated_info") printf "    sink += allocated_info(%s).arraysize;\n", block[k % blocks + 1]
+                else if (m == "alloc_sizeof") printf "    sink += alloc_sizeof(%s);\n", block[k % blocks + 1]
+                else printf "    sink += (unsigned long long)%s(%s);\n", m, value[k % values + 1]
+            }
+        }'
+        echo '}'
+    } > "$file"
+}
+
+now() {
+    date +%s%N
+}
+
+# fastest INCLUDE FLAG FILE: the fastest of RUNS runs, in milliseconds.
+fastest() {
+    best=
+    run=0
+    while [ "$run" -lt "$RUNS" ]; do
+        start=$(now)
+        "$CC" $STD $CFLAGS -I"$1" "$2" "$3" -o "$WORK/out" || { echo "compile_time.sh: $3 does not compile" >&2; exit 1; }
+        took=$(( ($(now) - start) / 1000 ))
+        if [ -z "$best" ] || [ "$took" -lt "$best" ]; then best=$took; fi
+        run=$((run + 1))
+    done
+    awk -v us="$best" 'BEGIN { printf "%.1f", us / 1000 }'
+}
+
+printf '%s, %s uses per file, fastest of %s runs, in ms\n' "$("$CC" --version | head -n 1)" "$USES" "$RUNS"
+printf '%-20s %12s %12s %12s %12s\n' file "-E $BASELINE" "-E now" "-c $BASELINE" "-c now"
+for name in $MACROS all; do
+    if [ "$name" = all ]; then generate "$WORK/$name.c" $MACROS; else generate "$WORK/$name.c" "$name"; fi
+    printf '%-20s %12s %12s %12s %12s\n' "$name" \
+        "$(fastest "$WORK/baseline" -E "$WORK/$name.c")" "$(fastest "$ROOT" -E "$WORK/$name.c")" \
+        "$(fastest "$WORK/baseline" -c "$WORK/$name.c")" "$(fastest "$ROOT" -c "$WORK/$name.c")"
+done
@@ -0,0 +1,29 @@
+// Florestan's Benchmarks: compression
+//
+// © dongwanpianist
+//
+// The input is a slow ramp with small noise, the kind of series the delta and XOR codecs are made for;
+// "bytes" counts the uncompressed elements both ways.
+
+#include "bench.h"
+#include "florestan/array_compress.h"
+
+#define __BENCH_COMPRESS(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* back = bench_array(T, n); \
+    for (size_t i = 0; i < n; i++) a[i] = (T)(i / 16 % 100 + (i * 2654435761u >> 12) % 4); \
+    unsigned char* buffer = bench_array(unsigned char, array_compress_bound(a, n)); \
+    size_t size = array_compress(buffer, a, n); \
+    size_t bytes = n * sizeof(T); \
+    bench_measure("array_compress/" #NAME "/" #N, bytes, bench_keep_number(array_compress(buffer, a, n))); \
+    bench_measure("array_decompress/" #NAME "/" #N, bytes, bench_keep_number(array_decompress(back, buffer, size))); \
+    bench_free(a); \
+    bench_free(back); \
+    bench_free(buffer); \
+}
+#define __BENCH_COMPRESS_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_COMPRESS, NAME, T)
+
+void bench_compress(void) {
+    BENCH_TYPES(__BENCH_COMPRESS_TYPE, )
+}
@@ -0,0 +1,50 @@
+// Florestan's Benchmarks: containers
+//
+// © dongwanpianist
+//
+// vector_push() of COUNT elements into an empty vector, a batch of COUNT through an spsc_ring and back out,
+// and the queries of a bitset_array of COUNT bits.
+
+#include "bench.h"
+#include "florestan/vector.h"
+#include "florestan/ring.h"
+#include "florestan/bitset.h"
+
+#define __BENCH_CONTAINERS(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* back = bench_array(T, n); \
+    bench_fill(a, n); \
+    size_t bytes = n * sizeof(T); \
+    vector(T) v = { 0 }; \
+    bench_measure("vector_push/" #NAME "/" #N, bytes, \
+        vector_free(&v); for (size_t i = 0; i < n; i++) vector_push(&v, a[i]); bench_keep(v.data)); \
+    vector_free(&v); \
+    spsc_ring* r = __bench_checked(ring_new(T, n)); \
+    bench_measure("ring_push_pop_batch/" #NAME "/" #N, 2 * bytes, \
+        ring_push_batch(r, a, n); bench_keep_number(ring_pop_batch(r, back, n))); \
+    ring_free(r); \
+    bench_free(a); \
+    bench_free(back); \
+}
+#define __BENCH_CONTAINERS_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_CONTAINERS, NAME, T)
+
+#define __BENCH_BITSET(N, ...) { \
+    size_t n = bench_count(N); \
+    bool* flags = bench_array(bool, n); \
+    for (size_t i = 0; i < n; i++) flags[i] = (i * 2654435761u >> 8) % 3 == 0; \
+    bitset_array* b = __bench_checked(bitset_from_bools(flags, n)); \
+    bitset_array* c = __bench_checked(bitset_new(n)); \
+    bench_measure("bitset_from_bools/" #N, n, bitset_array* d = bitset_from_bools(flags, n); bench_keep(d); bitset_free(d)); \
+    bench_measure("bitset_count/" #N, n / 8, bench_keep_number(bitset_count(b))); \
+    bench_measure("bitset_select/" #N, n / 8, bench_keep_number(bitset_select(b, bitset_count(b) / 2))); \
+    bench_measure("bitset_and/" #N, 3 * n / 8, bitset_and(c, b, b); bench_keep(c->words)); \
+    bitset_free(b); \
+    bitset_free(c); \
+    bench_free(flags); \
+}
+
+void bench_containers(void) {
+    BENCH_TYPES(__BENCH_CONTAINERS_TYPE, )
+    BENCH_SIZES(__BENCH_BITSET, )
+}
@@ -0,0 +1,27 @@
+// Florestan's Benchmarks: conversions
+//
+// © dongwanpianist
+//
+// Every pair of element types, both ways of converting, at every size: 14 x 14 x 2 x 3 measurements.
+
+#include "bench.h"
+#include "florestan/array_convert.h"
+
+#define __BENCH_CONVERT(N, TO, D, FROM, S) { \
+    size_t n = bench_count(N); \
+    S* source = bench_array(S, n); \
+    D* destination = bench_array(D, n); \
+    bench_fill(source, n); \
+    size_t bytes = n * (sizeof(S) + sizeof(D)); \
+    bench_measure("array_convert/" #TO "<-" #FROM "/" #N, bytes, array_convert(destination, source, n); bench_keep(destination)); \
+    bench_measure("array_convert_saturate/" #TO "<-" #FROM "/" #N, bytes, \
+        array_convert_saturate(destination, source, n); bench_keep(destination)); \
+    bench_free(source); \
+    bench_free(destination); \
+}
+#define __BENCH_CONVERT_PAIR(TO, D, FROM, S) BENCH_SIZES(__BENCH_CONVERT, TO, D, FROM, S)
+#define __BENCH_CONVERT_TO(NAME, T, ...) BENCH_SOURCES(__BENCH_CONVERT_PAIR, NAME, T)
+
+void bench_convert(void) {
+    BENCH_TYPES(__BENCH_CONVERT_TO, )
+}
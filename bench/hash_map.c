@@ -0,0 +1,38 @@
+// Florestan's Benchmarks: hash maps
+//
+// © dongwanpianist
+//
+// A map of COUNT distinct keys of each type (fewer for the narrow ones, which do not have that many values)
+// to size_t values: "insert" builds it from empty, "find" looks every key up again in one batch.
+
+#include "bench.h"
+#include "florestan/hash_map.h"
+
+#define __BENCH_HASH_MAP(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    size_t most = sizeof(T) == 1 ? 128 : sizeof(T) == 2 ? 32768 : n; \
+    if (n > most) n = most; \
+    T* keys = bench_array(T, n); \
+    size_t* values = bench_array(size_t, n); \
+    size_t* slots = bench_array(size_t, n); \
+    for (size_t i = 0; i < n; i++) { \
+        keys[i] = (T)i; \
+        values[i] = i; \
+    } \
+    size_t bytes = n * (sizeof(T) + sizeof(size_t)); \
+    hash_map(T, size_t) map = { 0 }; \
+    bench_measure("hash_map_insert_batch/" #NAME "/" #N, bytes, \
+        hash_map_free(&map); hash_map_insert_batch(&map, keys, values, n); bench_keep(map.keys)); \
+    bench_measure("hash_map_find_batch/" #NAME "/" #N, bytes, bench_keep_number(hash_map_find_batch(&map, keys, slots, n))); \
+    bench_measure("hash_map_find/" #NAME "/" #N, bytes, \
+        size_t s = 0; for (size_t i = 0; i < n; i++) s += hash_map_find(&map, keys[i]); bench_keep_number(s)); \
+    hash_map_free(&map); \
+    bench_free(keys); \
+    bench_free(values); \
+    bench_free(slots); \
+}
+#define __BENCH_HASH_MAP_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_HASH_MAP, NAME, T)
+
+void bench_hash_map(void) {
+    BENCH_TYPES(__BENCH_HASH_MAP_TYPE, )
+}
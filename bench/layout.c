@@ -0,0 +1,35 @@
+// Florestan's Benchmarks: layouts
+//
+// © dongwanpianist
+//
+// Every size is a square matrix to transpose (8 x 8, 64 x 64, 512 x 512),
+// and records of __BENCH_LAYOUT_STRIDE fields to split into columns and put back together.
+
+#include "bench.h"
+#include "florestan/array_layout.h"
+
+#define __BENCH_LAYOUT_STRIDE 4
+
+#define __BENCH_LAYOUT(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    size_t side = 1; \
+    while (side * side < n) side *= 2; \
+    size_t records = n / __BENCH_LAYOUT_STRIDE; \
+    T* a = bench_array(T, n); \
+    T* b = bench_array(T, n); \
+    T** columns = __bench_checked(array_columns_alloc(T, __BENCH_LAYOUT_STRIDE, records)); \
+    bench_fill(a, n); \
+    size_t bytes = 2 * n * sizeof(T); \
+    bench_measure("array_transpose/" #NAME "/" #N, bytes, array_transpose(b, a, side, side); bench_keep(b)); \
+    bench_measure("array_deinterleave/" #NAME "/" #N, bytes, \
+        array_deinterleave(columns, a, records, __BENCH_LAYOUT_STRIDE); bench_keep(columns[0])); \
+    bench_measure("array_interleave/" #NAME "/" #N, bytes, array_interleave(b, columns, records, __BENCH_LAYOUT_STRIDE); bench_keep(b)); \
+    array_columns_free(columns); \
+    bench_free(a); \
+    bench_free(b); \
+}
+#define __BENCH_LAYOUT_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_LAYOUT, NAME, T)
+
+void bench_layout(void) {
+    BENCH_TYPES(__BENCH_LAYOUT_TYPE, )
+}
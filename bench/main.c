@@ -0,0 +1,153 @@
+// Florestan's Benchmarks
+//
+// © dongwanpianist
+//
+// florestan_bench [-q] [-m MIB] [-t THREADS] [-o FILE] [SUITE ...]
+//      * runs every suite, or only the ones named, and writes the measurements to FILE
+//        (florestan_bench.csv by default; JSON when FILE ends with ".json")
+//      * -q runs a sixteenth of the repetitions, for a quick look rather than a baseline
+//      * -m caps the memory of one measurement's arrays at MIB mebibytes (1024 by default), for the largest sizes
+//      * -t caps the pools of the threaded suites at THREADS threads (every online CPU by default):
+//        they run 1, 2, 4, ... threads up to it
+//      * the medians and the 99th percentiles are in ticks (column "median" and "p99"): TSC cycles on x86,
+//        nanoseconds elsewhere; "bytes" is what all the repetitions read and wrote together
+
+#define _POSIX_C_SOURCE 200809L
+#include "bench.h"
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+
+bool bench_quick;
+size_t bench_memory = (size_t)1024 << 20;
+size_t bench_threads;
+
+size_t bench_count(size_t n) {
+    static volatile size_t count;
+    count = n;
+    return count;
+}
+
+// About 16 MiB of traffic per measurement, and never fewer than 33 repetitions, so that the 99th percentile is a real one.
+size_t bench_repetitions(size_t bytes) {
+    size_t budget = (size_t)1 << (bench_quick ? 20 : 24);
+    size_t repetitions = budget / (bytes ? bytes : 1);
+    size_t least = bench_quick ? 9 : 33, most = bench_quick ? 257 : 4097;
+    return repetitions < least ? least : repetitions > most ? most : repetitions;
+}
+
+static const void* volatile __bench_kept_pointer;
+static volatile long double __bench_kept_number;
+void bench_keep(const void* p) {
+    __bench_kept_pointer = p;
+}
+void bench_keep_number(long double value) {
+    __bench_kept_number = value;
+}
+
+void* __bench_checked(void* p) {
+    if (p == NULL) {
+        fputs("florestan_bench: out of memory\n", stderr);
+        exit(EXIT_FAILURE);
+    }
+    return p;
+}
+
+// splitmix64: every value of the state gives a well mixed output, so one fixed seed is enough.
+uint64_t __bench_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+static int __bench_stdout = -1;
+void bench_quiet_begin(void) {
+    fflush(stdout);
+    int null = open("/dev/null", O_WRONLY);
+    if (null < 0) return;
+    __bench_stdout = dup(STDOUT_FILENO);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+}
+void bench_quiet_end(void) {
+    fflush(stdout);
+    if (__bench_stdout < 0) return;
+    dup2(__bench_stdout, STDOUT_FILENO);
+    close(__bench_stdout);
+    __bench_stdout = -1;
+}
+
+typedef struct __bench_suite {
+    const char* name;
+    void (*run)(void);
+} bench_suite;
+static const bench_suite __bench_suites[] = {
+    { "types",      bench_types },
+    { "reduce",     bench_reduce },
+    { "sort",       bench_sort },
+    { "sort_scale", bench_sort_scale },
+    { "convert",    bench_convert },
+    { "scan",       bench_scan },
+    { "search",     bench_search },
+    { "compress",   bench_compress },
+    { "layout",     bench_layout },
+    { "hash_map",   bench_hash_map },
+    { "text",       bench_text },
+    { "containers", bench_containers },
+    { "registry",   bench_registry },
+    { "arena",      bench_arena },
+    { "parallel",   bench_parallel },
+};
+#define __BENCH_SUITE_COUNT (sizeof(__bench_suites) / sizeof(__bench_suites[0]))
+
+static int __bench_usage(void) {
+    fputs("usage: florestan_bench [-q] [-m MIB] [-t THREADS] [-o FILE.csv|FILE.json] [SUITE ...]\nsuites:", stderr);
+    for (size_t i = 0; i < __BENCH_SUITE_COUNT; i++) fprintf(stderr, " %s", __bench_suites[i].name);
+    fputc('\n', stderr);
+    return EXIT_FAILURE;
+}
+
+int main(int argc, char** argv) {
+    const char* output = "florestan_bench.csv";
+    bool chosen[__BENCH_SUITE_COUNT] = { false };
+    bool any = false;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-q") == 0) bench_quick = true;
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) output = argv[++i];
+        else if (strcmp(argv[i], "-m") == 0 && i + 1 < argc) {
+            char* end;
+            unsigned long long mebibytes = strtoull(argv[++i], &end, 10);
+            if (*end != '\0' || mebibytes == 0) return __bench_usage();
+            bench_memory = (size_t)mebibytes << 20;
+        }
+        else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+            char* end;
+            unsigned long long threads = strtoull(argv[++i], &end, 10);
+            if (*end != '\0' || threads == 0) return __bench_usage();
+            bench_threads = (size_t)threads;
+        }
+        else {
+            size_t k = 0;
+            while (k < __BENCH_SUITE_COUNT && strcmp(argv[i], __bench_suites[k].name) != 0) k++;
+            if (k == __BENCH_SUITE_COUNT) return __bench_usage();
+            chosen[k] = any = true;
+        }
+    }
+    if (bench_threads == 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        bench_threads = online > 0 ? (size_t)online : 1;
+    }
+    counters_reset();
+    for (size_t k = 0; k < __BENCH_SUITE_COUNT; k++) {
+        if (any && !chosen[k]) continue;
+        fprintf(stderr, "florestan_bench: %s\n", __bench_suites[k].name);
+        __bench_suites[k].run();
+    }
+    if (!counters_dump(output)) {
+        fprintf(stderr, "florestan_bench: cannot write %s\n", output);
+        return EXIT_FAILURE;
+    }
+    fprintf(stderr, "florestan_bench: wrote %s (ticks are %s)\n", output, __COUNTER_UNIT);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,58 @@
+// Florestan's Benchmarks: thread scaling
+//
+// © dongwanpianist
+//
+// The tasks of <florestan/parallel.h> on pools of 1, 2, 4, ... threads, up to bench_threads (-t), over 4194304 elements
+// of every type: a sum, a maximum, a fill and a map, each split and combined the way parallel_reduce(), parallel_fill()
+// and parallel_map() do on thread_pool_default(), but with a pool of each size. Names end with the number of threads.
+
+#include "bench.h"
+#include "florestan/parallel.h"
+
+#define __BENCH_PARALLEL_COUNT 4194304
+
+#define __BENCH_PARALLEL_TWICE(NAME, T, ...) \
+static T __bench_parallel_twice_##NAME(T x) { \
+    return (T)(x + x); \
+}
+BENCH_TYPES(__BENCH_PARALLEL_TWICE, )
+
+#define __BENCH_PARALLEL(NAME, T, THREADS, pool) { \
+    size_t n = bench_count(__BENCH_PARALLEL_COUNT); \
+    T* a = bench_array(T, n); \
+    T* b = bench_array(T, n); \
+    bench_fill(a, n); \
+    size_t bytes = n * sizeof(T), threads = thread_pool_threads(pool); \
+    parallel_partial* partials = __bench_checked(__parallel_partials(pool)); \
+    parallel_reduce_##NAME reduce = { a, partials }; \
+    bench_measure("parallel_sum/" #NAME "/" #THREADS, bytes, \
+        for (size_t w = 0; w < threads; w++) memset(partials[w].line, 0, sizeof(partials[w].line)); \
+        thread_pool_run(pool, __parallel_sum_task_##NAME, &reduce, n, 0); \
+        bench_keep(partials)); \
+    bench_measure("parallel_max/" #NAME "/" #THREADS, bytes, \
+        for (size_t w = 0; w < threads; w++) *(T*)partials[w].line = a[0]; \
+        thread_pool_run(pool, __parallel_max_task_##NAME, &reduce, n, 0); \
+        bench_keep(partials)); \
+    parallel_fill_##NAME fill = { b, (T)1 }; \
+    bench_measure("parallel_fill/" #NAME "/" #THREADS, bytes, \
+        thread_pool_run(pool, __parallel_fill_task_##NAME, &fill, n, 0); bench_keep(b)); \
+    parallel_map_##NAME map = { b, a, __bench_parallel_twice_##NAME }; \
+    bench_measure("parallel_map/" #NAME "/" #THREADS, 2 * bytes, \
+        thread_pool_run(pool, __parallel_map_task_##NAME, &map, n, 0); bench_keep(b)); \
+    free(partials); \
+    bench_free(a); \
+    bench_free(b); \
+}
+
+#define __BENCH_PARALLEL_THREADS(THREADS, ...) \
+    if (THREADS <= bench_threads) { \
+        thread_pool* pool = __bench_checked(thread_pool_create(THREADS)); \
+        if (thread_pool_threads(pool) == THREADS) { \
+            BENCH_TYPES(__BENCH_PARALLEL, THREADS, pool) \
+        } \
+        thread_pool_destroy(pool); \
+    }
+
+void bench_parallel(void) {
+    BENCH_THREADS(__BENCH_PARALLEL_THREADS, )
+}
@@ -0,0 +1,28 @@
+// Florestan's Benchmarks: reductions
+//
+// © dongwanpianist
+
+#include "bench.h"
+#include "florestan/array_reduce.h"
+
+#define __BENCH_REDUCE(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* b = bench_array(T, n); \
+    bench_fill(a, n); \
+    bench_fill(b, n); \
+    size_t bytes = n * sizeof(T); \
+    T low, high; \
+    bench_measure("array_sum/" #NAME "/" #N, bytes, bench_keep_number(array_sum(a, n))); \
+    bench_measure("array_min/" #NAME "/" #N, bytes, bench_keep_number(array_min(a, n))); \
+    bench_measure("array_max/" #NAME "/" #N, bytes, bench_keep_number(array_max(a, n))); \
+    bench_measure("array_minmax/" #NAME "/" #N, bytes, array_minmax(a, n, &low, &high); bench_keep_number(low + high)); \
+    bench_measure("array_dot/" #NAME "/" #N, 2 * bytes, bench_keep_number(array_dot(a, b, n))); \
+    bench_free(a); \
+    bench_free(b); \
+}
+#define __BENCH_REDUCE_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_REDUCE, NAME, T)
+
+void bench_reduce(void) {
+    BENCH_TYPES(__BENCH_REDUCE_TYPE, )
+}
@@ -0,0 +1,105 @@
+// Florestan's Benchmarks: the allocation registry
+//
+// © dongwanpianist
+//
+// Every thread of a pool registers, finds and removes 4096 blocks of its own, at once, the way the tracked_ allocators
+// and allocated_info() use the registry from many threads; "malloc_usable_size" is what the OS allocator alone answers
+// about the same blocks, with no registry at all.
+//      * "registry_insert_remove": __registry_insert() and __registry_remove() of every block
+//      * "registry_lookup" and "registry_lookup_interior": __registry_lookup() of every base, and of a pointer inside
+//      * "tracked_malloc_free" and "malloc_free": allocating and freeing blocks of the same sizes, with and without the registry
+// Names end with the number of threads (up to bench_threads, -t), and one measurement covers the blocks of all of them.
+
+#include "bench.h"
+#include "florestan/alloc_registry.h"
+#include "florestan/thread_pool.h"
+#if defined(__linux__)
+    #include <malloc.h>
+    #define __bench_usable_size(p) malloc_usable_size(p)
+#elif defined(__APPLE__)
+    #include <malloc/malloc.h>
+    #define __bench_usable_size(p) malloc_size(p)
+#else
+    #define __bench_usable_size(p) ((void)(p), (size_t)0)
+#endif
+
+#define __BENCH_REGISTRY_BLOCKS 4096
+
+typedef struct __bench_registry_blocks {
+    void** blocks;
+    size_t* sizes;
+    size_t* found; // one cache line per thread
+} registry_blocks;
+#define __BENCH_FOUND(r, t) ((r)->found[(t) * (FLORESTAN_CACHE_LINE / sizeof(size_t))])
+
+// Each task gets thread indices; thread t works on blocks [t * __BENCH_REGISTRY_BLOCKS, (t + 1) * __BENCH_REGISTRY_BLOCKS).
+#define __BENCH_REGISTRY_TASK(NAME, ...) \
+static void __bench_registry_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    (void)worker; \
+    registry_blocks* r = context; \
+    for (size_t t = begin; t < end; t++) { \
+        size_t found = 0; \
+        for (size_t i = t * __BENCH_REGISTRY_BLOCKS; i < (t + 1) * __BENCH_REGISTRY_BLOCKS; i++) { __VA_ARGS__ } \
+        __BENCH_FOUND(r, t) += found; \
+    } \
+}
+__BENCH_REGISTRY_TASK(insert,
+    found += __registry_insert(r->blocks[i], r->sizes[i], 1, allocated, NULL);)
+__BENCH_REGISTRY_TASK(remove,
+    found += __registry_remove(r->blocks[i]);)
+__BENCH_REGISTRY_TASK(insert_remove,
+    found += __registry_insert(r->blocks[i], r->sizes[i], 1, allocated, NULL);
+    found += __registry_remove(r->blocks[i]);)
+__BENCH_REGISTRY_TASK(lookup,
+    allocated_block block;
+    found += __registry_lookup(r->blocks[i], &block) ? block.size : 0;)
+__BENCH_REGISTRY_TASK(lookup_interior,
+    allocated_block block;
+    found += __registry_lookup((char*)r->blocks[i] + r->sizes[i] / 2, &block) ? block.size : 0;)
+__BENCH_REGISTRY_TASK(usable_size,
+    found += __bench_usable_size(r->blocks[i]);)
+__BENCH_REGISTRY_TASK(tracked_malloc_free,
+    void* p = tracked_malloc(r->sizes[i]);
+    found += p != NULL;
+    tracked_free(p);)
+__BENCH_REGISTRY_TASK(malloc_free,
+    void* p = malloc(r->sizes[i]);
+    found += p != NULL;
+    free(p);)
+
+#define __BENCH_REGISTRY(THREADS, ...) if (THREADS <= bench_threads) { \
+    thread_pool* pool = __bench_checked(thread_pool_create(THREADS)); \
+    if (thread_pool_threads(pool) == THREADS) { \
+        size_t n = THREADS * __BENCH_REGISTRY_BLOCKS, bytes = n * sizeof(void*); \
+        registry_blocks r = { \
+            __bench_checked(malloc(n * sizeof(void*))), \
+            __bench_checked(malloc(n * sizeof(size_t))), \
+            __bench_checked(calloc(THREADS, FLORESTAN_CACHE_LINE)), \
+        }; \
+        uint64_t state = THREADS; \
+        for (size_t i = 0; i < n; i++) { \
+            r.sizes[i] = 16 + __bench_random(&state) % 1009; \
+            r.blocks[i] = __bench_checked(malloc(r.sizes[i])); \
+        } \
+        bench_measure("registry_insert_remove/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_insert_remove, &r, THREADS, 1)); \
+        thread_pool_run(pool, __bench_registry_insert, &r, THREADS, 1); \
+        bench_measure("registry_lookup/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_lookup, &r, THREADS, 1)); \
+        bench_measure("registry_lookup_interior/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_lookup_interior, &r, THREADS, 1)); \
+        thread_pool_run(pool, __bench_registry_remove, &r, THREADS, 1); \
+        bench_measure("malloc_usable_size/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_usable_size, &r, THREADS, 1)); \
+        bench_measure("tracked_malloc_free/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_tracked_malloc_free, &r, THREADS, 1)); \
+        bench_measure("malloc_free/" #THREADS, bytes, thread_pool_run(pool, __bench_registry_malloc_free, &r, THREADS, 1)); \
+        size_t found = 0; \
+        for (size_t t = 0; t < THREADS; t++) found += __BENCH_FOUND(&r, t); \
+        bench_keep_number(found); \
+        for (size_t i = 0; i < n; i++) free(r.blocks[i]); \
+        free(r.blocks); \
+        free(r.sizes); \
+        free(r.found); \
+    } \
+    thread_pool_destroy(pool); \
+}
+
+void bench_registry(void) {
+    BENCH_THREADS(__BENCH_REGISTRY, )
+}
@@ -0,0 +1,32 @@
+// Florestan's Benchmarks: scans
+//
+// © dongwanpianist
+//
+// array_partition() moves the elements around, so each repetition copies the input back first, as in sort.c.
+
+#include "bench.h"
+#include "florestan/array_scan.h"
+
+#define __BENCH_SCAN_BINS 64
+
+#define __BENCH_SCAN(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* work = bench_array(T, n); \
+    size_t* bins = bench_array(size_t, __BENCH_SCAN_BINS); \
+    bench_fill(a, n); \
+    size_t bytes = n * sizeof(T); \
+    bench_measure("array_prefix_sum/" #NAME "/" #N, 2 * bytes, array_prefix_sum(work, a, n); bench_keep(work)); \
+    bench_measure("array_histogram/" #NAME "/" #N, bytes, \
+        bench_keep_number(array_histogram(a, n, bins, (T)0, (T)100, __BENCH_SCAN_BINS))); \
+    bench_measure("array_partition/" #NAME "/" #N, 2 * bytes, \
+        memcpy(work, a, bytes); bench_keep_number(array_partition(work, n, (T)50))); \
+    bench_free(a); \
+    bench_free(work); \
+    bench_free(bins); \
+}
+#define __BENCH_SCAN_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_SCAN, NAME, T)
+
+void bench_scan(void) {
+    BENCH_TYPES(__BENCH_SCAN_TYPE, )
+}
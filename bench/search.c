@@ -0,0 +1,40 @@
+// Florestan's Benchmarks: searches
+//
+// © dongwanpianist
+//
+// Each repetition looks up __BENCH_SEARCH_KEYS keys spread over the whole range, so a measurement is many probes,
+// not the clock reading around a single one; divide by __BENCH_SEARCH_KEYS for the cost of one lookup.
+
+#include "bench.h"
+#include "florestan/array_sort.h"
+#include "florestan/array_search.h"
+
+#define __BENCH_SEARCH_KEYS 256
+
+#define __BENCH_SEARCH(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* e = bench_array(T, n); \
+    T keys[__BENCH_SEARCH_KEYS]; \
+    bench_fill_random(a, n); \
+    array_sort(a, n); \
+    array_eytzinger_build(e, a, n); \
+    for (size_t k = 0; k < __BENCH_SEARCH_KEYS; k++) keys[k] = a[(k * 2654435761u) % n]; \
+    size_t bytes = __BENCH_SEARCH_KEYS * sizeof(T); \
+    bench_measure("array_lower_bound/" #NAME "/" #N, bytes, \
+        size_t s = 0; for (size_t k = 0; k < __BENCH_SEARCH_KEYS; k++) s += array_lower_bound(a, n, keys[k]); bench_keep_number(s)); \
+    bench_measure("array_contains/" #NAME "/" #N, bytes, \
+        size_t s = 0; for (size_t k = 0; k < __BENCH_SEARCH_KEYS; k++) s += array_contains(a, n, keys[k]); bench_keep_number(s)); \
+    bench_measure("array_eytzinger_build/" #NAME "/" #N, 2 * n * sizeof(T), array_eytzinger_build(e, a, n); bench_keep(e)); \
+    bench_measure("array_eytzinger_lower_bound/" #NAME "/" #N, bytes, \
+        size_t s = 0; for (size_t k = 0; k < __BENCH_SEARCH_KEYS; k++) s += array_eytzinger_lower_bound(e, n, keys[k]); bench_keep_number(s)); \
+    bench_measure("array_eytzinger_contains/" #NAME "/" #N, bytes, \
+        size_t s = 0; for (size_t k = 0; k < __BENCH_SEARCH_KEYS; k++) s += array_eytzinger_contains(e, n, keys[k]); bench_keep_number(s)); \
+    bench_free(a); \
+    bench_free(e); \
+}
+#define __BENCH_SEARCH_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_SEARCH, NAME, T)
+
+void bench_search(void) {
+    BENCH_TYPES(__BENCH_SEARCH_TYPE, )
+}
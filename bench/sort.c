@@ -0,0 +1,79 @@
+// Florestan's Benchmarks: sorting
+//
+// © dongwanpianist
+//
+// array_sort() sorts in place, so each repetition first copies the unsorted input back: "memcpy" is that copy alone.
+//
+// "sort" times array_sort() at the usual three sizes. "sort_scale" follows it from 1000 to 100000000 elements,
+// next to the introsort alone (what array_sort() falls back on, and all it does for long double) and the C library's
+// qsort() with a plain comparator. A size runs only when its three arrays (input, copy and the radix sort's scratch
+// buffer) fit in bench_memory (-m), and the largest sizes get as few as one repetition.
+
+#include "bench.h"
+#include "florestan/array_sort.h"
+#include <stdio.h>
+
+#define __BENCH_SORT(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    T* a = bench_array(T, n); \
+    T* work = bench_array(T, n); \
+    bench_fill_random(a, n); \
+    size_t bytes = n * sizeof(T); \
+    bench_measure("memcpy/" #NAME "/" #N, 2 * bytes, memcpy(work, a, bytes); bench_keep(work)); \
+    bench_measure("array_sort/" #NAME "/" #N, 2 * bytes, memcpy(work, a, bytes); array_sort(work, n); bench_keep(work)); \
+    bench_free(a); \
+    bench_free(work); \
+}
+#define __BENCH_SORT_TYPE(NAME, T, ...) BENCH_SIZES(__BENCH_SORT, NAME, T)
+
+void bench_sort(void) {
+    BENCH_TYPES(__BENCH_SORT_TYPE, )
+}
+
+#define __BENCH_SORT_SCALES(X, ...) \
+    X(1000,      __VA_ARGS__) \
+    X(10000,     __VA_ARGS__) \
+    X(100000,    __VA_ARGS__) \
+    X(1000000,   __VA_ARGS__) \
+    X(10000000,  __VA_ARGS__) \
+    X(100000000, __VA_ARGS__)
+
+// Sorting grows faster than the bytes it moves: about 8 million elements per measurement, from 33 repetitions down to 1.
+static size_t __bench_sort_repetitions(size_t n) {
+    size_t repetitions = ((size_t)1 << (bench_quick ? 19 : 23)) / n;
+    return repetitions < 1 ? 1 : repetitions > 33 ? 33 : repetitions;
+}
+
+#define __BENCH_SORT_COMPARE(NAME, T, ...) \
+static int __bench_sort_compare_##NAME(const void* a, const void* b) { \
+    T x = *(const T*)a, y = *(const T*)b; \
+    return (x > y) - (x < y); \
+}
+BENCH_TYPES(__BENCH_SORT_COMPARE, )
+
+#define __BENCH_SORT_SCALE(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    size_t bytes = n * sizeof(T); \
+    if (3 * bytes > bench_memory) { \
+        fprintf(stderr, "florestan_bench: sort_scale skips " #NAME "/" #N ", over the memory limit (-m)\n"); \
+    } else { \
+        T* a = bench_array(T, n); \
+        T* work = bench_array(T, n); \
+        bench_fill_random(a, n); \
+        size_t repetitions = __bench_sort_repetitions(n); \
+        counters_measure("memcpy/" #NAME "/" #N, repetitions, 2 * bytes, memcpy(work, a, bytes); bench_keep(work)); \
+        counters_measure("array_sort/" #NAME "/" #N, repetitions, 2 * bytes, \
+            memcpy(work, a, bytes); array_sort(work, n); bench_keep(work)); \
+        counters_measure("introsort/" #NAME "/" #N, repetitions, 2 * bytes, \
+            memcpy(work, a, bytes); __array_intro_sort_##NAME(work, n); bench_keep(work)); \
+        counters_measure("qsort/" #NAME "/" #N, repetitions, 2 * bytes, \
+            memcpy(work, a, bytes); qsort(work, n, sizeof(T), __bench_sort_compare_##NAME); bench_keep(work)); \
+        bench_free(a); \
+        bench_free(work); \
+    } \
+}
+#define __BENCH_SORT_SCALE_TYPE(NAME, T, ...) __BENCH_SORT_SCALES(__BENCH_SORT_SCALE, NAME, T)
+
+void bench_sort_scale(void) {
+    BENCH_TYPES(__BENCH_SORT_SCALE_TYPE, )
+}
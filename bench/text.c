@@ -0,0 +1,58 @@
+// Florestan's Benchmarks: text
+//
+// © dongwanpianist
+//
+// format_value() of 256 values per repetition, then format_array() of COUNT values into one comma-separated text,
+// and parse_array() of that very text back; "bytes" is the length of the text.
+// The types are the ones each side supports (parse has no long double), and chars are letters, so they read back.
+
+#include "bench.h"
+#include "florestan/format.h"
+#include "florestan/parse.h"
+
+#define __BENCH_TEXT_VALUES 256
+
+#define __BENCH_TEXT_SOURCE(T, n) \
+    T* a = bench_array(T, n); \
+    bench_fill(a, n); \
+    if (type_id(*a) == type_id((char)0)) for (size_t i = 0; i < n; i++) a[i] = (T)('a' + i % 26); \
+    format_buffer text = { 0 }; \
+    if (!format_array(&text, a, n, ",")) __bench_checked(NULL);
+
+#define __BENCH_FORMAT(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    __BENCH_TEXT_SOURCE(T, n) \
+    bench_measure("format_array/" #NAME "/" #N, text.length, text.length = 0; format_array(&text, a, n, ","); bench_keep(text.data)); \
+    format_free(&text); \
+    bench_free(a); \
+}
+#define __BENCH_FORMAT_TYPE(NAME, T, ...) { \
+    T* values = bench_array(T, __BENCH_TEXT_VALUES); \
+    bench_fill(values, __BENCH_TEXT_VALUES); \
+    char out[FLORESTAN_FORMAT_MAX]; \
+    bench_measure("format_value/" #NAME, __BENCH_TEXT_VALUES * sizeof(T), \
+        size_t s = 0; for (size_t i = 0; i < __BENCH_TEXT_VALUES; i++) s += format_value(out, values[i]); bench_keep_number(s)); \
+    bench_free(values); \
+    BENCH_SIZES(__BENCH_FORMAT, NAME, T) \
+}
+
+#define __BENCH_PARSE(N, NAME, T) { \
+    size_t n = bench_count(N); \
+    __BENCH_TEXT_SOURCE(T, n) \
+    T* back = bench_array(T, n); \
+    bench_measure("parse_array/" #NAME "/" #N, text.length, bench_keep_number(parse_array(back, text.data, text.length, ',', n).count)); \
+    format_free(&text); \
+    bench_free(a); \
+    bench_free(back); \
+}
+#define __BENCH_PARSE_TYPE(NAME, T) BENCH_SIZES(__BENCH_PARSE, NAME, T)
+// The types of parse_array(), spelled out here: its own list (__PARSE_TYPES) cannot expand inside itself.
+#define __BENCH_PARSE_TYPES(X) \
+    X(bool, bool) X(char, char) X(schar, signed char) X(uchar, unsigned char) X(short, short) X(ushort, unsigned short) \
+    X(int, int) X(uint, unsigned int) X(long, long) X(ulong, unsigned long) X(llong, long long) X(ullong, unsigned long long) \
+    X(float, float) X(double, double)
+
+void bench_text(void) {
+    BENCH_TYPES(__BENCH_FORMAT_TYPE, )
+    __BENCH_PARSE_TYPES(__BENCH_PARSE_TYPE)
+}
@@ -0,0 +1,28 @@
+// Florestan's Benchmarks: type traits
+//
+// © dongwanpianist
+//
+// __sizeof() and type_id() are constant expressions, so theirs are the cost of the clock and of keeping a result;
+// they are here as the floor to read the other rows against. printtype() writes to the null device.
+
+#include "bench.h"
+
+#define __BENCH_TRAITS(NAME, T, ...) { \
+    T value = 0; \
+    T* a = bench_array(T, bench_count(4096)); \
+    bench_measure("__sizeof/" #NAME, 0, bench_keep_number(__sizeof(value))); \
+    bench_measure("__sizeof/" #NAME "*", 0, bench_keep_number(__sizeof(a))); \
+    bench_measure("type_id/" #NAME, 0, bench_keep_number(type_id(a))); \
+    bench_measure("alloc_sizeof/" #NAME, 0, bench_keep_number(alloc_sizeof(a))); \
+    bench_measure("allocated_info/" #NAME, 0, bench_keep_number(allocated_info(a).arraysize)); \
+    bench_quiet_begin(); \
+    bench_measure("printtype/" #NAME, 0, printtype(a)); \
+    bench_quiet_end(); \
+    bench_free(a); \
+}
+
+void bench_types(void) {
+    BENCH_TYPES(__BENCH_TRAITS, )
+    int numbers[64] = { 0 };
+    bench_measure("allocated_info/fixed", 0, bench_keep_number(allocated_info(numbers).arraysize));
+}
@@ -0,0 +1,84 @@
+// Florestan's Aligned Array
+//
+// © dongwanpianist
+//
+// malloc only promises _Alignof(max_align_t), 16 bytes on most targets, so a 32-byte AVX2 load from a malloc block
+// may straddle two cache lines in every other iteration. These allocate arrays that start on any power-of-two boundary,
+// over C11 aligned_alloc, and free them again in every allocation mode of <florestan/type_traits.h>.
+// allocated_info(POINTER).alignment tells any pointer's alignment, wherever it came from,
+// and the vector kernels of <florestan/array_reduce.h> use it to run their main loops on aligned addresses.
+//
+// 1. aligned_array_alloc(TYPE, COUNT, ALIGNMENT) -> TYPE*
+//      * uninitialized, like malloc; ALIGNMENT is a power of two, and one below _Alignof(TYPE) is raised to it
+//      * NULL when out of memory, too large, or when ALIGNMENT is 0 or not a power of two, even one below _Alignof(TYPE)
+// 2. aligned_array_calloc(TYPE, COUNT, ALIGNMENT) -> TYPE*
+//      * zeroed, like calloc
+// 3. aligned_array_free(POINTER)
+//      * POINTER must come from aligned_array_alloc or aligned_array_calloc, and never goes to free() or sized_free()
+// 4. allocated_info(POINTER) -> allocated_record with method "allocated"
+//      * .alignment is at least ALIGNMENT
+//      * exact .totalsize and .arraysize with FLORESTAN_TRACKED_ALLOC (registered) or FLORESTAN_SIZED_ALLOC (with a header),
+//        the usable size of the block otherwise, as for malloc
+
+#ifndef FLORESTAN_ALIGNED_ARRAY_H
+#define FLORESTAN_ALIGNED_ARRAY_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define __aligned_round(n, alignment) (((n) + ((alignment) - 1)) & ~(size_t)((alignment) - 1))
+
+#ifdef FLORESTAN_SIZED_ALLOC
+// The sized header sits right before the block as usual, and the pointer aligned_alloc returned right before the header.
+#define __aligned_space(alignment) __aligned_round(__SIZED_HEADER_SPACE + sizeof(void*), alignment)
+#define __aligned_raw(p) (((void**)((unsigned char*)(p) - __SIZED_HEADER_SPACE))[-1])
+#else
+#define __aligned_space(alignment) ((size_t)0)
+#define __aligned_raw(p) ((void*)(p))
+#endif
+
+static inline void* __aligned_array_alloc(size_t count, size_t typesize, size_t alignment, int type_id, bool zero, const char* site) {
+    if (alignment == 0 || (alignment & (alignment - 1)) || alignment > SIZE_MAX / 4) return NULL;
+    if (alignment < sizeof(void*)) alignment = sizeof(void*);
+    size_t space = __aligned_space(alignment);
+    if (typesize && count > (SIZE_MAX / 2 - space - alignment) / typesize) return NULL;
+    size_t size = count * typesize;
+    // C11 wants the size to be a multiple of the alignment.
+    unsigned char* raw = aligned_alloc(alignment, __aligned_round(space + (size ? size : 1), alignment));
+    if (raw == NULL) return NULL;
+    unsigned char* p = raw + space;
+    if (zero) memset(p, 0, size);
+#ifdef FLORESTAN_SIZED_ALLOC
+    __sized_stamp(p - __SIZED_HEADER_SPACE, count, typesize, type_id);
+    __aligned_raw(p) = raw;
+#else
+    (void)type_id;
+#endif
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(p, size, typesize, allocated, NULL);
+#endif
+    __heap_profile_note(size, typesize, allocated, site);
+    return p;
+}
+// Only a valid ALIGNMENT is raised to the type's own; an invalid one stays 0, which __aligned_array_alloc rejects.
+static inline size_t __aligned_least(size_t alignment, size_t least) {
+    if (alignment == 0 || (alignment & (alignment - 1))) return 0;
+    return alignment > least ? alignment : least;
+}
+#define aligned_array_alloc(T, count, alignment) \
+    ((T*)__aligned_array_alloc((count), sizeof(T), __aligned_least((alignment), _Alignof(T)), type_id((T){0}), false, FLORESTAN_CALL_SITE))
+#define aligned_array_calloc(T, count, alignment) \
+    ((T*)__aligned_array_alloc((count), sizeof(T), __aligned_least((alignment), _Alignof(T)), type_id((T){0}), true, FLORESTAN_CALL_SITE))
+
+static inline void __aligned_array_free(void* p) {
+    if (p == NULL) return;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_remove(p);
+#endif
+    free(__aligned_raw(p));
+}
+#define aligned_array_free(p) __aligned_array_free((void*)(p))
+
+#endif
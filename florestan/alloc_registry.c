@@ -0,0 +1,365 @@
+// Florestan's Allocation Registry
+//
+// © dongwanpianist
+//
+// Every block owns one entry that carries its allocated_block
+// and all the nodes that link it into the registry:
+//      * one "exact" node keyed by the base address
+//      * one "granule" node per granule the block touches,
+//        or, when it touches more than FLORESTAN_REGISTRY_SPAN granules, one span in the large index instead
+// The large index is an array of spans sorted by base address, behind a reader-writer spinlock:
+// registered blocks never overlap, so the one to look at is the last span starting at or below the pointer,
+// one binary search away, and lookups only ever share the lock. It is skipped without a lock while it is empty.
+// The entry and its nodes come from a single malloc, and an entry is freed only after
+// all of its nodes and its span are unlinked under their locks, so a lookup holding a lock never sees a dangling entry.
+// When the registry itself runs out of memory, the tracked_* wrappers still return the block;
+// allocated_info() then falls back to alloc_sizeof for it.
+
+#include "alloc_registry.h"
+#include "type_traits.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+
+#define __REGISTRY_INITIAL_BUCKETS 64
+
+typedef struct __registry_node {
+    struct __registry_node* next;
+    uintptr_t key;
+    struct __registry_entry* entry;
+} registry_node;
+
+typedef struct __registry_entry {
+    allocated_block block;
+    registry_resolver resolve;
+    registry_node exact;
+    size_t node_count;
+    bool large;
+    registry_node nodes[];
+} registry_entry;
+
+typedef struct __registry_shard {
+    _Alignas(64) atomic_flag lock;
+    size_t count;
+    size_t mask;
+    registry_node** buckets;
+} registry_shard;
+
+typedef struct __registry_span {
+    uintptr_t base;
+    registry_entry* entry;
+} registry_span;
+
+// state counts the readers inside, or is __REGISTRY_WRITER while a writer is waiting for them to leave or is inside.
+typedef struct __registry_large_index {
+    _Alignas(64) atomic_size_t state;
+    atomic_size_t count;
+    size_t capacity;
+    registry_span* spans;
+} registry_large_index;
+#define __REGISTRY_WRITER ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+static registry_shard __exact_shards[FLORESTAN_REGISTRY_SHARDS];
+static registry_shard __granule_shards[FLORESTAN_REGISTRY_SHARDS];
+static registry_large_index __large_index;
+
+static inline uint64_t __registry_hash(uintptr_t key) {
+    uint64_t h = (uint64_t)key * 0x9E3779B97F4A7C15ull;
+    return h ^ (h >> 29);
+}
+static inline registry_shard* __registry_shard_of(registry_shard* shards, uint64_t hash) {
+    return &shards[(hash >> 48) & (FLORESTAN_REGISTRY_SHARDS - 1)];
+}
+static inline void __registry_lock(registry_shard* shard) {
+    while (atomic_flag_test_and_set_explicit(&shard->lock, memory_order_acquire));
+}
+static inline void __registry_unlock(registry_shard* shard) {
+    atomic_flag_clear_explicit(&shard->lock, memory_order_release);
+}
+
+// Writers go first: once one has set the bit, no reader enters until it is done.
+static inline void __registry_read_lock(registry_large_index* index) {
+    for (;;) {
+        size_t state = atomic_load_explicit(&index->state, memory_order_relaxed);
+        if (!(state & __REGISTRY_WRITER)
+            && atomic_compare_exchange_weak_explicit(&index->state, &state, state + 1, memory_order_acquire, memory_order_relaxed)) return;
+    }
+}
+static inline void __registry_read_unlock(registry_large_index* index) {
+    atomic_fetch_sub_explicit(&index->state, 1, memory_order_release);
+}
+static inline void __registry_write_lock(registry_large_index* index) {
+    while (atomic_fetch_or_explicit(&index->state, __REGISTRY_WRITER, memory_order_acquire) & __REGISTRY_WRITER);
+    while (atomic_load_explicit(&index->state, memory_order_acquire) != __REGISTRY_WRITER);
+}
+static inline void __registry_write_unlock(registry_large_index* index) {
+    atomic_store_explicit(&index->state, 0, memory_order_release);
+}
+
+// The number of spans whose base is at or below ADDRESS; called with the lock held either way.
+static size_t __registry_span_rank(const registry_large_index* index, uintptr_t address) {
+    size_t lo = 0, hi = atomic_load_explicit(&index->count, memory_order_relaxed);
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (index->spans[mid].base <= address) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+static bool __registry_span_insert(registry_entry* entry) {
+    registry_large_index* index = &__large_index;
+    uintptr_t base = (uintptr_t)entry->block.base;
+    bool inserted = true;
+    __registry_write_lock(index);
+    size_t count = atomic_load_explicit(&index->count, memory_order_relaxed);
+    if (count == index->capacity) {
+        size_t capacity = index->capacity ? index->capacity * 2 : 16;
+        registry_span* grown = realloc(index->spans, capacity * sizeof(registry_span));
+        if (grown) {
+            index->spans = grown;
+            index->capacity = capacity;
+        } else inserted = false;
+    }
+    if (inserted) {
+        size_t rank = __registry_span_rank(index, base);
+        memmove(&index->spans[rank + 1], &index->spans[rank], (count - rank) * sizeof(registry_span));
+        index->spans[rank] = (registry_span){ base, entry };
+        atomic_store_explicit(&index->count, count + 1, memory_order_relaxed);
+    }
+    __registry_write_unlock(index);
+    return inserted;
+}
+static void __registry_span_remove(registry_entry* entry) {
+    registry_large_index* index = &__large_index;
+    __registry_write_lock(index);
+    size_t count = atomic_load_explicit(&index->count, memory_order_relaxed);
+    size_t rank = __registry_span_rank(index, (uintptr_t)entry->block.base);
+    if (rank && index->spans[rank - 1].entry == entry) {
+        memmove(&index->spans[rank - 1], &index->spans[rank], (count - rank) * sizeof(registry_span));
+        atomic_store_explicit(&index->count, count - 1, memory_order_relaxed);
+    }
+    __registry_write_unlock(index);
+}
+
+// Called with the shard lock held.
+static bool __registry_link(registry_shard* shard, uint64_t hash, registry_node* node) {
+    if (shard->buckets == NULL || shard->count >= shard->mask + 1) {
+        size_t buckets = shard->buckets ? (shard->mask + 1) * 2 : __REGISTRY_INITIAL_BUCKETS;
+        registry_node** grown = calloc(buckets, sizeof(registry_node*));
+        if (grown == NULL) {
+            if (shard->buckets == NULL) return false;
+        } else {
+            for (size_t i = 0; shard->buckets && i <= shard->mask; i++) {
+                registry_node* n = shard->buckets[i];
+                while (n) {
+                    registry_node* next = n->next;
+                    size_t slot = __registry_hash(n->key) & (buckets - 1);
+                    n->next = grown[slot];
+                    grown[slot] = n;
+                    n = next;
+                }
+            }
+            free(shard->buckets);
+            shard->buckets = grown;
+            shard->mask = buckets - 1;
+        }
+    }
+    registry_node** slot = &shard->buckets[hash & shard->mask];
+    node->next = *slot;
+    *slot = node;
+    shard->count++;
+    return true;
+}
+// Called with the shard lock held.
+static void __registry_unlink(registry_shard* shard, uint64_t hash, registry_node* node) {
+    registry_node** slot = &shard->buckets[hash & shard->mask];
+    while (*slot && *slot != node) slot = &(*slot)->next;
+    if (*slot) {
+        *slot = node->next;
+        shard->count--;
+    }
+}
+static void __registry_unlink_nodes(registry_entry* entry, size_t linked) {
+    for (size_t i = 0; i < linked; i++) {
+        registry_node* node = &entry->nodes[i];
+        uint64_t hash = __registry_hash(node->key);
+        registry_shard* shard = __registry_shard_of(__granule_shards, hash);
+        __registry_lock(shard);
+        __registry_unlink(shard, hash, node);
+        __registry_unlock(shard);
+    }
+}
+static inline bool __registry_contains(const allocated_block* block, uintptr_t p) {
+    uintptr_t base = (uintptr_t)block->base;
+    return p >= base && p - base < block->size;
+}
+
+// By address, not by pointer: gcc takes a const void* parameter for a read of the fresh block behind it.
+static bool __registry_insert_at(uintptr_t address, size_t size, size_t typesize, unsigned char method, registry_resolver resolve) {
+    uintptr_t first = address >> FLORESTAN_REGISTRY_GRANULE_SHIFT;
+    uintptr_t last = (address + (size ? size - 1 : 0)) >> FLORESTAN_REGISTRY_GRANULE_SHIFT;
+    size_t span = (size_t)(last - first) + 1;
+    bool large = span > FLORESTAN_REGISTRY_SPAN;
+    size_t node_count = large ? 0 : span;
+
+    registry_entry* entry = malloc(sizeof(registry_entry) + node_count * sizeof(registry_node));
+    if (entry == NULL) return false;
+    entry->block = (allocated_block){ (const void*)address, size, typesize, method, NULL };
+    entry->resolve = resolve;
+    entry->node_count = node_count;
+    entry->large = large;
+    entry->exact = (registry_node){ NULL, address, entry };
+
+    uint64_t hash = __registry_hash(address);
+    registry_shard* shard = __registry_shard_of(__exact_shards, hash);
+    __registry_lock(shard);
+    bool linked = __registry_link(shard, hash, &entry->exact);
+    __registry_unlock(shard);
+    if (!linked) {
+        free(entry);
+        return false;
+    }
+
+    size_t i = 0;
+    if (large) linked = __registry_span_insert(entry);
+    for (; linked && i < node_count; i++) {
+        registry_node* node = &entry->nodes[i];
+        *node = (registry_node){ NULL, first + i, entry };
+        uint64_t granule_hash = __registry_hash(node->key);
+        registry_shard* granule_shard = __registry_shard_of(__granule_shards, granule_hash);
+        __registry_lock(granule_shard);
+        linked = __registry_link(granule_shard, granule_hash, node);
+        __registry_unlock(granule_shard);
+    }
+    if (!linked) {
+        __registry_unlink_nodes(entry, i ? i - 1 : 0);
+        __registry_lock(shard);
+        __registry_unlink(shard, hash, &entry->exact);
+        __registry_unlock(shard);
+        free(entry);
+        return false;
+    }
+    return true;
+}
+bool __registry_insert(const void* base, size_t size, size_t typesize, unsigned char method, registry_resolver resolve) {
+    return __registry_insert_at((uintptr_t)base, size, typesize, method, resolve);
+}
+
+bool __registry_remove(const void* base) {
+    uintptr_t address = (uintptr_t)base;
+    uint64_t hash = __registry_hash(address);
+    registry_shard* shard = __registry_shard_of(__exact_shards, hash);
+    registry_entry* entry = NULL;
+    __registry_lock(shard);
+    if (shard->buckets) {
+        registry_node** slot = &shard->buckets[hash & shard->mask];
+        while (*slot && (*slot)->key != address) slot = &(*slot)->next;
+        if (*slot) {
+            entry = (*slot)->entry;
+            *slot = (*slot)->next;
+            shard->count--;
+        }
+    }
+    __registry_unlock(shard);
+    if (entry == NULL) return false;
+    if (entry->large) __registry_span_remove(entry);
+    __registry_unlink_nodes(entry, entry->node_count);
+    free(entry);
+    return true;
+}
+
+// The resolver runs after the shard lock is released; it may read the block's memory.
+bool __registry_lookup(const void* p, allocated_block* block) {
+    uintptr_t address = (uintptr_t)p;
+    registry_resolver resolve = NULL;
+    bool found = false;
+
+    uint64_t hash = __registry_hash(address);
+    registry_shard* shard = __registry_shard_of(__exact_shards, hash);
+    __registry_lock(shard);
+    if (shard->buckets) {
+        for (registry_node* n = shard->buckets[hash & shard->mask]; n; n = n->next) {
+            if (n->key == address) {
+                *block = n->entry->block;
+                resolve = n->entry->resolve;
+                found = true;
+                break;
+            }
+        }
+    }
+    __registry_unlock(shard);
+    if (found) goto resolved;
+
+    uintptr_t granule = address >> FLORESTAN_REGISTRY_GRANULE_SHIFT;
+    hash = __registry_hash(granule);
+    shard = __registry_shard_of(__granule_shards, hash);
+    __registry_lock(shard);
+    if (shard->buckets) {
+        for (registry_node* n = shard->buckets[hash & shard->mask]; n; n = n->next) {
+            if (n->key == granule && __registry_contains(&n->entry->block, address)) {
+                *block = n->entry->block;
+                resolve = n->entry->resolve;
+                found = true;
+                break;
+            }
+        }
+    }
+    __registry_unlock(shard);
+    if (found) goto resolved;
+
+    registry_large_index* index = &__large_index;
+    if (atomic_load_explicit(&index->count, memory_order_relaxed) == 0) return false;
+    __registry_read_lock(index);
+    size_t rank = __registry_span_rank(index, address);
+    if (rank && __registry_contains(&index->spans[rank - 1].entry->block, address)) {
+        *block = index->spans[rank - 1].entry->block;
+        resolve = index->spans[rank - 1].entry->resolve;
+        found = true;
+    }
+    __registry_read_unlock(index);
+    if (!found) return false;
+resolved:
+    if (resolve) resolve(block, p);
+    return true;
+}
+
+void* __tracked_malloc(size_t size, const char* site) {
+    void* p = malloc(size);
+    if (p) {
+        __registry_insert_at((uintptr_t)p, size, 0, allocated, NULL);
+        __heap_profile_note(size, 0, allocated, site);
+    }
+    return p;
+}
+void* __tracked_calloc(size_t count, size_t typesize, const char* site) {
+    void* p = calloc(count, typesize);
+    if (p) {
+        __registry_insert_at((uintptr_t)p, count * typesize, typesize, allocated, NULL);
+        __heap_profile_note(count * typesize, typesize, allocated, site);
+    }
+    return p;
+}
+void* __tracked_realloc(void* p, size_t size, const char* site) {
+    if (p == NULL) return __tracked_malloc(size, site);
+    // realloc(p, 0) may free p and return NULL, so that record must not come back: free it here, on every C library.
+    if (size == 0) {
+        __tracked_free(p);
+        return NULL;
+    }
+    allocated_block old;
+    bool tracked = __registry_lookup(p, &old) && old.base == p;
+    if (tracked) __registry_remove(p);
+    void* q = realloc(p, size);
+    if (q == NULL) {
+        if (tracked) __registry_insert_at((uintptr_t)p, old.size, old.typesize, old.method, NULL);
+        return NULL;
+    }
+    __registry_insert_at((uintptr_t)q, size, tracked ? old.typesize : 0, allocated, NULL);
+    __heap_profile_note(size, tracked ? old.typesize : 0, allocated, site);
+    return q;
+}
+void __tracked_free(void* p) {
+    if (p == NULL) return;
+    __registry_remove(p);
+    free(p);
+}
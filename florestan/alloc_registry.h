@@ -0,0 +1,77 @@
+// Florestan's Allocation Registry
+//
+// © dongwanpianist
+//
+// allocated_info() can only ask the OS allocator (alloc_sizeof) about a pointer,
+// which gives the usable size of a fresh malloc block and nothing else.
+// This is an opt-in layer that remembers every block handed out by the tracked_* wrappers,
+// so allocated_info() can report the exact requested size, element size, and even resolve interior pointers.
+//
+// Build florestan/alloc_registry.c with your program and #define FLORESTAN_TRACKED_ALLOC
+// before including <florestan/type_traits.h> to let allocated_info() consult the registry.
+//
+// 1. tracked_malloc(SIZE) -> void*
+// 2. tracked_calloc(COUNT, TYPESIZE) -> void*
+//      * the element size is recorded, so even a void* reports the correct arraysize
+// 3. tracked_realloc(POINTER, SIZE) -> void*
+//      * SIZE 0 frees POINTER and returns NULL; a failed realloc leaves POINTER and its record as they were
+// 4. tracked_free(POINTER)
+// 5. allocated_block   (typedef struct __allocated_block)
+//      .base           (const void*)
+//      .size           (size_t) requested bytes, not the usable size
+//      .typesize       (size_t) 0 when unknown
+//      .method         (unsigned char) a value of allocated_record's enum methods
+//      .shape          (const ndarray_shape*) NULL, unless a resolver of <florestan/ndarray.h> sets it
+// 6. __registry_insert / __registry_remove / __registry_lookup
+//      * for other florestan allocators that want allocated_info() to recognize their blocks
+//      * a block that holds smaller blocks of its own (like an arena chunk) can pass a registry_resolver,
+//        which narrows the found block down to the one that actually contains the pointer
+//
+// Lookups of the block's own address take one hash probe on one shard.
+// Interior pointers are resolved by the 4 KiB granule they fall in:
+// blocks spanning up to FLORESTAN_REGISTRY_SPAN granules are indexed by every granule they touch,
+// and larger blocks in an array sorted by address, found with one binary search under a lock that lookups share.
+// The registry is split into FLORESTAN_REGISTRY_SHARDS shards with their own spinlocks,
+// so threads working on different blocks rarely touch the same lock.
+
+#ifndef FLORESTAN_ALLOC_REGISTRY_H
+#define FLORESTAN_ALLOC_REGISTRY_H
+#include "heap_profile.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifndef FLORESTAN_REGISTRY_SHARDS
+    #define FLORESTAN_REGISTRY_SHARDS 64 // power of two
+#endif
+#ifndef FLORESTAN_REGISTRY_GRANULE_SHIFT
+    #define FLORESTAN_REGISTRY_GRANULE_SHIFT 12
+#endif
+#ifndef FLORESTAN_REGISTRY_SPAN
+    #define FLORESTAN_REGISTRY_SPAN 16
+#endif
+
+typedef struct __allocated_block {
+    const void* base;
+    size_t size;
+    size_t typesize;
+    unsigned char method;
+    const struct __ndarray_shape* shape;
+} allocated_block;
+typedef void (*registry_resolver)(allocated_block* block, const void* p);
+
+bool __registry_insert(const void* base, size_t size, size_t typesize, unsigned char method, registry_resolver resolve);
+bool __registry_remove(const void* base);
+bool __registry_lookup(const void* p, allocated_block* block);
+
+// site is the call site for <florestan/heap_profile.h>
+void* __tracked_malloc(size_t size, const char* site);
+void* __tracked_calloc(size_t count, size_t typesize, const char* site);
+void* __tracked_realloc(void* p, size_t size, const char* site);
+void __tracked_free(void* p);
+
+#define tracked_malloc(size) __tracked_malloc(size, FLORESTAN_CALL_SITE)
+#define tracked_calloc(count, typesize) __tracked_calloc(count, typesize, FLORESTAN_CALL_SITE)
+#define tracked_realloc(p, size) __tracked_realloc((void*)(p), size, FLORESTAN_CALL_SITE)
+#define tracked_free(p) __tracked_free((void*)(p))
+
+#endif
@@ -0,0 +1,168 @@
+// Florestan's Arena
+//
+// © dongwanpianist
+//
+// A bump allocator for request-scoped work: many small arrays are carved out of a few big chunks,
+// and all of them are thrown away at once with arena_reset() instead of one free() each.
+// Chunks are kept after a reset, so a steady workload stops calling malloc at all.
+//
+// 1. memory_arena      (typedef struct __memory_arena)
+// 2. arena_init(ARENA_POINTER, CHUNK_SIZE)
+//      * CHUNK_SIZE 0 means FLORESTAN_ARENA_CHUNK_SIZE
+// 3. arena_new(ARENA_POINTER, TYPE, COUNT) -> TYPE*
+//      * every block is aligned for any fundamental type; NULL when out of memory
+// 4. arena_reset(ARENA_POINTER)
+//      * every block from this arena becomes invalid, but the chunks stay for reuse
+// 5. arena_destroy(ARENA_POINTER)
+// 6. allocated_info(BLOCK) -> allocated_record with method "arena"
+//      * only when FLORESTAN_TRACKED_ALLOC is defined where the arena is initialized:
+//        each chunk is registered once, and each block carries a small header with its size and type size,
+//        so no libc call is involved. Untracked arenas skip the headers entirely.
+//
+// A memory_arena is not thread-safe; keep one per thread or per request.
+
+#ifndef FLORESTAN_ARENA_H
+#define FLORESTAN_ARENA_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FLORESTAN_ARENA_CHUNK_SIZE
+    #define FLORESTAN_ARENA_CHUNK_SIZE ((size_t)32 * 1024) // small enough for the registry to index by granule
+#endif
+#define __ARENA_ALIGN _Alignof(max_align_t)
+#define __arena_round(n) (((n) + (__ARENA_ALIGN - 1)) & ~(size_t)(__ARENA_ALIGN - 1))
+
+typedef struct __arena_chunk {
+    struct __arena_chunk* next;
+    size_t capacity;
+    size_t used;
+    max_align_t data[];
+} arena_chunk;
+
+typedef struct __arena_header {
+    size_t size;
+    size_t typesize;
+    unsigned int check;
+} arena_header;
+#define __ARENA_HEADER_SIZE __arena_round(sizeof(arena_header))
+
+typedef struct __memory_arena {
+    arena_chunk* first;
+    arena_chunk* current;
+    size_t chunk_size;
+    bool tracked;
+} memory_arena;
+
+static inline unsigned int __arena_check(const void* block, size_t size) {
+    uint64_t h = ((uint64_t)(uintptr_t)block ^ (uint64_t)size) * 0x9E3779B97F4A7C15ull;
+    return (unsigned int)(h >> 32);
+}
+
+#ifdef FLORESTAN_TRACKED_ALLOC
+// Narrows a registered chunk down to the block containing p.
+// A block's own address is confirmed by its header's check value; any other pointer walks the chunk.
+static inline void __arena_resolve(allocated_block* block, const void* p) {
+    const arena_chunk* chunk = block->base;
+    const unsigned char* data = (const unsigned char*)chunk->data;
+    const unsigned char* address = p;
+    size_t offset = (size_t)(address - data);
+    *block = (allocated_block){ p, 0, 0, arena, NULL };
+    if (address < data || offset >= chunk->used) return;
+
+    if (offset >= __ARENA_HEADER_SIZE && offset % __ARENA_ALIGN == 0) {
+        const arena_header* header = (const arena_header*)(address - __ARENA_HEADER_SIZE);
+        if (header->check == __arena_check(address, header->size)) {
+            *block = (allocated_block){ p, header->size, header->typesize, arena, NULL };
+            return;
+        }
+    }
+    for (size_t at = 0; at < chunk->used;) {
+        const arena_header* header = (const arena_header*)(data + at);
+        size_t start = at + __ARENA_HEADER_SIZE;
+        if (offset < start) return;
+        if (offset < start + header->size) {
+            *block = (allocated_block){ data + start, header->size, header->typesize, arena, NULL };
+            return;
+        }
+        at = start + __arena_round(header->size);
+    }
+}
+#endif
+
+#define arena_init(a, chunk_size) __arena_init((a), (chunk_size))
+static inline void __arena_init(memory_arena* a, size_t chunk_size) {
+#ifdef FLORESTAN_TRACKED_ALLOC
+    bool tracked = true;
+#else
+    bool tracked = false;
+#endif
+    *a = (memory_arena){ NULL, NULL, chunk_size ? chunk_size : FLORESTAN_ARENA_CHUNK_SIZE, tracked };
+}
+
+static inline arena_chunk* __arena_chunk_new(memory_arena* a, size_t capacity) {
+    arena_chunk* chunk = malloc(sizeof(arena_chunk) + capacity);
+    if (chunk == NULL) return NULL;
+    chunk->next = NULL;
+    chunk->capacity = capacity;
+    chunk->used = 0;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    if (a->tracked) __registry_insert(chunk, sizeof(arena_chunk) + capacity, 0, arena, __arena_resolve);
+#else
+    (void)a;
+#endif
+    return chunk;
+}
+
+// Slow path: the current chunk is full. Reuse the next kept chunk if it fits, otherwise splice in a new one.
+static inline arena_chunk* __arena_grow(memory_arena* a, size_t need) {
+    arena_chunk* next = a->current ? a->current->next : a->first;
+    if (next && next->capacity >= need) return a->current = next;
+    arena_chunk* chunk = __arena_chunk_new(a, need > a->chunk_size ? need : a->chunk_size);
+    if (chunk == NULL) return NULL;
+    chunk->next = next;
+    if (a->current) a->current->next = chunk;
+    else a->first = chunk;
+    return a->current = chunk;
+}
+
+static inline void* __arena_alloc(memory_arena* a, size_t typesize, size_t count, const char* site) {
+    if (typesize && count > (SIZE_MAX - 2 * __ARENA_HEADER_SIZE) / typesize) return NULL;
+    size_t size = typesize * count;
+    size_t header = a->tracked ? __ARENA_HEADER_SIZE : 0;
+    size_t need = header + __arena_round(size);
+    arena_chunk* chunk = a->current;
+    if (chunk == NULL || chunk->capacity - chunk->used < need) {
+        chunk = __arena_grow(a, need);
+        if (chunk == NULL) return NULL;
+    }
+    unsigned char* block = (unsigned char*)chunk->data + chunk->used + header;
+    chunk->used += need;
+    if (header) *(arena_header*)(block - header) = (arena_header){ size, typesize, __arena_check(block, size) };
+    __heap_profile_note(size, typesize, arena, site);
+    return block;
+}
+#define arena_new(a, T, n) ((T*)__arena_alloc((a), sizeof(T), (n), FLORESTAN_CALL_SITE))
+
+#define arena_reset(a) __arena_reset(a)
+static inline void __arena_reset(memory_arena* a) {
+    for (arena_chunk* chunk = a->first; chunk; chunk = chunk->next) chunk->used = 0;
+    a->current = a->first;
+}
+
+#define arena_destroy(a) __arena_destroy(a)
+static inline void __arena_destroy(memory_arena* a) {
+    arena_chunk* chunk = a->first;
+    while (chunk) {
+        arena_chunk* next = chunk->next;
+#ifdef FLORESTAN_TRACKED_ALLOC
+        if (a->tracked) __registry_remove(chunk);
+#endif
+        free(chunk);
+        chunk = next;
+    }
+    a->first = a->current = NULL;
+}
+
+#endif
@@ -0,0 +1,443 @@
+// Florestan's Array Compress
+//
+// © dongwanpianist
+//
+// Lossless codecs for arrays of a fundamental type, picked by the element type like <florestan/array_convert.h>.
+// Integers are stored as the differences between neighbours, zigzagged so that small negative ones stay small,
+// and floats as the XOR of each value's bits with the previous ones (as Gorilla does), which leaves the bits they share zero.
+// Every block of 256 of those is then bit-packed: the block's minimum is subtracted (frame of reference),
+// the trailing zero bits all of them share are dropped, and each is stored in just as many bits as the largest needs.
+// A full block is packed in lanes, value i in lane i % 8 (i % 4 for 64-bit values), so that AVX2 unpacks eight at once
+// with shifts alone, and decoding runs at several GB/s.
+//
+// 1. array_compress_bound(POINTER_OR_ARRAY [, COUNT]) -> size_t
+//      * the most bytes array_compress() can write for COUNT elements of this type
+// 2. array_compress(DESTINATION, SOURCE [, COUNT]) -> size_t
+//      * writes a header and the encoded SOURCE into DESTINATION (any byte buffer of array_compress_bound() bytes),
+//        and returns the bytes written
+//      * COUNT is allocated_info(SOURCE).arraysize when omitted
+// 3. array_decompress(DESTINATION, BUFFER, SIZE) -> bool
+//      * decodes the SIZE bytes of BUFFER into DESTINATION, which holds array_compressed_count(BUFFER) elements
+//      * false when BUFFER is shorter than its header says, damaged, or was not compressed from DESTINATION's type
+//        by a machine with the same byte order
+// 4. array_compressed_count(BUFFER) -> size_t
+//    array_compressed_size(BUFFER) -> size_t (bytes, the header included)
+// 5. array_compressed_header  (typedef struct __array_compressed_header, at the start of BUFFER, not aligned)
+//      .magic          (char[4]) "FLCZ"
+//      .endianness     (uint32_t) 0x01020304 as the compressing machine stores it
+//      .type_id        (uint16_t) type_id() of the element
+//      .typesize       (uint8_t)
+//      .codec          (uint8_t) __ARRAY_CODEC_RAW, __ARRAY_CODEC_DELTA or __ARRAY_CODEC_XOR
+//      .version        (uint8_t) FLORESTAN_ARRAY_COMPRESS_VERSION
+//      .count          (uint64_t) elements
+//      .size           (uint64_t) bytes, the header included
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double (SOURCE may be const),
+//        and long double, which is only copied
+
+#ifndef FLORESTAN_ARRAY_COMPRESS_H
+#define FLORESTAN_ARRAY_COMPRESS_H
+#include "type_traits.h"
+#include "simd.h"
+#include "counters.h"
+#include <stdint.h>
+#include <string.h>
+
+#define FLORESTAN_ARRAY_COMPRESS_VERSION 1
+#define __ARRAY_COMPRESS_MAGIC "FLCZ"
+#define __ARRAY_COMPRESS_ENDIANNESS 0x01020304u
+#define __ARRAY_COMPRESS_BLOCK 256 // values; a full block packs into 32 bytes per bit of width
+#define __ARRAY_CODEC_RAW   0
+#define __ARRAY_CODEC_DELTA 1
+#define __ARRAY_CODEC_XOR   2
+
+typedef struct __array_compressed_header {
+    char magic[4];
+    uint32_t endianness;
+    uint16_t type_id;
+    uint8_t typesize;
+    uint8_t codec;
+    uint8_t version;
+    unsigned char reserved[3];
+    uint64_t count;
+    uint64_t size;
+} array_compressed_header;
+_Static_assert(sizeof(array_compressed_header) == 32, "array_compressed_header must stay 32 bytes");
+
+// NAME, TYPE, CODEC
+#define __ARRAY_COMPRESS_TYPES(X, ...) \
+    X(char,    char,               __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(schar,   signed char,        __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(uchar,   unsigned char,      __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(short,   short,              __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(ushort,  unsigned short,     __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(int,     int,                __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(uint,    unsigned int,       __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(long,    long,               __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(ulong,   unsigned long,      __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(llong,   long long,          __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(ullong,  unsigned long long, __ARRAY_CODEC_DELTA, __VA_ARGS__) \
+    X(float,   float,              __ARRAY_CODEC_XOR,   __VA_ARGS__) \
+    X(double,  double,             __ARRAY_CODEC_XOR,   __VA_ARGS__) \
+    X(ldouble, long double,        __ARRAY_CODEC_RAW,   __VA_ARGS__)
+
+static inline unsigned __array_compress_ctz(uint64_t x) { // x != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+static inline unsigned __array_compress_bits(uint64_t x) { // the bits x needs, 0 for 0
+#if defined(__GNUC__) || defined(__clang__)
+    return x ? 64 - (unsigned)__builtin_clzll(x) : 0;
+#else
+    unsigned n = 0;
+    while (x) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Values are the integers or float bits widened to W bits. Per block: the width in bits, the shift (the shared trailing zeros),
+// the base (the minimum) and the block's first value (W bits each), then the packed values.
+// A full block of LANES lanes takes WIDTH words of W bits per lane, interleaved lane by lane; the words of lane l are
+// l, l + LANES, l + 2 LANES, ..., and a value that does not fit in the rest of a word continues at the bottom of the lane's next one.
+// A shorter last block is one plain bit stream.
+#define __ARRAY_COMPRESS_DOMAIN(W, U, LANES) \
+static inline U __array_word_load_##W(const unsigned char* in, size_t index) { \
+    U word; \
+    memcpy(&word, in + index * sizeof(U), sizeof(U)); \
+    return word; \
+} \
+static inline void __array_pack_scalar_##W(unsigned char* out, const U* v, unsigned b) { \
+    for (unsigned lane = 0; lane < LANES; lane++) { \
+        U cur = 0; \
+        size_t k = 0; \
+        unsigned bit = 0; \
+        for (unsigned j = 0; j < __ARRAY_COMPRESS_BLOCK / LANES; j++) { \
+            U x = v[j * LANES + lane]; \
+            cur |= (U)(x << bit); \
+            bit += b; \
+            if (bit >= W) { \
+                memcpy(out + (k++ * LANES + lane) * sizeof(U), &cur, sizeof(U)); \
+                bit -= W; \
+                cur = bit ? (U)(x >> (b - bit)) : 0; \
+            } \
+        } \
+    } \
+} \
+static inline void __array_unpack_scalar_##W(const unsigned char* in, U* v, unsigned b) { \
+    const U mask = b == W ? (U)~(U)0 : (U)(((U)1 << b) - 1); \
+    for (unsigned lane = 0; lane < LANES; lane++) { \
+        size_t k = 0; \
+        U cur = b ? __array_word_load_##W(in, lane) : 0; \
+        unsigned bit = 0; \
+        for (unsigned j = 0; j < __ARRAY_COMPRESS_BLOCK / LANES; j++) { \
+            U x = cur >> bit; \
+            bit += b; \
+            if (bit >= W) { \
+                bit -= W; \
+                if (j + 1 < __ARRAY_COMPRESS_BLOCK / LANES || bit) { \
+                    cur = __array_word_load_##W(in, ++k * LANES + lane); \
+                    if (bit) x |= (U)(cur << (b - bit)); \
+                } \
+            } \
+            v[j * LANES + lane] = x & mask; \
+        } \
+    } \
+} \
+static inline unsigned char* __array_pack_tail_##W(unsigned char* out, const U* v, size_t count, unsigned b) { \
+    size_t bytes = (count * b + 7) / 8, bit = 0; \
+    memset(out, 0, bytes); \
+    for (size_t j = 0; j < count; j++) { \
+        for (unsigned k = 0; k < b;) { \
+            unsigned fill = (unsigned)(bit & 7), take = 8 - fill < b - k ? 8 - fill : b - k; \
+            out[bit >> 3] |= (unsigned char)(((v[j] >> k) & ((1u << take) - 1)) << fill); \
+            k += take; \
+            bit += take; \
+        } \
+    } \
+    return out + bytes; \
+} \
+static inline void __array_unpack_tail_##W(const unsigned char* in, U* v, size_t count, unsigned b) { \
+    size_t bit = 0; \
+    for (size_t j = 0; j < count; j++) { \
+        U x = 0; \
+        for (unsigned k = 0; k < b;) { \
+            unsigned fill = (unsigned)(bit & 7), take = 8 - fill < b - k ? 8 - fill : b - k; \
+            x |= (U)((U)((in[bit >> 3] >> fill) & ((1u << take) - 1)) << k); \
+            k += take; \
+            bit += take; \
+        } \
+        v[j] = x; \
+    } \
+} \
+static inline void __array_running_scalar_##W(U* u, size_t count, unsigned shift, U base, U first, bool floating) { \
+    U last = u[0] = first; \
+    if (floating) { \
+        for (size_t j = 1; j < count; j++) u[j] = last ^= (U)((U)(u[j] << shift) + base); \
+    } else { \
+        for (size_t j = 1; j < count; j++) { \
+            U r = (U)((U)(u[j] << shift) + base); \
+            u[j] = last += (U)((r >> 1) ^ (U)(0 - (r & 1))); \
+        } \
+    } \
+}
+__ARRAY_COMPRESS_DOMAIN(32, uint32_t, 8)
+__ARRAY_COMPRESS_DOMAIN(64, uint64_t, 4)
+
+#ifdef FLORESTAN_X86_SIMD
+// The same lane layout, one __m256i word of every lane at a time; the shift counts change with the width, so they go in a register.
+#define __ARRAY_COMPRESS_AVX2(W, U, LANES, EPI, SET1, T1) \
+__SIMD_AVX2 static inline void __array_pack_avx2_##W(unsigned char* out, const U* v, unsigned b) { \
+    __m256i cur = _mm256_setzero_si256(); \
+    unsigned bit = 0; \
+    for (unsigned j = 0; j < __ARRAY_COMPRESS_BLOCK / LANES; j++) { \
+        __m256i x = _mm256_loadu_si256((const __m256i*)(v + j * LANES)); \
+        cur = _mm256_or_si256(cur, _mm256_sll_##EPI(x, _mm_cvtsi32_si128((int)bit))); \
+        bit += b; \
+        if (bit >= W) { \
+            _mm256_storeu_si256((__m256i*)out, cur); \
+            out += 32; \
+            bit -= W; \
+            cur = bit ? _mm256_srl_##EPI(x, _mm_cvtsi32_si128((int)(b - bit))) : _mm256_setzero_si256(); \
+        } \
+    } \
+} \
+__SIMD_AVX2 static inline void __array_unpack_avx2_##W(const unsigned char* in, U* v, unsigned b) { \
+    const __m256i mask = SET1((T1)(b == W ? (U)~(U)0 : (U)(((U)1 << b) - 1))); \
+    __m256i cur = b ? _mm256_loadu_si256((const __m256i*)in) : _mm256_setzero_si256(); \
+    unsigned bit = 0; \
+    for (unsigned j = 0; j < __ARRAY_COMPRESS_BLOCK / LANES; j++) { \
+        __m256i x = _mm256_srl_##EPI(cur, _mm_cvtsi32_si128((int)bit)); \
+        bit += b; \
+        if (bit >= W) { \
+            bit -= W; \
+            if (j + 1 < __ARRAY_COMPRESS_BLOCK / LANES || bit) { \
+                in += 32; \
+                cur = _mm256_loadu_si256((const __m256i*)in); \
+                if (bit) x = _mm256_or_si256(x, _mm256_sll_##EPI(cur, _mm_cvtsi32_si128((int)(b - bit)))); \
+            } \
+        } \
+        _mm256_storeu_si256((__m256i*)(v + j * LANES), _mm256_and_si256(x, mask)); \
+    } \
+}
+__ARRAY_COMPRESS_AVX2(32, uint32_t, 8, epi32, _mm256_set1_epi32, int)
+__ARRAY_COMPRESS_AVX2(64, uint64_t, 4, epi64, _mm256_set1_epi64x, long long)
+// In-register running sums and XORs: within each 128-bit half by byte shifts, then the top of the low half into the high one.
+__SIMD_AVX2 static inline __m256i __array_spread_avx2_32(__m256i x) {
+    return _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(3)), 0xF0);
+}
+__SIMD_AVX2 static inline __m256i __array_spread_avx2_64(__m256i x) {
+    return _mm256_blend_epi32(_mm256_setzero_si256(), _mm256_permute4x64_epi64(x, 0x55), 0xF0);
+}
+__SIMD_AVX2 static inline __m256i __array_sum_avx2_32(__m256i x) {
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 4));
+    x = _mm256_add_epi32(x, _mm256_slli_si256(x, 8));
+    return _mm256_add_epi32(x, __array_spread_avx2_32(x));
+}
+__SIMD_AVX2 static inline __m256i __array_sum_avx2_64(__m256i x) {
+    x = _mm256_add_epi64(x, _mm256_slli_si256(x, 8));
+    return _mm256_add_epi64(x, __array_spread_avx2_64(x));
+}
+__SIMD_AVX2 static inline __m256i __array_xor_avx2_32(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_slli_si256(x, 4));
+    x = _mm256_xor_si256(x, _mm256_slli_si256(x, 8));
+    return _mm256_xor_si256(x, __array_spread_avx2_32(x));
+}
+__SIMD_AVX2 static inline __m256i __array_xor_avx2_64(__m256i x) {
+    x = _mm256_xor_si256(x, _mm256_slli_si256(x, 8));
+    return _mm256_xor_si256(x, __array_spread_avx2_64(x));
+}
+__SIMD_AVX2 static inline __m256i __array_top_avx2_32(__m256i x) { return _mm256_permutevar8x32_epi32(x, _mm256_set1_epi32(7)); }
+__SIMD_AVX2 static inline __m256i __array_top_avx2_64(__m256i x) { return _mm256_permute4x64_epi64(x, 0xFF); }
+// Whole blocks only. The first value's slot starts from zero, so the running sum or XOR carries the first value alone into it.
+#define __ARRAY_COMPRESS_RUNNING_AVX2(W, U, LANES, EPI, SET1, T1, FIRST_SLOT) \
+__SIMD_AVX2 static inline void __array_running_avx2_##W(U* u, size_t count, unsigned shift, U base, U first, bool floating) { \
+    const __m128i amount = _mm_cvtsi32_si128((int)shift); \
+    const __m256i offset = SET1((T1)base), one = SET1(1), zero = _mm256_setzero_si256(); \
+    __m256i carry = SET1((T1)first); \
+    for (size_t j = 0; j < count; j += LANES) { \
+        __m256i r = _mm256_add_##EPI(_mm256_sll_##EPI(_mm256_loadu_si256((const __m256i*)(u + j)), amount), offset); \
+        if (floating) { \
+            if (j == 0) r = _mm256_blend_epi32(r, zero, FIRST_SLOT); \
+            r = _mm256_xor_si256(__array_xor_avx2_##W(r), carry); \
+        } else { \
+            r = _mm256_xor_si256(_mm256_srli_##EPI(r, 1), _mm256_sub_##EPI(zero, _mm256_and_si256(r, one))); \
+            if (j == 0) r = _mm256_blend_epi32(r, zero, FIRST_SLOT); \
+            r = _mm256_add_##EPI(__array_sum_avx2_##W(r), carry); \
+        } \
+        _mm256_storeu_si256((__m256i*)(u + j), r); \
+        carry = __array_top_avx2_##W(r); \
+    } \
+}
+__ARRAY_COMPRESS_RUNNING_AVX2(32, uint32_t, 8, epi32, _mm256_set1_epi32, int, 0x01)
+__ARRAY_COMPRESS_RUNNING_AVX2(64, uint64_t, 4, epi64, _mm256_set1_epi64x, long long, 0x03)
+#define __ARRAY_COMPRESS_PICK(OP, W) (__simd_has_avx2() ? __array_##OP##_avx2_##W : __array_##OP##_scalar_##W)
+#else
+#define __ARRAY_COMPRESS_PICK(OP, W) __array_##OP##_scalar_##W
+#endif
+
+// Each block keeps its first value and stands alone. Encoding turns the rest into residuals in place, the first one's slot
+// holding the base so that it packs as zero; decoding replaces the slots with the values again.
+#define __ARRAY_COMPRESS_BLOCKS(W, U) \
+static inline unsigned char* __array_compress_block_##W(unsigned char* out, U* u, size_t count, bool floating) { \
+    U first = u[0], last = first, base = count > 1 ? (U)~(U)0 : 0, bits = 0; \
+    for (size_t j = 1; j < count; j++) { \
+        U x = u[j], d = (U)(x - last); \
+        u[j] = floating ? x ^ last : (U)((U)(d << 1) ^ (U)(0 - (d >> (W - 1)))); \
+        base = u[j] < base ? u[j] : base; \
+        last = x; \
+    } \
+    u[0] = base; \
+    for (size_t j = 0; j < count; j++) bits |= u[j] -= base; \
+    unsigned shift = bits ? __array_compress_ctz(bits) : 0, width = __array_compress_bits(bits >> shift); \
+    if (shift) for (size_t j = 0; j < count; j++) u[j] >>= shift; \
+    *out++ = (unsigned char)width; \
+    *out++ = (unsigned char)shift; \
+    memcpy(out, &base, sizeof base); \
+    memcpy(out + sizeof base, &first, sizeof first); \
+    out += 2 * sizeof(U); \
+    if (count < __ARRAY_COMPRESS_BLOCK) return __array_pack_tail_##W(out, u, count, width); \
+    __ARRAY_COMPRESS_PICK(pack, W)(out, u, width); \
+    return out + 32 * (size_t)width; \
+} \
+static inline const unsigned char* __array_decompress_block_##W(const unsigned char* in, const unsigned char* end, U* u, size_t count, bool floating) { \
+    if ((size_t)(end - in) < 2 + 2 * sizeof(U)) return NULL; \
+    unsigned width = in[0], shift = in[1]; \
+    U base, last; \
+    memcpy(&base, in + 2, sizeof base); \
+    memcpy(&last, in + 2 + sizeof base, sizeof last); \
+    in += 2 + 2 * sizeof(U); \
+    size_t bytes = count < __ARRAY_COMPRESS_BLOCK ? (count * width + 7) / 8 : 32 * (size_t)width; \
+    if (shift >= W || width + shift > W || (size_t)(end - in) < bytes) return NULL; \
+    if (count < __ARRAY_COMPRESS_BLOCK) __array_unpack_tail_##W(in, u, count, width); \
+    else __ARRAY_COMPRESS_PICK(unpack, W)(in, u, width); \
+    /* the residuals are (u << shift) + base; the values their running sum (of the unzigzagged ones) or XOR from the first */ \
+    if (count < __ARRAY_COMPRESS_BLOCK) __array_running_scalar_##W(u, count, shift, base, last, floating); \
+    else __ARRAY_COMPRESS_PICK(running, W)(u, count, shift, base, last, floating); \
+    return in + bytes; \
+}
+__ARRAY_COMPRESS_BLOCKS(32, uint32_t)
+__ARRAY_COMPRESS_BLOCKS(64, uint64_t)
+
+static inline size_t __array_compress_bound(size_t count, size_t typesize) {
+    return sizeof(array_compressed_header) + (count / __ARRAY_COMPRESS_BLOCK + 1) * (2 + 2 * sizeof(uint64_t))
+        + count * typesize + count / 8 + 1; // the zigzag of a difference takes one bit more than the type
+}
+
+static inline array_compressed_header __array_compressed_header_of(const void* buffer) {
+    array_compressed_header header;
+    memcpy(&header, buffer, sizeof header);
+    return header;
+}
+
+static inline size_t __array_compress_finish(void* destination, const unsigned char* end, size_t count, int type_id, size_t typesize, int codec) {
+    array_compressed_header header = { .endianness = __ARRAY_COMPRESS_ENDIANNESS, .type_id = (uint16_t)type_id,
+        .typesize = (uint8_t)typesize, .codec = (uint8_t)codec, .version = FLORESTAN_ARRAY_COMPRESS_VERSION,
+        .count = count, .size = (uint64_t)(end - (unsigned char*)destination) };
+    memcpy(header.magic, __ARRAY_COMPRESS_MAGIC, sizeof header.magic);
+    memcpy(destination, &header, sizeof header);
+    return (size_t)header.size;
+}
+
+// The encoded data after a header that fits SIZE and the element type, NULL when it does not.
+static inline const unsigned char* __array_decompress_start(const void* buffer, size_t size, int type_id, size_t typesize, int codec) {
+    if (buffer == NULL || size < sizeof(array_compressed_header)) return NULL;
+    array_compressed_header header = __array_compressed_header_of(buffer);
+    bool valid = memcmp(header.magic, __ARRAY_COMPRESS_MAGIC, sizeof header.magic) == 0
+        && header.version == FLORESTAN_ARRAY_COMPRESS_VERSION
+        && header.endianness == __ARRAY_COMPRESS_ENDIANNESS
+        && header.type_id == (uint16_t)type_id
+        && header.typesize == typesize
+        && header.codec == codec
+        && header.size >= sizeof header && header.size <= size
+        && header.count <= SIZE_MAX / typesize;
+    return valid ? (const unsigned char*)buffer + sizeof header : NULL;
+}
+
+#define __ARRAY_COMPRESS_LOOP(U, BODY) { \
+    U u[__ARRAY_COMPRESS_BLOCK]; \
+    for (size_t i = 0; i < n; i += __ARRAY_COMPRESS_BLOCK) { \
+        size_t count = n - i < __ARRAY_COMPRESS_BLOCK ? n - i : __ARRAY_COMPRESS_BLOCK; \
+        BODY \
+    } \
+}
+// Integers widen to 32 or 64 bits by conversion (so signed ones sign-extend), floats by their bits.
+#define __ARRAY_COMPRESS_ENCODE(W, U, CODEC) __ARRAY_COMPRESS_LOOP(U, \
+    if (CODEC == __ARRAY_CODEC_XOR) memcpy(u, p + i, count * sizeof *p); \
+    else for (size_t j = 0; j < count; j++) u[j] = (U)p[i + j]; \
+    out = __array_compress_block_##W(out, u, count, CODEC == __ARRAY_CODEC_XOR); \
+)
+#define __ARRAY_COMPRESS_DECODE(W, U, T, CODEC) __ARRAY_COMPRESS_LOOP(U, \
+    if ((in = __array_decompress_block_##W(in, end, u, count, CODEC == __ARRAY_CODEC_XOR)) == NULL) return false; \
+    if (CODEC == __ARRAY_CODEC_XOR) memcpy(p + i, u, count * sizeof *p); \
+    else for (size_t j = 0; j < count; j++) p[i + j] = (T)u[j]; \
+)
+
+#define __ARRAY_COMPRESS_ENTRY(NAME, T, CODEC, ...) \
+static inline size_t __array_compress_blocks_##NAME(void* destination, const T* p, size_t n) { \
+    unsigned char* out = (unsigned char*)destination + sizeof(array_compressed_header); \
+    if (CODEC == __ARRAY_CODEC_RAW) { \
+        if (n) memcpy(out, p, n * sizeof(T)); \
+        out += n * sizeof(T); \
+    } else if (sizeof(T) <= 4) __ARRAY_COMPRESS_ENCODE(32, uint32_t, CODEC) \
+    else __ARRAY_COMPRESS_ENCODE(64, uint64_t, CODEC) \
+    return __array_compress_finish(destination, out, n, type_id((T){0}), sizeof(T), CODEC); \
+} \
+static inline bool __array_decompress_blocks_##NAME(T* p, const void* buffer, size_t size) { \
+    const unsigned char* in = __array_decompress_start(buffer, size, type_id((T){0}), sizeof(T), CODEC); \
+    if (in == NULL) return false; \
+    array_compressed_header header = __array_compressed_header_of(buffer); \
+    const unsigned char* end = (const unsigned char*)buffer + header.size; \
+    size_t n = (size_t)header.count; \
+    if (CODEC == __ARRAY_CODEC_RAW) { \
+        if ((size_t)(end - in) != n * sizeof(T)) return false; \
+        if (n) memcpy(p, in, n * sizeof(T)); \
+        return true; \
+    } else if (sizeof(T) <= 4) __ARRAY_COMPRESS_DECODE(32, uint32_t, T, CODEC) \
+    else __ARRAY_COMPRESS_DECODE(64, uint64_t, T, CODEC) \
+    return in == end; \
+} \
+static inline size_t __array_compress_##NAME(void* destination, const T* p, size_t n) { \
+    __COUNTER_BEGIN("array_compress", #T) \
+    size_t bytes = __array_compress_blocks_##NAME(destination, p, n); \
+    __COUNTER_END(n * sizeof(T)); \
+    return bytes; \
+} \
+static inline bool __array_decompress_##NAME(T* p, const void* buffer, size_t size) { \
+    __COUNTER_BEGIN("array_decompress", #T) \
+    bool complete = __array_decompress_blocks_##NAME(p, buffer, size); \
+    __COUNTER_END(size); \
+    return complete; \
+}
+__ARRAY_COMPRESS_TYPES(__ARRAY_COMPRESS_ENTRY, )
+
+#define __ARRAY_COMPRESS_ARM(NAME, T, CODEC, OP) T*: __array_##OP##_##NAME,
+#define __ARRAY_COMPRESS_CONST_ARM(NAME, T, CODEC, OP) T*: __array_##OP##_##NAME, const T*: __array_##OP##_##NAME,
+#define __array_compress_generic(OP, p) _Generic((p), __ARRAY_COMPRESS_TYPES(__ARRAY_COMPRESS_ARM, OP) default: NULL)
+#define __array_compress_const_generic(OP, p) _Generic((p), __ARRAY_COMPRESS_TYPES(__ARRAY_COMPRESS_CONST_ARM, OP) default: NULL)
+
+#ifndef __array_argc2
+    #define __array_argc2(_1, _2, NAME, ...) NAME
+#endif
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+
+#define __array_compress_bound_n(p, n) __array_compress_bound((n), sizeof(*(p)))
+#define __array_compress_bound_info(p) __array_compress_bound_n(p, allocated_info(p).arraysize)
+#define array_compress_bound(...) __array_argc2(__VA_ARGS__, __array_compress_bound_n, __array_compress_bound_info, )(__VA_ARGS__)
+
+#define __array_compress_n(destination, source, n) __array_compress_const_generic(compress, source)((void*)(destination), (source), (n))
+#define __array_compress_info(destination, source) __array_compress_n(destination, source, allocated_info(source).arraysize)
+#define array_compress(...) __array_argc3(__VA_ARGS__, __array_compress_n, __array_compress_info, )(__VA_ARGS__)
+
+#define array_decompress(destination, buffer, size) __array_compress_generic(decompress, destination)((destination), (const void*)(buffer), (size))
+
+#define array_compressed_count(buffer) ((size_t)__array_compressed_header_of(buffer).count)
+#define array_compressed_size(buffer) ((size_t)__array_compressed_header_of(buffer).size)
+
+#endif
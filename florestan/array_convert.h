@@ -0,0 +1,251 @@
+// Florestan's Array Convert
+//
+// © dongwanpianist
+//
+// Converts an array of one fundamental type into an array of another, chosen by _Generic on both pointers.
+// Every pair gets its own loop, so nothing goes through a generic element-by-element cast;
+// the pairs that show up most in signal pipelines have SSE2 and AVX2 kernels (picked at runtime, see <florestan/simd.h>):
+//      short, unsigned short, unsigned char, int -> float
+//      int, float -> double
+//      double -> float
+//      float -> int, int -> short (saturating)
+//
+// 1. array_convert(DESTINATION, SOURCE [, COUNT])
+//      * the same as DESTINATION[i] = SOURCE[i] for each element, with the same undefined results for values out of range
+// 2. array_convert_saturate(DESTINATION, SOURCE [, COUNT])
+//      * values out of range become the lowest or highest value of the destination type, and NaN becomes 0 for integers
+//      * floating destinations: finite values too large become the largest finite value, infinities and NaN stay
+//      * COUNT is allocated_info(SOURCE).arraysize when omitted
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double (SOURCE may be const)
+//      * DESTINATION and SOURCE must not overlap
+
+#ifndef FLORESTAN_ARRAY_CONVERT_H
+#define FLORESTAN_ARRAY_CONVERT_H
+#include "type_traits.h"
+#include "simd.h"
+#include "counters.h"
+#include <limits.h>
+#include <float.h>
+#include <stdint.h>
+
+// The class of a type decides how a value is clamped: s(igned), u(nsigned) or f(loating).
+#if CHAR_MIN < 0
+    #define __ARRAY_CONVERT_CHAR_CLASS s
+#else
+    #define __ARRAY_CONVERT_CHAR_CLASS u
+#endif
+
+// NAME, TYPE, LOWEST, HIGHEST, CLASS
+#define __ARRAY_CONVERT_TYPES(X, ...) \
+    X(char,    char,               CHAR_MIN,   CHAR_MAX,   __ARRAY_CONVERT_CHAR_CLASS, __VA_ARGS__) \
+    X(schar,   signed char,        SCHAR_MIN,  SCHAR_MAX,  s, __VA_ARGS__) \
+    X(uchar,   unsigned char,      0,          UCHAR_MAX,  u, __VA_ARGS__) \
+    X(short,   short,              SHRT_MIN,   SHRT_MAX,   s, __VA_ARGS__) \
+    X(ushort,  unsigned short,     0,          USHRT_MAX,  u, __VA_ARGS__) \
+    X(int,     int,                INT_MIN,    INT_MAX,    s, __VA_ARGS__) \
+    X(uint,    unsigned int,       0,          UINT_MAX,   u, __VA_ARGS__) \
+    X(long,    long,               LONG_MIN,   LONG_MAX,   s, __VA_ARGS__) \
+    X(ulong,   unsigned long,      0,          ULONG_MAX,  u, __VA_ARGS__) \
+    X(llong,   long long,          LLONG_MIN,  LLONG_MAX,  s, __VA_ARGS__) \
+    X(ullong,  unsigned long long, 0,          ULLONG_MAX, u, __VA_ARGS__) \
+    X(float,   float,              -FLT_MAX,   FLT_MAX,    f, __VA_ARGS__) \
+    X(double,  double,             -DBL_MAX,   DBL_MAX,    f, __VA_ARGS__) \
+    X(ldouble, long double,        -LDBL_MAX,  LDBL_MAX,   f, __VA_ARGS__)
+// The same list once more, for the source side of every pair: a macro cannot expand inside its own expansion.
+#define __ARRAY_CONVERT_SOURCES(X, ...) \
+    X(__VA_ARGS__, char,    char,               __ARRAY_CONVERT_CHAR_CLASS) \
+    X(__VA_ARGS__, schar,   signed char,        s) \
+    X(__VA_ARGS__, uchar,   unsigned char,      u) \
+    X(__VA_ARGS__, short,   short,              s) \
+    X(__VA_ARGS__, ushort,  unsigned short,     u) \
+    X(__VA_ARGS__, int,     int,                s) \
+    X(__VA_ARGS__, uint,    unsigned int,       u) \
+    X(__VA_ARGS__, long,    long,               s) \
+    X(__VA_ARGS__, ulong,   unsigned long,      u) \
+    X(__VA_ARGS__, llong,   long long,          s) \
+    X(__VA_ARGS__, ullong,  unsigned long long, u) \
+    X(__VA_ARGS__, float,   float,              f) \
+    X(__VA_ARGS__, double,  double,             f) \
+    X(__VA_ARGS__, ldouble, long double,        f)
+
+// Saturating conversion of x from S to D, one body per (source class, destination class).
+// Integers are compared through an intmax_t or uintmax_t copy, which holds every value of both sides.
+#define __ARRAY_CONVERT_CLAMP(SC, DC, D, S, DLOW, DHIGH) __ARRAY_CONVERT_CLAMP_(SC, DC, D, S, DLOW, DHIGH)
+#define __ARRAY_CONVERT_CLAMP_(SC, DC, D, S, DLOW, DHIGH) __ARRAY_CONVERT_CLAMP_##SC##DC(D, S, DLOW, DHIGH)
+#define __ARRAY_CONVERT_CLAMP_ff(D, S, DLOW, DHIGH) \
+    if (sizeof(D) >= sizeof(S) || x - x != x - x) return (D)x; \
+    return x > (S)DHIGH ? DHIGH : x < (S)DLOW ? DLOW : (D)x;
+#define __ARRAY_CONVERT_CLAMP_fs(D, S, DLOW, DHIGH) return x != x ? (D)0 : x <= (S)DLOW ? DLOW : x >= (S)DHIGH ? DHIGH : (D)x;
+#define __ARRAY_CONVERT_CLAMP_fu(D, S, DLOW, DHIGH) return x != x || x <= (S)0 ? (D)0 : x >= (S)DHIGH ? DHIGH : (D)x;
+#define __ARRAY_CONVERT_CLAMP_sf(D, S, DLOW, DHIGH) return (D)x;
+#define __ARRAY_CONVERT_CLAMP_uf(D, S, DLOW, DHIGH) return (D)x;
+#define __ARRAY_CONVERT_CLAMP_ss(D, S, DLOW, DHIGH) \
+    intmax_t v = x; \
+    return v < (intmax_t)DLOW ? DLOW : v > (intmax_t)DHIGH ? DHIGH : (D)v;
+#define __ARRAY_CONVERT_CLAMP_su(D, S, DLOW, DHIGH) \
+    intmax_t v = x; \
+    return v < 0 ? (D)0 : (uintmax_t)v > (uintmax_t)DHIGH ? DHIGH : (D)v;
+#define __ARRAY_CONVERT_CLAMP_us(D, S, DLOW, DHIGH) \
+    uintmax_t v = x; \
+    return v > (uintmax_t)DHIGH ? DHIGH : (D)v;
+#define __ARRAY_CONVERT_CLAMP_uu __ARRAY_CONVERT_CLAMP_us
+
+#define __ARRAY_CONVERT_SCALAR(DN, D, DLOW, DHIGH, DC, SN, S, SC) \
+static inline D __array_saturate_##DN##_##SN(S x) { __ARRAY_CONVERT_CLAMP(SC, DC, D, S, DLOW, DHIGH) } \
+static inline void __array_convert_plain_scalar_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    for (size_t i = 0; i < n; i++) d[i] = (D)s[i]; \
+} \
+static inline void __array_convert_saturate_scalar_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    for (size_t i = 0; i < n; i++) d[i] = __array_saturate_##DN##_##SN(s[i]); \
+}
+#define __ARRAY_CONVERT_SCALAR_ROW(DN, D, DLOW, DHIGH, DC, ...) __ARRAY_CONVERT_SOURCES(__ARRAY_CONVERT_SCALAR, DN, D, DLOW, DHIGH, DC)
+__ARRAY_CONVERT_TYPES(__ARRAY_CONVERT_SCALAR_ROW, )
+
+#ifdef FLORESTAN_X86_SIMD
+// W elements per iteration; the tail goes to the portable loop of the same mode.
+#define __ARRAY_CONVERT_KERNEL(ISA, ATTR, MODE, DN, D, SN, S, W, ...) \
+ATTR static inline void __array_convert_##MODE##_##ISA##_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    size_t i = 0; \
+    for (; i + W <= n; i += W) { __VA_ARGS__ } \
+    __array_convert_##MODE##_scalar_##DN##_##SN(d + i, s + i, n - i); \
+}
+#define __ARRAY_CONVERT_VECTOR(MODE, DN, D, SN, S) \
+static inline void __array_convert_##MODE##_vector_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    (__simd_has_avx2() ? __array_convert_##MODE##_avx2_##DN##_##SN : __array_convert_##MODE##_sse2_##DN##_##SN)(d, s, n); \
+}
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, float, float, short, short, 8,
+    __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+    _mm_storeu_ps(d + i, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16)));
+    _mm_storeu_ps(d + i + 4, _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16)));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, float, float, short, short, 16,
+    _mm256_storeu_ps(d + i, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(s + i)))));
+    _mm256_storeu_ps(d + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(s + i + 8)))));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, float, float, ushort, unsigned short, 8,
+    __m128i v = _mm_loadu_si128((const __m128i*)(s + i));
+    _mm_storeu_ps(d + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128())));
+    _mm_storeu_ps(d + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, _mm_setzero_si128())));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, float, float, ushort, unsigned short, 16,
+    _mm256_storeu_ps(d + i, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(s + i)))));
+    _mm256_storeu_ps(d + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(s + i + 8)))));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, float, float, uchar, unsigned char, 8,
+    __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(s + i)), _mm_setzero_si128());
+    _mm_storeu_ps(d + i, _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, _mm_setzero_si128())));
+    _mm_storeu_ps(d + i + 4, _mm_cvtepi32_ps(_mm_unpackhi_epi16(v, _mm_setzero_si128())));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, float, float, uchar, unsigned char, 16,
+    _mm256_storeu_ps(d + i, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + i)))));
+    _mm256_storeu_ps(d + i + 8, _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(s + i + 8)))));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, float, float, int, int, 8,
+    _mm_storeu_ps(d + i, _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(s + i))));
+    _mm_storeu_ps(d + i + 4, _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)(s + i + 4))));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, float, float, int, int, 16,
+    _mm256_storeu_ps(d + i, _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(s + i))));
+    _mm256_storeu_ps(d + i + 8, _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i*)(s + i + 8))));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, double, double, int, int, 4,
+    _mm_storeu_pd(d + i, _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(s + i))));
+    _mm_storeu_pd(d + i + 2, _mm_cvtepi32_pd(_mm_loadl_epi64((const __m128i*)(s + i + 2))));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, double, double, int, int, 8,
+    _mm256_storeu_pd(d + i, _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(s + i))));
+    _mm256_storeu_pd(d + i + 4, _mm256_cvtepi32_pd(_mm_loadu_si128((const __m128i*)(s + i + 4))));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, double, double, float, float, 4,
+    __m128 v = _mm_loadu_ps(s + i);
+    _mm_storeu_pd(d + i, _mm_cvtps_pd(v));
+    _mm_storeu_pd(d + i + 2, _mm_cvtps_pd(_mm_movehl_ps(v, v)));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, double, double, float, float, 8,
+    _mm256_storeu_pd(d + i, _mm256_cvtps_pd(_mm_loadu_ps(s + i)));
+    _mm256_storeu_pd(d + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(s + i + 4)));)
+
+__ARRAY_CONVERT_KERNEL(sse2, , plain, float, float, double, double, 4,
+    _mm_storeu_ps(d + i, _mm_movelh_ps(_mm_cvtpd_ps(_mm_loadu_pd(s + i)), _mm_cvtpd_ps(_mm_loadu_pd(s + i + 2))));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, plain, float, float, double, double, 8,
+    _mm_storeu_ps(d + i, _mm256_cvtpd_ps(_mm256_loadu_pd(s + i)));
+    _mm_storeu_ps(d + i + 4, _mm256_cvtpd_ps(_mm256_loadu_pd(s + i + 4)));)
+
+// float -> int: NaN lanes are zeroed first, and lanes at 2^31 or above, which the conversion turns into INT_MIN,
+// are flipped to INT_MAX by xor with their all-ones comparison mask.
+__ARRAY_CONVERT_KERNEL(sse2, , saturate, int, int, float, float, 4,
+    __m128 v = _mm_loadu_ps(s + i);
+    v = _mm_and_ps(v, _mm_cmpord_ps(v, v));
+    __m128i big = _mm_castps_si128(_mm_cmpge_ps(v, _mm_set1_ps(2147483648.0f)));
+    _mm_storeu_si128((__m128i*)(d + i), _mm_xor_si128(_mm_cvttps_epi32(v), big));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, saturate, int, int, float, float, 8,
+    __m256 v = _mm256_loadu_ps(s + i);
+    v = _mm256_and_ps(v, _mm256_cmp_ps(v, v, _CMP_ORD_Q));
+    __m256i big = _mm256_castps_si256(_mm256_cmp_ps(v, _mm256_set1_ps(2147483648.0f), _CMP_GE_OQ));
+    _mm256_storeu_si256((__m256i*)(d + i), _mm256_xor_si256(_mm256_cvttps_epi32(v), big));)
+
+// int -> short: the packing instructions saturate by themselves; AVX2 packs within 128-bit lanes, hence the permute.
+__ARRAY_CONVERT_KERNEL(sse2, , saturate, short, short, int, int, 8,
+    _mm_storeu_si128((__m128i*)(d + i), _mm_packs_epi32(_mm_loadu_si128((const __m128i*)(s + i)), _mm_loadu_si128((const __m128i*)(s + i + 4))));)
+__ARRAY_CONVERT_KERNEL(avx2, __SIMD_AVX2, saturate, short, short, int, int, 16,
+    __m256i packed = _mm256_packs_epi32(_mm256_loadu_si256((const __m256i*)(s + i)), _mm256_loadu_si256((const __m256i*)(s + i + 8)));
+    _mm256_storeu_si256((__m256i*)(d + i), _mm256_permute4x64_epi64(packed, 0xD8));)
+
+__ARRAY_CONVERT_VECTOR(plain, float, float, short, short)
+__ARRAY_CONVERT_VECTOR(plain, float, float, ushort, unsigned short)
+__ARRAY_CONVERT_VECTOR(plain, float, float, uchar, unsigned char)
+__ARRAY_CONVERT_VECTOR(plain, float, float, int, int)
+__ARRAY_CONVERT_VECTOR(plain, double, double, int, int)
+__ARRAY_CONVERT_VECTOR(plain, double, double, float, float)
+__ARRAY_CONVERT_VECTOR(plain, float, float, double, double)
+__ARRAY_CONVERT_VECTOR(saturate, int, int, float, float)
+__ARRAY_CONVERT_VECTOR(saturate, short, short, int, int)
+
+// The pairs above; every other pair probes to "scalar".
+#define __ARRAY_CONVERT_HAS_plain_float_short       ~, vector
+#define __ARRAY_CONVERT_HAS_plain_float_ushort      ~, vector
+#define __ARRAY_CONVERT_HAS_plain_float_uchar       ~, vector
+#define __ARRAY_CONVERT_HAS_plain_float_int         ~, vector
+#define __ARRAY_CONVERT_HAS_plain_double_int        ~, vector
+#define __ARRAY_CONVERT_HAS_plain_double_float      ~, vector
+#define __ARRAY_CONVERT_HAS_plain_float_double      ~, vector
+#define __ARRAY_CONVERT_HAS_saturate_int_float      ~, vector
+#define __ARRAY_CONVERT_HAS_saturate_short_int      ~, vector
+#endif
+
+#define __ARRAY_CONVERT_SECOND(first, second, ...) second
+#define __ARRAY_CONVERT_PROBE(...) __ARRAY_CONVERT_SECOND(__VA_ARGS__, scalar, )
+#define __ARRAY_CONVERT_KIND(MODE, DN, SN) __ARRAY_CONVERT_PROBE(__ARRAY_CONVERT_HAS_##MODE##_##DN##_##SN)
+#define __ARRAY_CONVERT_KERNEL_NAME(MODE, KIND, DN, SN) __ARRAY_CONVERT_KERNEL_NAME_(MODE, KIND, DN, SN)
+#define __ARRAY_CONVERT_KERNEL_NAME_(MODE, KIND, DN, SN) __array_convert_##MODE##_##KIND##_##DN##_##SN
+
+// The entry points every _Generic arm lands on.
+#define __ARRAY_CONVERT_ENTRY(DN, D, DLOW, DHIGH, DC, SN, S, SC) \
+static inline void __array_convert_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    __COUNTER_BEGIN("array_convert", #D " <- " #S) \
+    __ARRAY_CONVERT_KERNEL_NAME(plain, __ARRAY_CONVERT_KIND(plain, DN, SN), DN, SN)(d, s, n); \
+    __COUNTER_END(n * (sizeof(D) + sizeof(S))); \
+} \
+static inline void __array_convert_saturate_##DN##_##SN(D* restrict d, const S* restrict s, size_t n) { \
+    __COUNTER_BEGIN("array_convert_saturate", #D " <- " #S) \
+    __ARRAY_CONVERT_KERNEL_NAME(saturate, __ARRAY_CONVERT_KIND(saturate, DN, SN), DN, SN)(d, s, n); \
+    __COUNTER_END(n * (sizeof(D) + sizeof(S))); \
+}
+#define __ARRAY_CONVERT_ENTRY_ROW(DN, D, DLOW, DHIGH, DC, ...) __ARRAY_CONVERT_SOURCES(__ARRAY_CONVERT_ENTRY, DN, D, DLOW, DHIGH, DC)
+__ARRAY_CONVERT_TYPES(__ARRAY_CONVERT_ENTRY_ROW, )
+
+// _Generic on the destination, then on the source.
+#define __ARRAY_CONVERT_SOURCE_ARM(PREFIX, DN, SN, S, SC) , S*: PREFIX##DN##_##SN, const S*: PREFIX##DN##_##SN
+#define __ARRAY_CONVERT_DESTINATION_ARM(DN, D, DLOW, DHIGH, DC, PREFIX, s) \
+    , D*: _Generic((s) __ARRAY_CONVERT_SOURCES(__ARRAY_CONVERT_SOURCE_ARM, PREFIX, DN))
+#define __array_convert_generic(PREFIX, d, s) _Generic((d) __ARRAY_CONVERT_TYPES(__ARRAY_CONVERT_DESTINATION_ARM, PREFIX, s))
+
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+
+#define __array_convert_n(d, s, n) __array_convert_generic(__array_convert_, d, s)((d), (s), (n))
+#define __array_convert_info(d, s) __array_convert_n(d, s, allocated_info(s).arraysize)
+#define array_convert(...) __array_argc3(__VA_ARGS__, __array_convert_n, __array_convert_info, )(__VA_ARGS__)
+
+#define __array_convert_saturate_n(d, s, n) __array_convert_generic(__array_convert_saturate_, d, s)((d), (s), (n))
+#define __array_convert_saturate_info(d, s) __array_convert_saturate_n(d, s, allocated_info(s).arraysize)
+#define array_convert_saturate(...) __array_argc3(__VA_ARGS__, __array_convert_saturate_n, __array_convert_saturate_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,149 @@
+// Florestan's Array File
+//
+// © dongwanpianist
+//
+// A binary file format for one array of a fundamental type: a 64-byte header, then the raw elements.
+// Loading maps the file read-only and hands out a pointer straight into it, so nothing is parsed or copied,
+// and the pages are read from disk only when they are first touched.
+//
+// 1. array_save(FILE_PATH, POINTER_OR_ARRAY [, COUNT]) -> bool
+//      * COUNT is allocated_info(POINTER_OR_ARRAY).arraysize when omitted
+//      * false when the file cannot be written
+// 2. array_map(FILE_PATH, TYPE) -> const TYPE*
+//      * NULL when the file cannot be mapped, or was not saved as an array of TYPE by a machine with the same byte order
+//      * any other type than the fundamental ones (type_id 0) is only checked by its size
+//      * POSIX only for now; NULL elsewhere
+// 3. array_mapped_count(MAPPED_POINTER) -> size_t
+// 4. array_unmap(MAPPED_POINTER)
+// 5. allocated_info(MAPPED_POINTER) -> allocated_record with method "mapped"
+//      * only when FLORESTAN_TRACKED_ALLOC is defined where array_map() is called
+// 6. array_file_header  (typedef struct __array_file_header)
+//      .magic          (char[8]) "FLORESTA"
+//      .version        (uint32_t) FLORESTAN_ARRAY_FILE_VERSION
+//      .type_id        (uint32_t) type_id() of the element
+//      .typesize       (uint64_t)
+//      .count          (uint64_t)
+//      .endianness     (uint32_t) 0x01020304 as the saving machine stores it
+//      .alignment      (uint32_t) the elements start this many bytes into the file
+//
+// Without FLORESTAN_TRACKED_ALLOC, allocated_info() must not be given a mapped pointer: it would ask the OS allocator
+// about memory that mmap handed out, not malloc. That includes every array_* call that leaves its COUNT out
+// (array_sum(p), array_save(path, p), ...), which reads allocated_info(p).arraysize; give them array_mapped_count(p).
+
+#ifndef FLORESTAN_ARRAY_FILE_H
+#define FLORESTAN_ARRAY_FILE_H
+#include "type_traits.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #define __ARRAY_FILE_MMAP
+#endif
+
+#define FLORESTAN_ARRAY_FILE_VERSION 1
+#ifndef FLORESTAN_ARRAY_FILE_ALIGN
+    #define FLORESTAN_ARRAY_FILE_ALIGN 64 // power of two, at least sizeof(array_file_header)
+#endif
+#define __ARRAY_FILE_MAGIC "FLORESTA"
+#define __ARRAY_FILE_ENDIANNESS 0x01020304u
+
+typedef struct __array_file_header {
+    char magic[8];
+    uint32_t version;
+    uint32_t type_id;
+    uint64_t typesize;
+    uint64_t count;
+    uint32_t endianness;
+    uint32_t alignment;
+    unsigned char reserved[24];
+} array_file_header;
+_Static_assert(sizeof(array_file_header) == 64, "array_file_header must stay 64 bytes");
+
+static inline bool __array_save(const char* path, const void* data, int type_id, size_t typesize, size_t count) {
+    if (typesize && count > SIZE_MAX / typesize) return false;
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) return false;
+    array_file_header header = { .version = FLORESTAN_ARRAY_FILE_VERSION, .type_id = (uint32_t)type_id,
+        .typesize = typesize, .count = count, .endianness = __ARRAY_FILE_ENDIANNESS, .alignment = FLORESTAN_ARRAY_FILE_ALIGN };
+    memcpy(header.magic, __ARRAY_FILE_MAGIC, sizeof header.magic);
+    static const unsigned char padding[FLORESTAN_ARRAY_FILE_ALIGN] = { 0 };
+    bool written = fwrite(&header, sizeof header, 1, file) == 1
+        && fwrite(padding, 1, FLORESTAN_ARRAY_FILE_ALIGN - sizeof header, file) == FLORESTAN_ARRAY_FILE_ALIGN - sizeof header
+        && (count == 0 || fwrite(data, typesize, count, file) == count);
+    if (fclose(file) != 0) written = false;
+    return written;
+}
+
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+#define __array_save_n(path, p, n) __array_save((path), (const void*)(p), type_id(*(p)), sizeof(*(p)), (n))
+#define __array_save_info(path, p) __array_save_n(path, p, allocated_info(p).arraysize)
+#define array_save(...) __array_argc3(__VA_ARGS__, __array_save_n, __array_save_info, )(__VA_ARGS__)
+
+// The header sits right before the elements, in the same mapping.
+static inline const array_file_header* __array_file_header_of(const void* p) {
+    return (const array_file_header*)((const unsigned char*)p - FLORESTAN_ARRAY_FILE_ALIGN);
+}
+
+static inline const void* __array_map(const char* path, int type_id, size_t typesize) {
+#ifdef __ARRAY_FILE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat status;
+    array_file_header header;
+    if (fstat(fd, &status) != 0 || (uint64_t)status.st_size < FLORESTAN_ARRAY_FILE_ALIGN
+        || read(fd, &header, sizeof header) != (ssize_t)sizeof header) {
+        close(fd);
+        return NULL;
+    }
+    uint64_t size = (uint64_t)status.st_size;
+    bool valid = memcmp(header.magic, __ARRAY_FILE_MAGIC, sizeof header.magic) == 0
+        && header.version == FLORESTAN_ARRAY_FILE_VERSION
+        && header.endianness == __ARRAY_FILE_ENDIANNESS
+        && header.alignment == FLORESTAN_ARRAY_FILE_ALIGN
+        && header.type_id == (uint32_t)type_id
+        && header.typesize == typesize
+        && (typesize == 0 || header.count <= (size - FLORESTAN_ARRAY_FILE_ALIGN) / typesize)
+        && size <= SIZE_MAX;
+    if (!valid) {
+        close(fd);
+        return NULL;
+    }
+    // Only the header and the elements are mapped, so array_unmap() can tell the length from the header alone.
+    void* base = mmap(NULL, FLORESTAN_ARRAY_FILE_ALIGN + (size_t)(header.count * typesize), PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return NULL;
+    const unsigned char* data = (const unsigned char*)base + FLORESTAN_ARRAY_FILE_ALIGN;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(data, (size_t)(header.count * typesize), typesize, mapped, NULL);
+#endif
+    return data;
+#else
+    (void)path; (void)type_id; (void)typesize;
+    return NULL;
+#endif
+}
+#define array_map(path, T) ((const T*)__array_map((path), type_id((T){0}), sizeof(T)))
+
+#define array_mapped_count(p) ((size_t)__array_file_header_of(p)->count)
+
+#define array_unmap(p) __array_unmap((const void*)(p))
+static inline void __array_unmap(const void* p) {
+#ifdef __ARRAY_FILE_MMAP
+    if (p == NULL) return;
+    const array_file_header* header = __array_file_header_of(p);
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_remove(p);
+#endif
+    munmap((void*)header, FLORESTAN_ARRAY_FILE_ALIGN + (size_t)(header->count * header->typesize));
+#else
+    (void)p;
+#endif
+}
+
+#endif
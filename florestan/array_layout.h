@@ -0,0 +1,355 @@
+// Florestan's Array Layout
+//
+// © dongwanpianist
+//
+// Between an array of records (rows of STRIDE fields, one after another) and one array per field (columns),
+// and the transpose of a row-major matrix, which is the same move. Everything goes through 8 x 8 tiles
+// that are transposed in registers: AVX2 for 4- and 8-byte elements, SSE2 for 1-, 2-, 4- and 8-byte ones
+// (picked at runtime, see <florestan/simd.h>). Big matrices are walked in blocks of FLORESTAN_LAYOUT_BLOCK x FLORESTAN_LAYOUT_BLOCK
+// elements, so the source rows and destination columns of a block stay in the cache while it is done.
+// Records of fewer than 8 fields still go 8 records at a time, with the tiles reading (or writing) across record boundaries.
+//
+// 1. array_deinterleave(COLUMNS, SOURCE, COUNT, STRIDE)
+//      * COLUMNS[c][i] = SOURCE[i * STRIDE + c] for the COUNT records of SOURCE and each of the STRIDE columns
+// 2. array_interleave(DESTINATION, COLUMNS, COUNT, STRIDE)
+//      * DESTINATION[i * STRIDE + c] = COLUMNS[c][i], the other way around
+// 3. array_transpose(DESTINATION, SOURCE, ROWS, COLS)
+//      * DESTINATION[j * ROWS + i] = SOURCE[i * COLS + j]: SOURCE is ROWS x COLS, DESTINATION becomes COLS x ROWS
+//      * DESTINATION must not overlap SOURCE (nor COLUMNS), in all three
+// 4. array_columns_alloc(TYPE, STRIDE, COUNT) -> TYPE**
+//      * STRIDE columns of COUNT elements each, every one from aligned_array_alloc() of <florestan/aligned_array.h>
+//        on a FLORESTAN_LAYOUT_ALIGN boundary; uninitialized, like malloc; NULL when out of memory
+//      * allocated_info(COLUMNS[c]) -> allocated_record with .arraysize COUNT (exact with FLORESTAN_TRACKED_ALLOC or
+//        FLORESTAN_SIZED_ALLOC, as for aligned arrays), so the array_* functions can leave COUNT out for a column
+// 5. array_columns_free(COLUMNS)
+//      * COLUMNS must come from array_columns_alloc
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double (SOURCE may be const)
+//      * COLUMNS is an array of STRIDE pointers, TYPE** or TYPE* [STRIDE]
+
+#ifndef FLORESTAN_ARRAY_LAYOUT_H
+#define FLORESTAN_ARRAY_LAYOUT_H
+#include "type_traits.h"
+#include "aligned_array.h"
+#include "simd.h"
+#include "counters.h"
+#include <stdint.h>
+#include <string.h>
+
+#ifndef FLORESTAN_LAYOUT_BLOCK
+    #define FLORESTAN_LAYOUT_BLOCK 64 // a multiple of 8
+#endif
+#ifndef FLORESTAN_LAYOUT_ALIGN
+    #define FLORESTAN_LAYOUT_ALIGN 64
+#endif
+
+// A matrix by its rows: at BASE + i * PITCH bytes, or at TABLE[i] when there is a table (the columns of a record array).
+typedef struct __array_rows {
+    unsigned char* base;
+    size_t pitch;
+    void* const* table;
+} __array_rows;
+#define __array_row(m, i) ((m).table ? (unsigned char*)(m).table[i] : (m).base + (i) * (m).pitch)
+
+// A tile kernel reads 8 elements from each of IN[0..7], and writes the first NOUT of the 8 transposed rows to OUT[0..NOUT-1],
+// whole and in order, so that rows closer together than 8 elements overwrite each other's tails as they should.
+typedef void (*__array_tile)(const unsigned char* const* in, unsigned char* const* out, unsigned nout);
+static const unsigned char __array_layout_zero[8 * 8] = { 0 }; // the rows past the last one
+
+#define __ARRAY_TILE_SCALAR(W) \
+static inline void __array_tile_scalar_##W(const unsigned char* const* in, unsigned char* const* out, unsigned nout) { \
+    unsigned char tile[8][8 * W]; \
+    for (unsigned k = 0; k < nout; k++) \
+        for (unsigned r = 0; r < 8; r++) memcpy(tile[k] + r * W, in[r] + k * W, W); \
+    for (unsigned k = 0; k < nout; k++) memcpy(out[k], tile[k], 8 * W); \
+}
+__ARRAY_TILE_SCALAR(1)
+__ARRAY_TILE_SCALAR(2)
+__ARRAY_TILE_SCALAR(4)
+__ARRAY_TILE_SCALAR(8)
+
+#ifdef FLORESTAN_X86_SIMD
+#define __array_tile_load(p) _mm_loadu_si128((const __m128i*)(p))
+#define __array_tile_store(p, x) _mm_storeu_si128((__m128i*)(p), x)
+
+static inline void __array_tile_sse2_1(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m128i t0 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[0]), _mm_loadl_epi64((const __m128i*)in[1]));
+    __m128i t1 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[2]), _mm_loadl_epi64((const __m128i*)in[3]));
+    __m128i t2 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[4]), _mm_loadl_epi64((const __m128i*)in[5]));
+    __m128i t3 = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)in[6]), _mm_loadl_epi64((const __m128i*)in[7]));
+    __m128i u0 = _mm_unpacklo_epi16(t0, t1), u1 = _mm_unpackhi_epi16(t0, t1);
+    __m128i u2 = _mm_unpacklo_epi16(t2, t3), u3 = _mm_unpackhi_epi16(t2, t3);
+    __m128i v[4] = { _mm_unpacklo_epi32(u0, u2), _mm_unpackhi_epi32(u0, u2), _mm_unpacklo_epi32(u1, u3), _mm_unpackhi_epi32(u1, u3) };
+    for (unsigned k = 0; k < nout; k++) _mm_storel_epi64((__m128i*)out[k], k & 1 ? _mm_srli_si128(v[k / 2], 8) : v[k / 2]);
+}
+
+static inline void __array_tile_sse2_2(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m128i r[8];
+    for (unsigned i = 0; i < 8; i++) r[i] = __array_tile_load(in[i]);
+    __m128i t0 = _mm_unpacklo_epi16(r[0], r[1]), t1 = _mm_unpacklo_epi16(r[2], r[3]);
+    __m128i t2 = _mm_unpacklo_epi16(r[4], r[5]), t3 = _mm_unpacklo_epi16(r[6], r[7]);
+    __m128i t4 = _mm_unpackhi_epi16(r[0], r[1]), t5 = _mm_unpackhi_epi16(r[2], r[3]);
+    __m128i t6 = _mm_unpackhi_epi16(r[4], r[5]), t7 = _mm_unpackhi_epi16(r[6], r[7]);
+    __m128i u0 = _mm_unpacklo_epi32(t0, t1), u1 = _mm_unpackhi_epi32(t0, t1);
+    __m128i u2 = _mm_unpacklo_epi32(t2, t3), u3 = _mm_unpackhi_epi32(t2, t3);
+    __m128i u4 = _mm_unpacklo_epi32(t4, t5), u5 = _mm_unpackhi_epi32(t4, t5);
+    __m128i u6 = _mm_unpacklo_epi32(t6, t7), u7 = _mm_unpackhi_epi32(t6, t7);
+    __m128i v[8] = { _mm_unpacklo_epi64(u0, u2), _mm_unpackhi_epi64(u0, u2), _mm_unpacklo_epi64(u1, u3), _mm_unpackhi_epi64(u1, u3),
+                     _mm_unpacklo_epi64(u4, u6), _mm_unpackhi_epi64(u4, u6), _mm_unpacklo_epi64(u5, u7), _mm_unpackhi_epi64(u5, u7) };
+    for (unsigned k = 0; k < nout; k++) __array_tile_store(out[k], v[k]);
+}
+
+// 4 x 4 of 4 bytes; row k of the result in V[k]. The 8 x 8 tile is four of these.
+static inline void __array_quad_sse2_4(const unsigned char* const* in, size_t offset, __m128i* v) {
+    __m128i r0 = __array_tile_load(in[0] + offset), r1 = __array_tile_load(in[1] + offset);
+    __m128i r2 = __array_tile_load(in[2] + offset), r3 = __array_tile_load(in[3] + offset);
+    __m128i t0 = _mm_unpacklo_epi32(r0, r1), t1 = _mm_unpacklo_epi32(r2, r3);
+    __m128i t2 = _mm_unpackhi_epi32(r0, r1), t3 = _mm_unpackhi_epi32(r2, r3);
+    v[0] = _mm_unpacklo_epi64(t0, t1);
+    v[1] = _mm_unpackhi_epi64(t0, t1);
+    v[2] = _mm_unpacklo_epi64(t2, t3);
+    v[3] = _mm_unpackhi_epi64(t2, t3);
+}
+static inline void __array_tile_sse2_4(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m128i top[8], bottom[8]; // the result's left halves (from in[0..3]) and right halves (from in[4..7])
+    __array_quad_sse2_4(in, 0, top);
+    __array_quad_sse2_4(in, 16, top + 4);
+    __array_quad_sse2_4(in + 4, 0, bottom);
+    __array_quad_sse2_4(in + 4, 16, bottom + 4);
+    for (unsigned k = 0; k < nout; k++) {
+        __array_tile_store(out[k], top[k]);
+        __array_tile_store(out[k] + 16, bottom[k]);
+    }
+}
+
+static inline void __array_tile_sse2_8(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m128i v[8][4]; // v[k][h]: elements 2h and 2h + 1 of the result's row k
+    for (unsigned h = 0; h < 4; h++) {
+        for (unsigned c = 0; c < 4; c++) {
+            __m128i a = __array_tile_load(in[2 * h] + 16 * c), b = __array_tile_load(in[2 * h + 1] + 16 * c);
+            v[2 * c][h] = _mm_unpacklo_epi64(a, b);
+            v[2 * c + 1][h] = _mm_unpackhi_epi64(a, b);
+        }
+    }
+    for (unsigned k = 0; k < nout; k++)
+        for (unsigned h = 0; h < 4; h++) __array_tile_store(out[k] + 16 * h, v[k][h]);
+}
+
+__SIMD_AVX2 static inline void __array_tile_avx2_4(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m256i r[8];
+    for (unsigned i = 0; i < 8; i++) r[i] = _mm256_loadu_si256((const __m256i*)in[i]);
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]), t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]), t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]), t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]), t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2), u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3), u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6), u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7), u7 = _mm256_unpackhi_epi64(t5, t7);
+    __m256i v[8] = { _mm256_permute2x128_si256(u0, u4, 0x20), _mm256_permute2x128_si256(u1, u5, 0x20),
+                     _mm256_permute2x128_si256(u2, u6, 0x20), _mm256_permute2x128_si256(u3, u7, 0x20),
+                     _mm256_permute2x128_si256(u0, u4, 0x31), _mm256_permute2x128_si256(u1, u5, 0x31),
+                     _mm256_permute2x128_si256(u2, u6, 0x31), _mm256_permute2x128_si256(u3, u7, 0x31) };
+    for (unsigned k = 0; k < nout; k++) _mm256_storeu_si256((__m256i*)out[k], v[k]);
+}
+
+// 4 x 4 of 8 bytes, four times: v[k][h] is the half h (from in[4h..4h+3]) of the result's row k.
+__SIMD_AVX2 static inline void __array_tile_avx2_8(const unsigned char* const* in, unsigned char* const* out, unsigned nout) {
+    __m256i v[8][2];
+    for (unsigned h = 0; h < 2; h++) {
+        for (unsigned c = 0; c < 2; c++) {
+            __m256i r0 = _mm256_loadu_si256((const __m256i*)(in[4 * h] + 32 * c)), r1 = _mm256_loadu_si256((const __m256i*)(in[4 * h + 1] + 32 * c));
+            __m256i r2 = _mm256_loadu_si256((const __m256i*)(in[4 * h + 2] + 32 * c)), r3 = _mm256_loadu_si256((const __m256i*)(in[4 * h + 3] + 32 * c));
+            __m256i t0 = _mm256_unpacklo_epi64(r0, r1), t1 = _mm256_unpackhi_epi64(r0, r1);
+            __m256i t2 = _mm256_unpacklo_epi64(r2, r3), t3 = _mm256_unpackhi_epi64(r2, r3);
+            v[4 * c][h] = _mm256_permute2x128_si256(t0, t2, 0x20);
+            v[4 * c + 1][h] = _mm256_permute2x128_si256(t1, t3, 0x20);
+            v[4 * c + 2][h] = _mm256_permute2x128_si256(t0, t2, 0x31);
+            v[4 * c + 3][h] = _mm256_permute2x128_si256(t1, t3, 0x31);
+        }
+    }
+    for (unsigned k = 0; k < nout; k++) {
+        _mm256_storeu_si256((__m256i*)out[k], v[k][0]);
+        _mm256_storeu_si256((__m256i*)(out[k] + 32), v[k][1]);
+    }
+}
+#define __ARRAY_TILE_PICK_1 __array_tile_sse2_1
+#define __ARRAY_TILE_PICK_2 __array_tile_sse2_2
+#define __ARRAY_TILE_PICK_4 (__simd_has_avx2() ? __array_tile_avx2_4 : __array_tile_sse2_4)
+#define __ARRAY_TILE_PICK_8 (__simd_has_avx2() ? __array_tile_avx2_8 : __array_tile_sse2_8)
+#else
+#define __ARRAY_TILE_PICK_1 __array_tile_scalar_1
+#define __ARRAY_TILE_PICK_2 __array_tile_scalar_2
+#define __ARRAY_TILE_PICK_4 __array_tile_scalar_4
+#define __ARRAY_TILE_PICK_8 __array_tile_scalar_8
+#endif
+
+// OUT[j][i] = IN[i][j] for i < ROWS and j < COLS, element by element, over [I0, I1) x [J0, J1).
+static inline void __array_transpose_scalar(__array_rows out, __array_rows in, size_t i0, size_t i1, size_t j0, size_t j1, size_t w) {
+    for (size_t i = i0; i < i1; i++) {
+        const unsigned char* row = __array_row(in, i);
+        for (size_t j = j0; j < j1; j++) memcpy(__array_row(out, j) + i * w, row + j * w, w);
+    }
+}
+
+// A record array with fewer than 8 fields is one long row of ROWS * COLS elements; 8 records are a tile all the same,
+// as long as its last read (or write) of 8 elements stays within the array. Pairs are left to the compiler,
+// which vectorizes the plain loop better than a tile of which 3/4 is thrown away.
+// Past the last multiple of 8, the tiles of a big matrix overlap the ones before, writing some elements twice.
+#define __ARRAY_TRANSPOSE_WIDTH(W, U) \
+static inline void __array_transpose_scalar_##W(__array_rows out, __array_rows in, size_t i0, size_t i1, size_t j0, size_t j1) { \
+    __array_transpose_scalar(out, in, i0, i1, j0, j1, W); \
+} \
+static inline void __array_split_pairs_##W(U* restrict a, U* restrict b, const U* restrict source, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        a[i] = source[2 * i]; \
+        b[i] = source[2 * i + 1]; \
+    } \
+} \
+static inline void __array_merge_pairs_##W(U* restrict destination, const U* restrict a, const U* restrict b, size_t n) { \
+    for (size_t i = 0; i < n; i++) { \
+        destination[2 * i] = a[i]; \
+        destination[2 * i + 1] = b[i]; \
+    } \
+} \
+static inline void __array_transpose_##W(__array_rows out, __array_rows in, size_t rows, size_t cols) { \
+    __array_tile tile = __ARRAY_TILE_PICK_##W; \
+    const unsigned char* ip[8]; \
+    unsigned char* op[8]; \
+    if (cols == 2 && in.table == NULL && in.pitch == 2 * W) { \
+        __array_split_pairs_##W((U*)(void*)__array_row(out, 0), (U*)(void*)__array_row(out, 1), (const U*)(void*)in.base, rows); \
+        return; \
+    } \
+    if (rows == 2 && out.table == NULL && out.pitch == 2 * W) { \
+        __array_merge_pairs_##W((U*)(void*)out.base, (const U*)(void*)__array_row(in, 0), (const U*)(void*)__array_row(in, 1), cols); \
+        return; \
+    } \
+    if (cols < 8 && in.table == NULL) { \
+        size_t i = 0; \
+        for (; i + 8 <= rows && (i + 7) * cols + 8 <= rows * cols; i += 8) { \
+            for (unsigned r = 0; r < 8; r++) ip[r] = in.base + (i + r) * in.pitch; \
+            for (unsigned k = 0; k < cols; k++) op[k] = __array_row(out, k) + i * W; \
+            tile(ip, op, (unsigned)cols); \
+        } \
+        __array_transpose_scalar_##W(out, in, i, rows, 0, cols); \
+        return; \
+    } \
+    if (rows < 8 && out.table == NULL) { \
+        size_t j = 0; \
+        for (unsigned r = 0; r < 8; r++) ip[r] = __array_layout_zero; \
+        for (; j + 8 <= cols && (j + 7) * rows + 8 <= rows * cols; j += 8) { \
+            for (unsigned r = 0; r < rows; r++) ip[r] = __array_row(in, r) + j * W; \
+            for (unsigned k = 0; k < 8; k++) op[k] = out.base + (j + k) * out.pitch; \
+            tile(ip, op, 8); \
+        } \
+        __array_transpose_scalar_##W(out, in, 0, rows, j, cols); \
+        return; \
+    } \
+    if (rows < 8 || cols < 8) { \
+        __array_transpose_scalar_##W(out, in, 0, rows, 0, cols); \
+        return; \
+    } \
+    for (size_t bi = 0; bi < rows; bi += FLORESTAN_LAYOUT_BLOCK) { \
+        size_t bi1 = bi + FLORESTAN_LAYOUT_BLOCK < rows ? bi + FLORESTAN_LAYOUT_BLOCK : rows; \
+        for (size_t bj = 0; bj < cols; bj += FLORESTAN_LAYOUT_BLOCK) { \
+            size_t bj1 = bj + FLORESTAN_LAYOUT_BLOCK < cols ? bj + FLORESTAN_LAYOUT_BLOCK : cols; \
+            for (size_t ii = bi; ii < bi1; ii += 8) { \
+                size_t i = ii + 8 <= rows ? ii : rows - 8; \
+                for (unsigned r = 0; r < 8; r++) ip[r] = __array_row(in, i + r); \
+                for (size_t jj = bj; jj < bj1; jj += 8) { \
+                    size_t j = jj + 8 <= cols ? jj : cols - 8; \
+                    const unsigned char* tp[8]; \
+                    for (unsigned r = 0; r < 8; r++) tp[r] = ip[r] + j * W; \
+                    for (unsigned k = 0; k < 8; k++) op[k] = __array_row(out, j + k) + i * W; \
+                    tile(tp, op, 8); \
+                } \
+            } \
+        } \
+    } \
+}
+__ARRAY_TRANSPOSE_WIDTH(1, uint8_t)
+__ARRAY_TRANSPOSE_WIDTH(2, uint16_t)
+__ARRAY_TRANSPOSE_WIDTH(4, uint32_t)
+__ARRAY_TRANSPOSE_WIDTH(8, uint64_t)
+
+static inline void __array_transpose_rows(__array_rows out, __array_rows in, size_t rows, size_t cols, size_t w) {
+    switch (w) {
+        case 1: __array_transpose_1(out, in, rows, cols); break;
+        case 2: __array_transpose_2(out, in, rows, cols); break;
+        case 4: __array_transpose_4(out, in, rows, cols); break;
+        case 8: __array_transpose_8(out, in, rows, cols); break;
+        default: __array_transpose_scalar(out, in, 0, rows, 0, cols, w); break; // long double
+    }
+}
+#define __array_rows_pitched(p, pitch) ((__array_rows){ (unsigned char*)(p), (pitch), NULL })
+#define __array_rows_table(columns) ((__array_rows){ NULL, 0, (void* const*)(columns) })
+
+#define __ARRAY_LAYOUT_TYPES(X, ...) \
+    X(char,    char,               __VA_ARGS__) \
+    X(schar,   signed char,        __VA_ARGS__) \
+    X(uchar,   unsigned char,      __VA_ARGS__) \
+    X(short,   short,              __VA_ARGS__) \
+    X(ushort,  unsigned short,     __VA_ARGS__) \
+    X(int,     int,                __VA_ARGS__) \
+    X(uint,    unsigned int,       __VA_ARGS__) \
+    X(long,    long,               __VA_ARGS__) \
+    X(ulong,   unsigned long,      __VA_ARGS__) \
+    X(llong,   long long,          __VA_ARGS__) \
+    X(ullong,  unsigned long long, __VA_ARGS__) \
+    X(float,   float,              __VA_ARGS__) \
+    X(double,  double,             __VA_ARGS__) \
+    X(ldouble, long double,        __VA_ARGS__)
+
+#define __ARRAY_LAYOUT_ENTRY(NAME, T, ...) \
+static inline void __array_deinterleave_##NAME(T* const* columns, const T* source, size_t n, size_t stride) { \
+    __COUNTER_BEGIN("array_deinterleave", #T) \
+    __array_transpose_rows(__array_rows_table(columns), __array_rows_pitched(source, stride * sizeof(T)), n, stride, sizeof(T)); \
+    __COUNTER_END(2 * n * stride * sizeof(T)); \
+} \
+static inline void __array_interleave_##NAME(T* destination, T* const* columns, size_t n, size_t stride) { \
+    __COUNTER_BEGIN("array_interleave", #T) \
+    __array_transpose_rows(__array_rows_pitched(destination, stride * sizeof(T)), __array_rows_table(columns), stride, n, sizeof(T)); \
+    __COUNTER_END(2 * n * stride * sizeof(T)); \
+} \
+static inline void __array_transpose_##NAME(T* destination, const T* source, size_t rows, size_t cols) { \
+    __COUNTER_BEGIN("array_transpose", #T) \
+    __array_transpose_rows(__array_rows_pitched(destination, rows * sizeof(T)), __array_rows_pitched(source, cols * sizeof(T)), rows, cols, sizeof(T)); \
+    __COUNTER_END(2 * rows * cols * sizeof(T)); \
+}
+__ARRAY_LAYOUT_TYPES(__ARRAY_LAYOUT_ENTRY, )
+
+#define __ARRAY_LAYOUT_ARM(NAME, T, OP) T*: __array_##OP##_##NAME,
+#define __ARRAY_LAYOUT_CONST_ARM(NAME, T, OP) T*: __array_##OP##_##NAME, const T*: __array_##OP##_##NAME,
+#define __array_layout_generic(OP, p) _Generic((p), __ARRAY_LAYOUT_TYPES(__ARRAY_LAYOUT_ARM, OP) default: NULL)
+#define __array_layout_const_generic(OP, p) _Generic((p), __ARRAY_LAYOUT_TYPES(__ARRAY_LAYOUT_CONST_ARM, OP) default: NULL)
+
+#define array_deinterleave(columns, source, n, stride) __array_layout_const_generic(deinterleave, source)((columns), (source), (n), (stride))
+#define array_interleave(destination, columns, n, stride) __array_layout_generic(interleave, destination)((destination), (columns), (n), (stride))
+#define array_transpose(destination, source, rows, cols) __array_layout_generic(transpose, destination)((destination), (source), (rows), (cols))
+
+// The table has a NULL after the last column, so array_columns_free() finds its end.
+static inline void** __array_columns_alloc(size_t stride, size_t n, size_t typesize, int type_id, const char* site) {
+    if (stride > SIZE_MAX / sizeof(void*) - 1) return NULL;
+    void** columns = malloc((stride + 1) * sizeof(void*));
+    if (columns == NULL) return NULL;
+    for (size_t c = 0; c < stride; c++) {
+        columns[c] = __aligned_array_alloc(n, typesize, FLORESTAN_LAYOUT_ALIGN, type_id, false, site);
+        if (columns[c] == NULL) {
+            while (c-- > 0) __aligned_array_free(columns[c]);
+            free(columns);
+            return NULL;
+        }
+    }
+    columns[stride] = NULL;
+    return columns;
+}
+#define array_columns_alloc(T, stride, n) ((T**)__array_columns_alloc((stride), (n), sizeof(T), type_id((T){0}), FLORESTAN_CALL_SITE))
+
+static inline void __array_columns_free(void** columns) {
+    if (columns == NULL) return;
+    for (void** c = columns; *c; c++) __aligned_array_free(*c);
+    free(columns);
+}
+#define array_columns_free(columns) __array_columns_free((void**)(columns))
+
+#endif
@@ -0,0 +1,422 @@
+// Florestan's Array Reduce
+//
+// © dongwanpianist
+//
+// Type-generic reductions over arrays of fundamental types, chosen by _Generic like the __is_* macros.
+// float, double, int and unsigned long long have SSE2 and AVX2 kernels (picked at runtime, see <florestan/simd.h>),
+// and every other type runs a 4-way unrolled loop that compilers vectorize on their own.
+// The vector kernels start at the array's first 16- or 32-byte boundary, which is its very first element
+// when it comes from aligned_array_alloc() of <florestan/aligned_array.h>.
+//
+// 1. array_sum(POINTER_OR_ARRAY [, COUNT])
+//      * signed integers -> long long, unsigned integers -> unsigned long long (both wrap around),
+//        float -> float, double -> double, long double -> long double
+// 2. array_min(POINTER_OR_ARRAY [, COUNT]) -> element type
+// 3. array_max(POINTER_OR_ARRAY [, COUNT]) -> element type
+//      * an empty array gives the largest value for min, and the smallest for max (infinity for floats)
+// 4. array_minmax(POINTER_OR_ARRAY, [COUNT,] MIN_POINTER, MAX_POINTER)
+//      * one pass for both
+// 5. array_dot(POINTER_OR_ARRAY, POINTER_OR_ARRAY [, COUNT]) -> same type as array_sum
+//      * COUNT is allocated_info(first argument).arraysize when omitted,
+//        so leave it out only for fixed arrays and blocks allocated_info() can measure
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double (and their const)
+//      * the vector kernels add floats in a different order than a plain loop, and the NaN result of min/max is unspecified
+
+#ifndef FLORESTAN_ARRAY_REDUCE_H
+#define FLORESTAN_ARRAY_REDUCE_H
+#include "type_traits.h"
+#include "simd.h"
+#include "counters.h"
+#include <limits.h>
+#include <math.h>
+
+// NAME, TYPE, RESULT TYPE, ACCUMULATOR TYPE, LOWEST, HIGHEST
+#define __ARRAY_REDUCE_TYPES(X) \
+    X(char,    char,               long long,          unsigned long long, CHAR_MIN,   CHAR_MAX) \
+    X(schar,   signed char,        long long,          unsigned long long, SCHAR_MIN,  SCHAR_MAX) \
+    X(uchar,   unsigned char,      unsigned long long, unsigned long long, 0,          UCHAR_MAX) \
+    X(short,   short,              long long,          unsigned long long, SHRT_MIN,   SHRT_MAX) \
+    X(ushort,  unsigned short,     unsigned long long, unsigned long long, 0,          USHRT_MAX) \
+    X(int,     int,                long long,          unsigned long long, INT_MIN,    INT_MAX) \
+    X(uint,    unsigned int,       unsigned long long, unsigned long long, 0,          UINT_MAX) \
+    X(long,    long,               long long,          unsigned long long, LONG_MIN,   LONG_MAX) \
+    X(ulong,   unsigned long,      unsigned long long, unsigned long long, 0,          ULONG_MAX) \
+    X(llong,   long long,          long long,          unsigned long long, LLONG_MIN,  LLONG_MAX) \
+    X(ullong,  unsigned long long, unsigned long long, unsigned long long, 0,          ULLONG_MAX) \
+    X(float,   float,              float,              float,              -INFINITY,  INFINITY) \
+    X(double,  double,             double,             double,             -INFINITY,  INFINITY) \
+    X(ldouble, long double,        long double,        long double,        -HUGE_VALL, HUGE_VALL)
+
+// Portable kernels: four independent accumulators, so the adds do not wait on each other.
+#define __ARRAY_REDUCE_SCALAR(NAME, T, S, A, LOWEST, HIGHEST) \
+static inline S __array_sum_scalar_##NAME(const T* p, size_t n) { \
+    A s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { s0 += (A)p[i]; s1 += (A)p[i + 1]; s2 += (A)p[i + 2]; s3 += (A)p[i + 3]; } \
+    for (; i < n; i++) s0 += (A)p[i]; \
+    return (S)((s0 + s1) + (s2 + s3)); \
+} \
+static inline S __array_dot_scalar_##NAME(const T* a, const T* b, size_t n) { \
+    A s0 = 0, s1 = 0, s2 = 0, s3 = 0; \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) { \
+        s0 += (A)a[i] * (A)b[i];         s1 += (A)a[i + 1] * (A)b[i + 1]; \
+        s2 += (A)a[i + 2] * (A)b[i + 2]; s3 += (A)a[i + 3] * (A)b[i + 3]; \
+    } \
+    for (; i < n; i++) s0 += (A)a[i] * (A)b[i]; \
+    return (S)((s0 + s1) + (s2 + s3)); \
+} \
+static inline T __array_min_scalar_##NAME(const T* p, size_t n) { \
+    T m = HIGHEST; \
+    for (size_t i = 0; i < n; i++) m = p[i] < m ? p[i] : m; \
+    return m; \
+} \
+static inline T __array_max_scalar_##NAME(const T* p, size_t n) { \
+    T m = LOWEST; \
+    for (size_t i = 0; i < n; i++) m = p[i] > m ? p[i] : m; \
+    return m; \
+} \
+static inline void __array_minmax_scalar_##NAME(const T* p, size_t n, T* min, T* max) { \
+    T lo = HIGHEST, hi = LOWEST; \
+    for (size_t i = 0; i < n; i++) { lo = p[i] < lo ? p[i] : lo; hi = p[i] > hi ? p[i] : hi; } \
+    *min = lo; *max = hi; \
+}
+__ARRAY_REDUCE_TYPES(__ARRAY_REDUCE_SCALAR)
+
+#ifdef FLORESTAN_X86_SIMD
+// float and double: the same kernel shape for both widths, W lanes per vector and 4 vectors per iteration.
+#define __ARRAY_REDUCE_FLOATING(ISA, ATTR, NAME, T, V, W, LOAD, STORE, SET1, ADD, MUL, MIN, MAX, HIGHEST) \
+ATTR static inline T __array_sum_##ISA##_##NAME(const T* p, size_t n) { \
+    V a0 = SET1(0), a1 = a0, a2 = a0, a3 = a0; \
+    size_t i = 0; \
+    for (; i + 4 * W <= n; i += 4 * W) { \
+        a0 = ADD(a0, LOAD(p + i));         a1 = ADD(a1, LOAD(p + i + W)); \
+        a2 = ADD(a2, LOAD(p + i + 2 * W)); a3 = ADD(a3, LOAD(p + i + 3 * W)); \
+    } \
+    for (; i + W <= n; i += W) a0 = ADD(a0, LOAD(p + i)); \
+    T lanes[W], s = 0; \
+    STORE(lanes, ADD(ADD(a0, a1), ADD(a2, a3))); \
+    for (size_t k = 0; k < W; k++) s += lanes[k]; \
+    for (; i < n; i++) s += p[i]; \
+    return s; \
+} \
+ATTR static inline T __array_dot_##ISA##_##NAME(const T* a, const T* b, size_t n) { \
+    V a0 = SET1(0), a1 = a0, a2 = a0, a3 = a0; \
+    size_t i = 0; \
+    for (; i + 4 * W <= n; i += 4 * W) { \
+        a0 = ADD(a0, MUL(LOAD(a + i), LOAD(b + i))); \
+        a1 = ADD(a1, MUL(LOAD(a + i + W), LOAD(b + i + W))); \
+        a2 = ADD(a2, MUL(LOAD(a + i + 2 * W), LOAD(b + i + 2 * W))); \
+        a3 = ADD(a3, MUL(LOAD(a + i + 3 * W), LOAD(b + i + 3 * W))); \
+    } \
+    for (; i + W <= n; i += W) a0 = ADD(a0, MUL(LOAD(a + i), LOAD(b + i))); \
+    T lanes[W], s = 0; \
+    STORE(lanes, ADD(ADD(a0, a1), ADD(a2, a3))); \
+    for (size_t k = 0; k < W; k++) s += lanes[k]; \
+    for (; i < n; i++) s += a[i] * b[i]; \
+    return s; \
+} \
+ATTR static inline void __array_minmax_##ISA##_##NAME(const T* p, size_t n, T* min, T* max) { \
+    V lo0 = SET1(HIGHEST), lo1 = lo0, hi0 = SET1(-HIGHEST), hi1 = hi0; \
+    size_t i = 0; \
+    for (; i + 2 * W <= n; i += 2 * W) { \
+        V x0 = LOAD(p + i), x1 = LOAD(p + i + W); \
+        lo0 = MIN(lo0, x0); lo1 = MIN(lo1, x1); \
+        hi0 = MAX(hi0, x0); hi1 = MAX(hi1, x1); \
+    } \
+    T lows[W], highs[W], lo = HIGHEST, hi = -HIGHEST; \
+    STORE(lows, MIN(lo0, lo1)); \
+    STORE(highs, MAX(hi0, hi1)); \
+    for (size_t k = 0; k < W; k++) { lo = lows[k] < lo ? lows[k] : lo; hi = highs[k] > hi ? highs[k] : hi; } \
+    for (; i < n; i++) { lo = p[i] < lo ? p[i] : lo; hi = p[i] > hi ? p[i] : hi; } \
+    *min = lo; *max = hi; \
+} \
+ATTR static inline T __array_min_##ISA##_##NAME(const T* p, size_t n) { \
+    T min, max; \
+    __array_minmax_##ISA##_##NAME(p, n, &min, &max); \
+    return min; \
+} \
+ATTR static inline T __array_max_##ISA##_##NAME(const T* p, size_t n) { \
+    T min, max; \
+    __array_minmax_##ISA##_##NAME(p, n, &min, &max); \
+    return max; \
+}
+__ARRAY_REDUCE_FLOATING(sse2, , float, float, __m128, 4, _mm_loadu_ps, _mm_storeu_ps, _mm_set1_ps,
+    _mm_add_ps, _mm_mul_ps, _mm_min_ps, _mm_max_ps, INFINITY)
+__ARRAY_REDUCE_FLOATING(sse2, , double, double, __m128d, 2, _mm_loadu_pd, _mm_storeu_pd, _mm_set1_pd,
+    _mm_add_pd, _mm_mul_pd, _mm_min_pd, _mm_max_pd, INFINITY)
+__ARRAY_REDUCE_FLOATING(avx2, __SIMD_AVX2, float, float, __m256, 8, _mm256_loadu_ps, _mm256_storeu_ps, _mm256_set1_ps,
+    _mm256_add_ps, _mm256_mul_ps, _mm256_min_ps, _mm256_max_ps, INFINITY)
+__ARRAY_REDUCE_FLOATING(avx2, __SIMD_AVX2, double, double, __m256d, 4, _mm256_loadu_pd, _mm256_storeu_pd, _mm256_set1_pd,
+    _mm256_add_pd, _mm256_mul_pd, _mm256_min_pd, _mm256_max_pd, INFINITY)
+
+// int: sums widen every lane to 64 bits (sign-extended by unpacking against its own sign mask),
+// so they cannot overflow before the final long long, just like the scalar kernel.
+#define __ARRAY_REDUCE_INT_SUM(ISA, ATTR, V, W, LOAD, STORE, ZERO, SRAI, UNPACKLO, UNPACKHI, ADD64) \
+ATTR static inline long long __array_sum_##ISA##_int(const int* p, size_t n) { \
+    V a0 = ZERO(), a1 = a0; \
+    size_t i = 0; \
+    for (; i + W <= n; i += W) { \
+        V x = LOAD((const V*)(p + i)), sign = SRAI(x, 31); \
+        a0 = ADD64(a0, UNPACKLO(x, sign)); \
+        a1 = ADD64(a1, UNPACKHI(x, sign)); \
+    } \
+    unsigned long long lanes[W / 2], s = 0; \
+    STORE((V*)lanes, ADD64(a0, a1)); \
+    for (size_t k = 0; k < W / 2; k++) s += lanes[k]; \
+    for (; i < n; i++) s += (unsigned long long)p[i]; \
+    return (long long)s; \
+}
+__ARRAY_REDUCE_INT_SUM(sse2, , __m128i, 4, _mm_loadu_si128, _mm_storeu_si128, _mm_setzero_si128,
+    _mm_srai_epi32, _mm_unpacklo_epi32, _mm_unpackhi_epi32, _mm_add_epi64)
+__ARRAY_REDUCE_INT_SUM(avx2, __SIMD_AVX2, __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256,
+    _mm256_srai_epi32, _mm256_unpacklo_epi32, _mm256_unpackhi_epi32, _mm256_add_epi64)
+
+// SSE2 has no pminsd/pmaxsd, so they are built from a compare and a select.
+static inline __m128i __array_sse2_min_epi32(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, b), _mm_andnot_si128(gt, a));
+}
+static inline __m128i __array_sse2_max_epi32(__m128i a, __m128i b) {
+    __m128i gt = _mm_cmpgt_epi32(a, b);
+    return _mm_or_si128(_mm_and_si128(gt, a), _mm_andnot_si128(gt, b));
+}
+#define __ARRAY_REDUCE_INT_MINMAX(ISA, ATTR, V, W, LOAD, STORE, SET1, MIN, MAX) \
+ATTR static inline void __array_minmax_##ISA##_int(const int* p, size_t n, int* min, int* max) { \
+    V lo0 = SET1(INT_MAX), lo1 = lo0, hi0 = SET1(INT_MIN), hi1 = hi0; \
+    size_t i = 0; \
+    for (; i + 2 * W <= n; i += 2 * W) { \
+        V x0 = LOAD((const V*)(p + i)), x1 = LOAD((const V*)(p + i + W)); \
+        lo0 = MIN(lo0, x0); lo1 = MIN(lo1, x1); \
+        hi0 = MAX(hi0, x0); hi1 = MAX(hi1, x1); \
+    } \
+    int lows[W], highs[W], lo = INT_MAX, hi = INT_MIN; \
+    STORE((V*)lows, MIN(lo0, lo1)); \
+    STORE((V*)highs, MAX(hi0, hi1)); \
+    for (size_t k = 0; k < W; k++) { lo = lows[k] < lo ? lows[k] : lo; hi = highs[k] > hi ? highs[k] : hi; } \
+    for (; i < n; i++) { lo = p[i] < lo ? p[i] : lo; hi = p[i] > hi ? p[i] : hi; } \
+    *min = lo; *max = hi; \
+} \
+ATTR static inline int __array_min_##ISA##_int(const int* p, size_t n) { \
+    int min, max; \
+    __array_minmax_##ISA##_int(p, n, &min, &max); \
+    return min; \
+} \
+ATTR static inline int __array_max_##ISA##_int(const int* p, size_t n) { \
+    int min, max; \
+    __array_minmax_##ISA##_int(p, n, &min, &max); \
+    return max; \
+}
+__ARRAY_REDUCE_INT_MINMAX(sse2, , __m128i, 4, _mm_loadu_si128, _mm_storeu_si128, _mm_set1_epi32,
+    __array_sse2_min_epi32, __array_sse2_max_epi32)
+__ARRAY_REDUCE_INT_MINMAX(avx2, __SIMD_AVX2, __m256i, 8, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_set1_epi32,
+    _mm256_min_epi32, _mm256_max_epi32)
+
+// vpmuldq multiplies the even 32-bit lanes into 64-bit products; the odd lanes are shifted down for a second one.
+__SIMD_AVX2 static inline long long __array_dot_avx2_int(const int* a, const int* b, size_t n) {
+    __m256i s0 = _mm256_setzero_si256(), s1 = s0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(a + i)), y = _mm256_loadu_si256((const __m256i*)(b + i));
+        s0 = _mm256_add_epi64(s0, _mm256_mul_epi32(x, y));
+        s1 = _mm256_add_epi64(s1, _mm256_mul_epi32(_mm256_srli_epi64(x, 32), _mm256_srli_epi64(y, 32)));
+    }
+    unsigned long long lanes[4], s = 0;
+    _mm256_storeu_si256((__m256i*)lanes, _mm256_add_epi64(s0, s1));
+    for (size_t k = 0; k < 4; k++) s += lanes[k];
+    for (; i < n; i++) s += (unsigned long long)a[i] * (unsigned long long)b[i];
+    return (long long)s;
+}
+#define __array_dot_sse2_int __array_dot_scalar_int
+
+// unsigned long long: 64-bit adds exist in SSE2, but unsigned 64-bit compares need AVX2 (pcmpgtq after flipping the sign bit).
+#define __ARRAY_REDUCE_ULLONG_SUM(ISA, ATTR, V, W, LOAD, STORE, ZERO, ADD64) \
+ATTR static inline unsigned long long __array_sum_##ISA##_ullong(const unsigned long long* p, size_t n) { \
+    V a0 = ZERO(), a1 = a0, a2 = a0, a3 = a0; \
+    size_t i = 0; \
+    for (; i + 4 * W <= n; i += 4 * W) { \
+        a0 = ADD64(a0, LOAD((const V*)(p + i)));         a1 = ADD64(a1, LOAD((const V*)(p + i + W))); \
+        a2 = ADD64(a2, LOAD((const V*)(p + i + 2 * W))); a3 = ADD64(a3, LOAD((const V*)(p + i + 3 * W))); \
+    } \
+    for (; i + W <= n; i += W) a0 = ADD64(a0, LOAD((const V*)(p + i))); \
+    unsigned long long lanes[W], s = 0; \
+    STORE((V*)lanes, ADD64(ADD64(a0, a1), ADD64(a2, a3))); \
+    for (size_t k = 0; k < W; k++) s += lanes[k]; \
+    for (; i < n; i++) s += p[i]; \
+    return s; \
+}
+__ARRAY_REDUCE_ULLONG_SUM(sse2, , __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, _mm_setzero_si128, _mm_add_epi64)
+__ARRAY_REDUCE_ULLONG_SUM(avx2, __SIMD_AVX2, __m256i, 4, _mm256_loadu_si256, _mm256_storeu_si256, _mm256_setzero_si256, _mm256_add_epi64)
+
+__SIMD_AVX2 static inline void __array_minmax_avx2_ullong(const unsigned long long* p, size_t n, unsigned long long* min, unsigned long long* max) {
+    const __m256i flip = _mm256_set1_epi64x(LLONG_MIN);
+    __m256i lo = _mm256_set1_epi64x(-1), hi = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256i x = _mm256_loadu_si256((const __m256i*)(p + i)), fx = _mm256_xor_si256(x, flip);
+        lo = _mm256_blendv_epi8(lo, x, _mm256_cmpgt_epi64(_mm256_xor_si256(lo, flip), fx));
+        hi = _mm256_blendv_epi8(hi, x, _mm256_cmpgt_epi64(fx, _mm256_xor_si256(hi, flip)));
+    }
+    unsigned long long lows[4], highs[4], l = ULLONG_MAX, h = 0;
+    _mm256_storeu_si256((__m256i*)lows, lo);
+    _mm256_storeu_si256((__m256i*)highs, hi);
+    for (size_t k = 0; k < 4; k++) { l = lows[k] < l ? lows[k] : l; h = highs[k] > h ? highs[k] : h; }
+    for (; i < n; i++) { l = p[i] < l ? p[i] : l; h = p[i] > h ? p[i] : h; }
+    *min = l; *max = h;
+}
+__SIMD_AVX2 static inline unsigned long long __array_min_avx2_ullong(const unsigned long long* p, size_t n) {
+    unsigned long long min, max;
+    __array_minmax_avx2_ullong(p, n, &min, &max);
+    return min;
+}
+__SIMD_AVX2 static inline unsigned long long __array_max_avx2_ullong(const unsigned long long* p, size_t n) {
+    unsigned long long min, max;
+    __array_minmax_avx2_ullong(p, n, &min, &max);
+    return max;
+}
+#define __array_minmax_sse2_ullong __array_minmax_scalar_ullong
+#define __array_min_sse2_ullong __array_min_scalar_ullong
+#define __array_max_sse2_ullong __array_max_scalar_ullong
+#define __array_dot_sse2_ullong __array_dot_scalar_ullong
+#define __array_dot_avx2_ullong __array_dot_scalar_ullong
+
+#define __ARRAY_REDUCE_PICK(OP, NAME) (__simd_has_avx2() ? __array_##OP##_avx2_##NAME : __array_##OP##_sse2_##NAME)
+
+// An array that does not start on a vector boundary (allocated_record's .alignment) takes the portable loop up to the next one,
+// so no vector load straddles two cache lines; one from aligned_array_alloc() goes straight to the vector kernel.
+// The kernels keep their unaligned loads: on an aligned address they cost what the aligned ones do, and b of array_dot
+// may sit on any boundary.
+static inline size_t __array_reduce_head(const void* p, size_t n, size_t typesize) {
+    size_t vector = __simd_has_avx2() ? 32 : 16;
+    size_t alignment = __address_alignment(p);
+    if (alignment >= vector || alignment < typesize) return 0;
+    size_t head = (vector - (size_t)((uintptr_t)p & (vector - 1))) / typesize;
+    return head < n ? head : n;
+}
+#define __ARRAY_REDUCE_ALIGNED(NAME, T, S, A) \
+static inline S __array_sum_aligned_##NAME(const T* p, size_t n) { \
+    size_t head = __array_reduce_head(p, n, sizeof(T)); \
+    return (S)((A)__array_sum_scalar_##NAME(p, head) + (A)__ARRAY_REDUCE_PICK(sum, NAME)(p + head, n - head)); \
+} \
+static inline S __array_dot_aligned_##NAME(const T* a, const T* b, size_t n) { \
+    size_t head = __array_reduce_head(a, n, sizeof(T)); \
+    return (S)((A)__array_dot_scalar_##NAME(a, b, head) + (A)__ARRAY_REDUCE_PICK(dot, NAME)(a + head, b + head, n - head)); \
+} \
+static inline void __array_minmax_aligned_##NAME(const T* p, size_t n, T* min, T* max) { \
+    size_t head = __array_reduce_head(p, n, sizeof(T)); \
+    T lo, hi; \
+    __array_minmax_scalar_##NAME(p, head, min, max); \
+    __ARRAY_REDUCE_PICK(minmax, NAME)(p + head, n - head, &lo, &hi); \
+    *min = lo < *min ? lo : *min; \
+    *max = hi > *max ? hi : *max; \
+} \
+static inline T __array_min_aligned_##NAME(const T* p, size_t n) { \
+    size_t head = __array_reduce_head(p, n, sizeof(T)); \
+    T a = __array_min_scalar_##NAME(p, head), b = __ARRAY_REDUCE_PICK(min, NAME)(p + head, n - head); \
+    return b < a ? b : a; \
+} \
+static inline T __array_max_aligned_##NAME(const T* p, size_t n) { \
+    size_t head = __array_reduce_head(p, n, sizeof(T)); \
+    T a = __array_max_scalar_##NAME(p, head), b = __ARRAY_REDUCE_PICK(max, NAME)(p + head, n - head); \
+    return b > a ? b : a; \
+}
+__ARRAY_REDUCE_ALIGNED(int, int, long long, unsigned long long)
+__ARRAY_REDUCE_ALIGNED(ullong, unsigned long long, unsigned long long, unsigned long long)
+__ARRAY_REDUCE_ALIGNED(float, float, float, float)
+__ARRAY_REDUCE_ALIGNED(double, double, double, double)
+#define __ARRAY_REDUCE_VECTOR_PICK(OP, NAME) __array_##OP##_aligned_##NAME
+#else
+#define __ARRAY_REDUCE_VECTOR_PICK(OP, NAME) __array_##OP##_scalar_##NAME
+#endif
+
+// The entry points every _Generic arm lands on. Types without vector kernels go straight to the portable ones.
+#define __ARRAY_REDUCE_ENTRY(NAME, T, S, A, LOWEST, HIGHEST) \
+static inline S __array_sum_##NAME(const T* p, size_t n) { \
+    __COUNTER_BEGIN("array_sum", #T) \
+    S result = __ARRAY_REDUCE_ENTRY_PICK(sum, NAME)(p, n); \
+    __COUNTER_END(n * sizeof(T)); \
+    return result; \
+} \
+static inline S __array_dot_##NAME(const T* a, const T* b, size_t n) { \
+    __COUNTER_BEGIN("array_dot", #T) \
+    S result = __ARRAY_REDUCE_ENTRY_PICK(dot, NAME)(a, b, n); \
+    __COUNTER_END(2 * n * sizeof(T)); \
+    return result; \
+} \
+static inline T __array_min_##NAME(const T* p, size_t n) { \
+    __COUNTER_BEGIN("array_min", #T) \
+    T result = __ARRAY_REDUCE_ENTRY_PICK(min, NAME)(p, n); \
+    __COUNTER_END(n * sizeof(T)); \
+    return result; \
+} \
+static inline T __array_max_##NAME(const T* p, size_t n) { \
+    __COUNTER_BEGIN("array_max", #T) \
+    T result = __ARRAY_REDUCE_ENTRY_PICK(max, NAME)(p, n); \
+    __COUNTER_END(n * sizeof(T)); \
+    return result; \
+} \
+static inline void __array_minmax_##NAME(const T* p, size_t n, T* min, T* max) { \
+    __COUNTER_BEGIN("array_minmax", #T) \
+    __ARRAY_REDUCE_ENTRY_PICK(minmax, NAME)(p, n, min, max); \
+    __COUNTER_END(n * sizeof(T)); \
+}
+#define __ARRAY_REDUCE_ENTRY_PICK(OP, NAME) __ARRAY_REDUCE_VECTOR_##NAME(OP, NAME)
+#define __ARRAY_REDUCE_SCALAR_PICK(OP, NAME) __array_##OP##_scalar_##NAME
+#define __ARRAY_REDUCE_VECTOR_char    __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_schar   __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_uchar   __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_short   __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_ushort  __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_int     __ARRAY_REDUCE_VECTOR_PICK
+#define __ARRAY_REDUCE_VECTOR_uint    __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_long    __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_ulong   __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_llong   __ARRAY_REDUCE_SCALAR_PICK
+#define __ARRAY_REDUCE_VECTOR_ullong  __ARRAY_REDUCE_VECTOR_PICK
+#define __ARRAY_REDUCE_VECTOR_float   __ARRAY_REDUCE_VECTOR_PICK
+#define __ARRAY_REDUCE_VECTOR_double  __ARRAY_REDUCE_VECTOR_PICK
+#define __ARRAY_REDUCE_VECTOR_ldouble __ARRAY_REDUCE_SCALAR_PICK
+__ARRAY_REDUCE_TYPES(__ARRAY_REDUCE_ENTRY)
+
+#define __array_reduce_generic(OP, p) _Generic((p), \
+    char*: __array_##OP##_char,                         const char*: __array_##OP##_char, \
+    signed char*: __array_##OP##_schar,                 const signed char*: __array_##OP##_schar, \
+    unsigned char*: __array_##OP##_uchar,               const unsigned char*: __array_##OP##_uchar, \
+    short*: __array_##OP##_short,                       const short*: __array_##OP##_short, \
+    unsigned short*: __array_##OP##_ushort,             const unsigned short*: __array_##OP##_ushort, \
+    int*: __array_##OP##_int,                           const int*: __array_##OP##_int, \
+    unsigned int*: __array_##OP##_uint,                 const unsigned int*: __array_##OP##_uint, \
+    long*: __array_##OP##_long,                         const long*: __array_##OP##_long, \
+    unsigned long*: __array_##OP##_ulong,               const unsigned long*: __array_##OP##_ulong, \
+    long long*: __array_##OP##_llong,                   const long long*: __array_##OP##_llong, \
+    unsigned long long*: __array_##OP##_ullong,         const unsigned long long*: __array_##OP##_ullong, \
+    float*: __array_##OP##_float,                       const float*: __array_##OP##_float, \
+    double*: __array_##OP##_double,                     const double*: __array_##OP##_double, \
+    long double*: __array_##OP##_ldouble,               const long double*: __array_##OP##_ldouble )
+
+#define __array_argc2(_1, _2, NAME, ...) NAME
+#define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#define __array_argc4(_1, _2, _3, _4, NAME, ...) NAME
+
+#define __array_sum_n(p, n) __array_reduce_generic(sum, p)((p), (n))
+#define __array_sum_info(p) __array_sum_n(p, allocated_info(p).arraysize)
+#define array_sum(...) __array_argc2(__VA_ARGS__, __array_sum_n, __array_sum_info, )(__VA_ARGS__)
+
+#define __array_min_n(p, n) __array_reduce_generic(min, p)((p), (n))
+#define __array_min_info(p) __array_min_n(p, allocated_info(p).arraysize)
+#define array_min(...) __array_argc2(__VA_ARGS__, __array_min_n, __array_min_info, )(__VA_ARGS__)
+
+#define __array_max_n(p, n) __array_reduce_generic(max, p)((p), (n))
+#define __array_max_info(p) __array_max_n(p, allocated_info(p).arraysize)
+#define array_max(...) __array_argc2(__VA_ARGS__, __array_max_n, __array_max_info, )(__VA_ARGS__)
+
+#define __array_minmax_n(p, n, min, max) __array_reduce_generic(minmax, p)((p), (n), (min), (max))
+#define __array_minmax_info(p, min, max) __array_minmax_n(p, allocated_info(p).arraysize, min, max)
+#define array_minmax(...) __array_argc4(__VA_ARGS__, __array_minmax_n, __array_minmax_info, , )(__VA_ARGS__)
+
+#define __array_dot_n(a, b, n) __array_reduce_generic(dot, a)((a), (b), (n))
+#define __array_dot_info(a, b) __array_dot_n(a, b, allocated_info(a).arraysize)
+#define array_dot(...) __array_argc3(__VA_ARGS__, __array_dot_n, __array_dot_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,662 @@
+// Florestan's Array Scan
+//
+// © dongwanpianist
+//
+// Type-generic passes that write something back for every element, chosen by _Generic like <florestan/array_reduce.h>.
+// The vector kernels are picked at runtime (see <florestan/simd.h>), and every other type runs a portable loop:
+//      * prefix sums of every integer type (long and unsigned long where they are 64 bits), float and double:
+//        SSE2, a log-step scan in each register (16 chars, 8 shorts, 4 ints or floats, 2 long longs or doubles)
+//      * histograms of integers up to 32 bits, float and double: SSE2 turns four (two) values into bin numbers at a time
+//      * partitions of int, unsigned int and float: AVX2, eight elements split by one table-driven permute;
+//        of 64-bit integers and double: four, each moved as a pair of 32-bit lanes by the same permute
+//
+// 1. array_prefix_sum(DESTINATION, SOURCE [, COUNT])
+//      * DESTINATION[i] = SOURCE[0] + ... + SOURCE[i]; DESTINATION may be SOURCE itself
+//      * integers wrap around in their own type instead of overflowing
+// 2. array_histogram(POINTER_OR_ARRAY, COUNT, BINS, LOW, HIGH [, BIN_COUNT]) -> size_t
+//      * splits [LOW, HIGH) into BIN_COUNT bins of equal width and adds the number of elements in each one to
+//        BINS[0 .. BIN_COUNT) (size_t), so several arrays can go into one histogram; zero BINS first for a fresh one
+//      * elements outside [LOW, HIGH), and NaN, are not counted; returns how many were
+//      * BIN_COUNT is allocated_info(BINS).arraysize when omitted
+//      * integers land in their bins exactly; floats by (x - LOW) * (BIN_COUNT / (HIGH - LOW)) in their own type,
+//        or by halves of x, LOW and HIGH when HIGH - LOW overflows, so that -FLT_MAX .. FLT_MAX still has its bins
+// 3. array_partition(POINTER_OR_ARRAY, [COUNT,] PIVOT) -> size_t
+//      * moves the elements less than PIVOT to the front, in no particular order, and returns how many there are
+//      * NaN is never less than anything, so it goes to the back
+//      * COUNT is allocated_info(POINTER_OR_ARRAY).arraysize when omitted,
+//        so leave it out only for fixed arrays and blocks allocated_info() can measure
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double (SOURCE and histograms may be const)
+//      * the vector prefix sums add floats in a different order than a plain loop
+//
+// A histogram counts into four interleaved copies of its bins, and sums them at the end:
+// a run of equal values then increments four different counters in turn, instead of making every increment
+// wait for the store of the previous one (a store-forwarding stall).
+
+#ifndef FLORESTAN_ARRAY_SCAN_H
+#define FLORESTAN_ARRAY_SCAN_H
+#include "type_traits.h"
+#include "simd.h"
+#include "counters.h"
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+#define __ARRAY_HISTOGRAM_BLOCK 256 // bin numbers computed ahead of counting them
+#define __ARRAY_HISTOGRAM_STACK 1024 // up to this many bins, the four copies live on the stack
+
+// NAME, TYPE, WRAPPING TYPE, CLASS
+#define __ARRAY_SCAN_TYPES(X, ...) \
+    X(char,    char,               unsigned char,      integer, __VA_ARGS__) \
+    X(schar,   signed char,        unsigned char,      integer, __VA_ARGS__) \
+    X(uchar,   unsigned char,      unsigned char,      integer, __VA_ARGS__) \
+    X(short,   short,              unsigned short,     integer, __VA_ARGS__) \
+    X(ushort,  unsigned short,     unsigned short,     integer, __VA_ARGS__) \
+    X(int,     int,                unsigned int,       integer, __VA_ARGS__) \
+    X(uint,    unsigned int,       unsigned int,       integer, __VA_ARGS__) \
+    X(long,    long,               unsigned long,      integer, __VA_ARGS__) \
+    X(ulong,   unsigned long,      unsigned long,      integer, __VA_ARGS__) \
+    X(llong,   long long,          unsigned long long, integer, __VA_ARGS__) \
+    X(ullong,  unsigned long long, unsigned long long, integer, __VA_ARGS__) \
+    X(float,   float,              float,              floating, __VA_ARGS__) \
+    X(double,  double,             double,             floating, __VA_ARGS__) \
+    X(ldouble, long double,        long double,        floating, __VA_ARGS__)
+
+// ---- prefix sum
+
+#define __ARRAY_SCAN_PREFIX_SCALAR(NAME, T, U, CLASS, ...) \
+static inline void __array_prefix_sum_scalar_##NAME(T* destination, const T* source, size_t n) { \
+    U s = 0; \
+    for (size_t i = 0; i < n; i++) { \
+        s += (U)source[i]; \
+        destination[i] = (T)s; \
+    } \
+}
+__ARRAY_SCAN_TYPES(__ARRAY_SCAN_PREFIX_SCALAR, )
+
+// ---- histogram
+
+// Integers: the offset from LOW, as an unsigned 64-bit number, picks the bin exactly.
+// Equal power-of-two widths take a shift, other whole widths a division, and the rest offset * bins / range.
+typedef struct __array_bin_integer {
+    uint64_t low;
+    uint64_t range;
+    uint64_t width;
+    unsigned shift;
+    unsigned mode;
+    size_t bins;
+} array_bin_integer;
+
+static inline array_bin_integer __array_bin_integer_setup(uint64_t low, uint64_t high, size_t bins) {
+    array_bin_integer b = { low, high - low, 0, 0, 2, bins };
+    if (b.range % bins == 0) {
+        b.width = b.range / bins;
+        b.mode = 1;
+        if ((b.width & (b.width - 1)) == 0) {
+            while ((1ull << b.shift) < b.width) b.shift++;
+            b.mode = 0;
+        }
+    }
+    return b;
+}
+// The bin of x, or b->bins when x is outside [LOW, HIGH).
+static inline size_t __array_bin_integer_index(const array_bin_integer* b, uint64_t x) {
+    uint64_t offset = x - b->low;
+    if (offset >= b->range) return b->bins;
+    if (b->mode == 0) return (size_t)(offset >> b->shift);
+    if (b->mode == 1) return (size_t)(offset / b->width);
+    if (offset <= UINT64_MAX / b->bins) return (size_t)(offset * b->bins / b->range);
+#if defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    return (size_t)((uint128)offset * b->bins / b->range);
+#else
+    size_t k = (size_t)((long double)offset * b->bins / b->range);
+    return k < b->bins ? k : b->bins - 1;
+#endif
+}
+
+// The four copies of the bins, each with one extra bin at the end for what is not counted.
+typedef struct __array_histogram_state {
+    uint32_t* copies;
+    size_t stride;
+    size_t pending;
+    uint32_t stack[4 * (__ARRAY_HISTOGRAM_STACK + 1)];
+} array_histogram_state;
+
+static inline bool __array_histogram_begin(array_histogram_state* h, size_t bins) {
+    h->stride = bins + 1;
+    h->pending = 0;
+    if (bins <= __ARRAY_HISTOGRAM_STACK) h->copies = h->stack;
+    else if (bins >= UINT32_MAX || (h->copies = malloc(4 * h->stride * sizeof(uint32_t))) == NULL) return false;
+    memset(h->copies, 0, 4 * h->stride * sizeof(uint32_t));
+    return true;
+}
+// Adds the copies into BINS and clears them; returns how many were counted.
+static inline size_t __array_histogram_flush(array_histogram_state* h, size_t* bins) {
+    size_t counted = 0, n = h->stride - 1;
+    uint32_t *c0 = h->copies, *c1 = c0 + h->stride, *c2 = c1 + h->stride, *c3 = c2 + h->stride;
+    for (size_t k = 0; k < n; k++) {
+        size_t sum = (size_t)c0[k] + c1[k] + c2[k] + c3[k];
+        bins[k] += sum;
+        counted += sum;
+    }
+    memset(h->copies, 0, 4 * h->stride * sizeof(uint32_t));
+    h->pending = 0;
+    return counted;
+}
+static inline void __array_histogram_count(array_histogram_state* h, const uint32_t* index, size_t m) {
+    uint32_t *c0 = h->copies, *c1 = c0 + h->stride, *c2 = c1 + h->stride, *c3 = c2 + h->stride;
+    size_t j = 0;
+    for (; j + 4 <= m; j += 4) {
+        c0[index[j]]++;
+        c1[index[j + 1]]++;
+        c2[index[j + 2]]++;
+        c3[index[j + 3]]++;
+    }
+    for (; j < m; j++) c0[index[j]]++;
+    h->pending += m;
+}
+static inline void __array_histogram_end(array_histogram_state* h) {
+    if (h->copies != h->stack) free(h->copies);
+}
+
+// Every type gets the same driver; CLASS decides how a bin is found, and the vector kernels fill a whole block of them.
+#define __ARRAY_SCAN_BIN_SETUP_integer(T) array_bin_integer b = __array_bin_integer_setup((uint64_t)lo, (uint64_t)hi, bin_count);
+#define __ARRAY_SCAN_BIN_INDEX_integer(x) __array_bin_integer_index(&b, (uint64_t)(x))
+#define __array_bin_finite(x) ((x) - (x) == 0)
+// A range wider than the type's largest value would make HIGH - LOW infinite and every bin 0; it is measured in halves
+// instead, which are exact and cannot overflow. Any other range is measured in wholes, with the same result as x - LOW.
+#define __ARRAY_SCAN_BIN_SETUP_floating(T) \
+    T half = (T)(__array_bin_finite(hi - lo) ? 1 : 0.5), base = lo * half, scale = (T)bin_count / (hi * half - base);
+#define __ARRAY_SCAN_BIN_INDEX_floating(x) \
+    ((x) >= lo && (x) < hi ? __array_bin_clamp((size_t)(((x) * half - base) * scale), bin_count) : bin_count)
+static inline size_t __array_bin_clamp(size_t k, size_t bins) { return k < bins ? k : bins - 1; }
+
+#define __ARRAY_SCAN_HISTOGRAM_BLOCK(NAME, T, U, CLASS, ...) \
+static inline void __array_histogram_block_scalar_##NAME(const T* p, size_t m, uint32_t* index, T lo, T hi, size_t bin_count) { \
+    __ARRAY_SCAN_BIN_SETUP_##CLASS(T) \
+    for (size_t j = 0; j < m; j++) index[j] = (uint32_t)__ARRAY_SCAN_BIN_INDEX_##CLASS(p[j]); \
+}
+__ARRAY_SCAN_TYPES(__ARRAY_SCAN_HISTOGRAM_BLOCK, )
+#define __ARRAY_SCAN_HISTOGRAM(NAME, T, U, CLASS, ...) \
+static inline size_t __array_histogram_bins_##NAME(const T* p, size_t n, size_t* bins, T lo, T hi, size_t bin_count) { \
+    if (bin_count == 0 || !(lo < hi)) return 0; \
+    array_histogram_state h; \
+    if (!__array_histogram_begin(&h, bin_count)) { \
+        /* too many bins for 32-bit counters, or no memory for the copies: one counter per bin */ \
+        __ARRAY_SCAN_BIN_SETUP_##CLASS(T) \
+        size_t counted = 0; \
+        for (size_t i = 0; i < n; i++) { \
+            size_t k = __ARRAY_SCAN_BIN_INDEX_##CLASS(p[i]); \
+            if (k < bin_count) { bins[k]++; counted++; } \
+        } \
+        return counted; \
+    } \
+    uint32_t index[__ARRAY_HISTOGRAM_BLOCK]; \
+    size_t counted = 0; \
+    for (size_t i = 0; i < n; i += __ARRAY_HISTOGRAM_BLOCK) { \
+        size_t m = n - i < __ARRAY_HISTOGRAM_BLOCK ? n - i : __ARRAY_HISTOGRAM_BLOCK; \
+        __ARRAY_SCAN_HISTOGRAM_PICK(NAME)(p + i, m, index, lo, hi, bin_count); \
+        /* a 32-bit counter holds any number of blocks below 2^32 elements */ \
+        if (h.pending > UINT32_MAX - __ARRAY_HISTOGRAM_BLOCK) counted += __array_histogram_flush(&h, bins); \
+        __array_histogram_count(&h, index, m); \
+    } \
+    counted += __array_histogram_flush(&h, bins); \
+    __array_histogram_end(&h); \
+    return counted; \
+} \
+static inline size_t __array_histogram_##NAME(const T* p, size_t n, size_t* bins, T lo, T hi, size_t bin_count) { \
+    __COUNTER_BEGIN("array_histogram", #T) \
+    size_t counted = __array_histogram_bins_##NAME(p, n, bins, lo, hi, bin_count); \
+    __COUNTER_END(n * sizeof(T)); \
+    return counted; \
+}
+
+// ---- partition
+
+// Branch-free Lomuto: every element is swapped with the first one not yet known to be less, and the boundary moves only past the less ones.
+#define __ARRAY_SCAN_PARTITION_SCALAR(NAME, T, U, CLASS, ...) \
+static inline size_t __array_partition_scalar_##NAME(T* p, size_t n, T pivot) { \
+    size_t left = 0; \
+    for (size_t i = 0; i < n; i++) { \
+        T x = p[i]; \
+        bool less = x < pivot; \
+        p[i] = p[left]; \
+        p[left] = x; \
+        left += less; \
+    } \
+    return left; \
+}
+__ARRAY_SCAN_TYPES(__ARRAY_SCAN_PARTITION_SCALAR, )
+
+#ifdef FLORESTAN_X86_SIMD
+// The prefix sum inside one register: each lane adds the lanes before it in log2(W) shifted adds,
+// then the carry (the last lane so far) is added to all of them.
+#define __ARRAY_SCAN_PREFIX_SSE2(NAME, T, U, V, W, LOAD, STORE, ADD, SCAN, BROADCAST_LAST) \
+static inline void __array_prefix_sum_sse2_##NAME(T* destination, const T* source, size_t n) { \
+    V carry = _mm_setzero_si128(); \
+    size_t body = n - n % W, i = 0; \
+    for (; i < body; i += W) { \
+        V x = ADD(SCAN(LOAD((const V*)(source + i))), carry); \
+        STORE((V*)(destination + i), x); \
+        carry = BROADCAST_LAST(x); \
+    } \
+    T lanes[W]; \
+    STORE((V*)lanes, carry); \
+    U s = (U)lanes[0]; \
+    for (; i < n; i++) { \
+        s += (U)source[i]; \
+        destination[i] = (T)s; \
+    } \
+}
+static inline __m128i __array_scan_epi8(__m128i x) {
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 1));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 2));
+    x = _mm_add_epi8(x, _mm_slli_si128(x, 4));
+    return _mm_add_epi8(x, _mm_slli_si128(x, 8));
+}
+static inline __m128i __array_scan_epi16(__m128i x) {
+    x = _mm_add_epi16(x, _mm_slli_si128(x, 2));
+    x = _mm_add_epi16(x, _mm_slli_si128(x, 4));
+    return _mm_add_epi16(x, _mm_slli_si128(x, 8));
+}
+static inline __m128i __array_scan_epi32(__m128i x) {
+    x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+    return _mm_add_epi32(x, _mm_slli_si128(x, 8));
+}
+static inline __m128i __array_scan_epi64(__m128i x) { return _mm_add_epi64(x, _mm_slli_si128(x, 8)); }
+// SSE2 has no byte shuffle: the last byte is doubled into a word, that word into a dword, and the dword spread.
+static inline __m128i __array_scan_last_epi8(__m128i x) {
+    x = _mm_unpackhi_epi8(x, x);
+    x = _mm_unpackhi_epi16(x, x);
+    return _mm_shuffle_epi32(x, 0xFF);
+}
+static inline __m128i __array_scan_last_epi16(__m128i x) { return _mm_shuffle_epi32(_mm_shufflehi_epi16(x, 0xFF), 0xFF); }
+static inline __m128i __array_scan_last_epi32(__m128i x) { return _mm_shuffle_epi32(x, 0xFF); }
+static inline __m128i __array_scan_last_epi64(__m128i x) { return _mm_shuffle_epi32(x, 0xEE); }
+// float and double go through the integer registers' byte shifts, bit for bit.
+static inline __m128i __array_scan_ps(__m128i x) {
+    x = _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(_mm_slli_si128(x, 4))));
+    return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(x), _mm_castsi128_ps(_mm_slli_si128(x, 8))));
+}
+static inline __m128i __array_scan_add_ps(__m128i a, __m128i b) { return _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(a), _mm_castsi128_ps(b))); }
+static inline __m128i __array_scan_pd(__m128i x) { return _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(x), _mm_castsi128_pd(_mm_slli_si128(x, 8)))); }
+static inline __m128i __array_scan_add_pd(__m128i a, __m128i b) { return _mm_castpd_si128(_mm_add_pd(_mm_castsi128_pd(a), _mm_castsi128_pd(b))); }
+__ARRAY_SCAN_PREFIX_SSE2(char, char, unsigned char, __m128i, 16, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi8,
+    __array_scan_epi8, __array_scan_last_epi8)
+__ARRAY_SCAN_PREFIX_SSE2(schar, signed char, unsigned char, __m128i, 16, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi8,
+    __array_scan_epi8, __array_scan_last_epi8)
+__ARRAY_SCAN_PREFIX_SSE2(uchar, unsigned char, unsigned char, __m128i, 16, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi8,
+    __array_scan_epi8, __array_scan_last_epi8)
+__ARRAY_SCAN_PREFIX_SSE2(short, short, unsigned short, __m128i, 8, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi16,
+    __array_scan_epi16, __array_scan_last_epi16)
+__ARRAY_SCAN_PREFIX_SSE2(ushort, unsigned short, unsigned short, __m128i, 8, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi16,
+    __array_scan_epi16, __array_scan_last_epi16)
+__ARRAY_SCAN_PREFIX_SSE2(int, int, unsigned int, __m128i, 4, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi32,
+    __array_scan_epi32, __array_scan_last_epi32)
+__ARRAY_SCAN_PREFIX_SSE2(uint, unsigned int, unsigned int, __m128i, 4, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi32,
+    __array_scan_epi32, __array_scan_last_epi32)
+__ARRAY_SCAN_PREFIX_SSE2(llong, long long, unsigned long long, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64,
+    __array_scan_epi64, __array_scan_last_epi64)
+__ARRAY_SCAN_PREFIX_SSE2(ullong, unsigned long long, unsigned long long, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64,
+    __array_scan_epi64, __array_scan_last_epi64)
+#if LONG_MAX == LLONG_MAX
+__ARRAY_SCAN_PREFIX_SSE2(long, long, unsigned long, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64,
+    __array_scan_epi64, __array_scan_last_epi64)
+__ARRAY_SCAN_PREFIX_SSE2(ulong, unsigned long, unsigned long, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, _mm_add_epi64,
+    __array_scan_epi64, __array_scan_last_epi64)
+#endif
+__ARRAY_SCAN_PREFIX_SSE2(float, float, float, __m128i, 4, _mm_loadu_si128, _mm_storeu_si128, __array_scan_add_ps,
+    __array_scan_ps, __array_scan_last_epi32)
+__ARRAY_SCAN_PREFIX_SSE2(double, double, double, __m128i, 2, _mm_loadu_si128, _mm_storeu_si128, __array_scan_add_pd,
+    __array_scan_pd, __array_scan_last_epi64)
+
+// Bin numbers of W floats (doubles) at once, with the same arithmetic as the scalar kernel:
+// in range -> (x - lo) * scale truncated and kept below bin_count, out of range or NaN -> bin_count.
+#define __ARRAY_SCAN_HISTOGRAM_SSE2(NAME, T, V, W, LOAD, SET1, SUB, MUL, CMPGE, CMPLT, CONVERT, STORE_INDEX) \
+static inline void __array_histogram_block_sse2_##NAME(const T* p, size_t m, uint32_t* index, T lo, T hi, size_t bin_count) { \
+    if (bin_count >= (1u << 30) || !__array_bin_finite(hi - lo)) { \
+        __array_histogram_block_scalar_##NAME(p, m, index, lo, hi, bin_count); \
+        return; \
+    } \
+    T scale = (T)bin_count / (hi - lo); \
+    V low = SET1(lo), high = SET1(hi), scale_v = SET1(scale); \
+    __m128i outside = _mm_set1_epi32((int)bin_count), last = _mm_set1_epi32((int)bin_count - 1); \
+    size_t j = 0; \
+    for (; j + W <= m; j += W) { \
+        V x = LOAD(p + j); \
+        __m128i inside = CMPGE(x, low, high); \
+        __m128i k = CONVERT(MUL(SUB(x, low), scale_v)); \
+        __m128i over = _mm_cmpgt_epi32(k, last); \
+        k = _mm_or_si128(_mm_and_si128(over, last), _mm_andnot_si128(over, k)); \
+        k = _mm_or_si128(_mm_and_si128(inside, k), _mm_andnot_si128(inside, outside)); \
+        STORE_INDEX(index + j, k); \
+    } \
+    __array_histogram_block_scalar_##NAME(p + j, m - j, index + j, lo, hi, bin_count); \
+}
+static inline __m128i __array_histogram_inside_ps(__m128 x, __m128 low, __m128 high) {
+    return _mm_castps_si128(_mm_and_ps(_mm_cmpge_ps(x, low), _mm_cmplt_ps(x, high)));
+}
+// Two doubles give two 64-bit masks; their low halves line up with the two 32-bit bin numbers of cvttpd.
+static inline __m128i __array_histogram_inside_pd(__m128d x, __m128d low, __m128d high) {
+    return _mm_shuffle_epi32(_mm_castpd_si128(_mm_and_pd(_mm_cmpge_pd(x, low), _mm_cmplt_pd(x, high))), 0x08);
+}
+static inline void __array_histogram_store4(uint32_t* index, __m128i k) { _mm_storeu_si128((__m128i*)index, k); }
+static inline void __array_histogram_store2(uint32_t* index, __m128i k) { _mm_storel_epi64((__m128i*)index, k); }
+__ARRAY_SCAN_HISTOGRAM_SSE2(float, float, __m128, 4, _mm_loadu_ps, _mm_set1_ps, _mm_sub_ps, _mm_mul_ps,
+    __array_histogram_inside_ps, _mm_cmplt_ps, _mm_cvttps_epi32, __array_histogram_store4)
+__ARRAY_SCAN_HISTOGRAM_SSE2(double, double, __m128d, 2, _mm_loadu_pd, _mm_set1_pd, _mm_sub_pd, _mm_mul_pd,
+    __array_histogram_inside_pd, _mm_cmplt_pd, _mm_cvttpd_epi32, __array_histogram_store2)
+
+// Bin numbers of four integers of up to 32 bits at once, widened to 32-bit lanes, the same as __array_bin_integer_index():
+// both ends fit the type, so the 32-bit offset from LOW is below the range exactly when the 64-bit one is.
+// A power-of-two width is a shift; any other bin is offset * MULTIPLIER / DIVISOR in double, which truncates to the exact
+// quotient while the product stays below 2^53 and the quotient is off an integer by more than its rounding error:
+// always for a whole width (1 / width), and for offset * bins / range while the range is below 2^22. Wider ones stay scalar.
+#define __ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(NAME, T, LOAD4) \
+static inline void __array_histogram_block_sse2_##NAME(const T* p, size_t m, uint32_t* index, T lo, T hi, size_t bin_count) { \
+    array_bin_integer b = __array_bin_integer_setup((uint64_t)lo, (uint64_t)hi, bin_count); \
+    if (bin_count >= (1u << 30) || (b.mode == 2 && b.range >= (1u << 22))) { \
+        __array_histogram_block_scalar_##NAME(p, m, index, lo, hi, bin_count); \
+        return; \
+    } \
+    const __m128i flip = _mm_set1_epi32(INT_MIN), low = _mm_set1_epi32((int)(uint32_t)b.low); \
+    const __m128i range = _mm_set1_epi32((int)((uint32_t)b.range ^ 0x80000000u)), outside = _mm_set1_epi32((int)bin_count); \
+    const __m128i shift = _mm_cvtsi32_si128((int)b.shift); \
+    const __m128d half = _mm_set1_pd(2147483648.0); \
+    const __m128d multiplier = _mm_set1_pd(b.mode == 2 ? (double)b.bins : 1.0); \
+    const __m128d divisor = _mm_set1_pd(b.mode == 2 ? (double)b.range : (double)b.width); \
+    size_t j = 0; \
+    for (; j + 4 <= m; j += 4) { \
+        __m128i offset = _mm_sub_epi32(LOAD4(p + j), low); \
+        __m128i flipped = _mm_xor_si128(offset, flip); \
+        __m128i inside = _mm_cmplt_epi32(flipped, range); \
+        __m128i k; \
+        if (b.mode == 0) { \
+            k = _mm_srl_epi32(offset, shift); \
+        } else { \
+            __m128d k01 = _mm_add_pd(_mm_cvtepi32_pd(flipped), half); \
+            __m128d k23 = _mm_add_pd(_mm_cvtepi32_pd(_mm_shuffle_epi32(flipped, 0x0E)), half); \
+            k01 = _mm_div_pd(_mm_mul_pd(k01, multiplier), divisor); \
+            k23 = _mm_div_pd(_mm_mul_pd(k23, multiplier), divisor); \
+            k = _mm_unpacklo_epi64(_mm_cvttpd_epi32(k01), _mm_cvttpd_epi32(k23)); \
+        } \
+        k = _mm_or_si128(_mm_and_si128(inside, k), _mm_andnot_si128(inside, outside)); \
+        _mm_storeu_si128((__m128i*)(index + j), k); \
+    } \
+    __array_histogram_block_scalar_##NAME(p + j, m - j, index + j, lo, hi, bin_count); \
+}
+// Four elements, sign- or zero-extended to 32-bit lanes.
+static inline __m128i __array_histogram_load_schar(const signed char* p) {
+    int bytes;
+    memcpy(&bytes, p, sizeof bytes);
+    __m128i x = _mm_cvtsi32_si128(bytes);
+    x = _mm_unpacklo_epi8(x, x);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 24);
+}
+static inline __m128i __array_histogram_load_uchar(const unsigned char* p) {
+    int bytes;
+    memcpy(&bytes, p, sizeof bytes);
+    __m128i zero = _mm_setzero_si128();
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(bytes), zero), zero);
+}
+static inline __m128i __array_histogram_load_char(const char* p) {
+    return CHAR_MIN < 0 ? __array_histogram_load_schar((const signed char*)p) : __array_histogram_load_uchar((const unsigned char*)p);
+}
+static inline __m128i __array_histogram_load_short(const short* p) {
+    __m128i x = _mm_loadl_epi64((const __m128i*)p);
+    return _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+}
+static inline __m128i __array_histogram_load_ushort(const unsigned short* p) {
+    return _mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128());
+}
+static inline __m128i __array_histogram_load_int(const int* p) { return _mm_loadu_si128((const __m128i*)p); }
+static inline __m128i __array_histogram_load_uint(const unsigned int* p) { return _mm_loadu_si128((const __m128i*)p); }
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(char, char, __array_histogram_load_char)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(schar, signed char, __array_histogram_load_schar)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(uchar, unsigned char, __array_histogram_load_uchar)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(short, short, __array_histogram_load_short)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(ushort, unsigned short, __array_histogram_load_ushort)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(int, int, __array_histogram_load_int)
+__ARRAY_SCAN_HISTOGRAM_INTEGER_SSE2(uint, unsigned int, __array_histogram_load_uint)
+
+// In-place partition, W lanes at a time (eight 32-bit or four 64-bit ones). The first and the last vector are held in registers,
+// which leaves a vector's worth of free space at both ends. Each step reads the next vector from the end
+// with less free space, so both ends then have at least a vector free, and permutes it so the lanes less than PIVOT come first:
+// the whole vector is stored at the left write position and again ending at the right one,
+// and each position moves past its own part. What is left (the two held vectors and the last few elements)
+// is exactly as big as the gap between the write positions, and fills it one element at a time.
+// ORDER turns the mask of less lanes into the permute: a table row of eight 32-bit lane numbers, widened from bytes.
+static const uint64_t __array_partition_lanes[256] = {
+    0x0706050403020100u, 0x0706050403020100u, 0x0706050403020001u, 0x0706050403020100u,
+    0x0706050403010002u, 0x0706050403010200u, 0x0706050403000201u, 0x0706050403020100u,
+    0x0706050402010003u, 0x0706050402010300u, 0x0706050402000301u, 0x0706050402030100u,
+    0x0706050401000302u, 0x0706050401030200u, 0x0706050400030201u, 0x0706050403020100u,
+    0x0706050302010004u, 0x0706050302010400u, 0x0706050302000401u, 0x0706050302040100u,
+    0x0706050301000402u, 0x0706050301040200u, 0x0706050300040201u, 0x0706050304020100u,
+    0x0706050201000403u, 0x0706050201040300u, 0x0706050200040301u, 0x0706050204030100u,
+    0x0706050100040302u, 0x0706050104030200u, 0x0706050004030201u, 0x0706050403020100u,
+    0x0706040302010005u, 0x0706040302010500u, 0x0706040302000501u, 0x0706040302050100u,
+    0x0706040301000502u, 0x0706040301050200u, 0x0706040300050201u, 0x0706040305020100u,
+    0x0706040201000503u, 0x0706040201050300u, 0x0706040200050301u, 0x0706040205030100u,
+    0x0706040100050302u, 0x0706040105030200u, 0x0706040005030201u, 0x0706040503020100u,
+    0x0706030201000504u, 0x0706030201050400u, 0x0706030200050401u, 0x0706030205040100u,
+    0x0706030100050402u, 0x0706030105040200u, 0x0706030005040201u, 0x0706030504020100u,
+    0x0706020100050403u, 0x0706020105040300u, 0x0706020005040301u, 0x0706020504030100u,
+    0x0706010005040302u, 0x0706010504030200u, 0x0706000504030201u, 0x0706050403020100u,
+    0x0705040302010006u, 0x0705040302010600u, 0x0705040302000601u, 0x0705040302060100u,
+    0x0705040301000602u, 0x0705040301060200u, 0x0705040300060201u, 0x0705040306020100u,
+    0x0705040201000603u, 0x0705040201060300u, 0x0705040200060301u, 0x0705040206030100u,
+    0x0705040100060302u, 0x0705040106030200u, 0x0705040006030201u, 0x0705040603020100u,
+    0x0705030201000604u, 0x0705030201060400u, 0x0705030200060401u, 0x0705030206040100u,
+    0x0705030100060402u, 0x0705030106040200u, 0x0705030006040201u, 0x0705030604020100u,
+    0x0705020100060403u, 0x0705020106040300u, 0x0705020006040301u, 0x0705020604030100u,
+    0x0705010006040302u, 0x0705010604030200u, 0x0705000604030201u, 0x0705060403020100u,
+    0x0704030201000605u, 0x0704030201060500u, 0x0704030200060501u, 0x0704030206050100u,
+    0x0704030100060502u, 0x0704030106050200u, 0x0704030006050201u, 0x0704030605020100u,
+    0x0704020100060503u, 0x0704020106050300u, 0x0704020006050301u, 0x0704020605030100u,
+    0x0704010006050302u, 0x0704010605030200u, 0x0704000605030201u, 0x0704060503020100u,
+    0x0703020100060504u, 0x0703020106050400u, 0x0703020006050401u, 0x0703020605040100u,
+    0x0703010006050402u, 0x0703010605040200u, 0x0703000605040201u, 0x0703060504020100u,
+    0x0702010006050403u, 0x0702010605040300u, 0x0702000605040301u, 0x0702060504030100u,
+    0x0701000605040302u, 0x0701060504030200u, 0x0700060504030201u, 0x0706050403020100u,
+    0x0605040302010007u, 0x0605040302010700u, 0x0605040302000701u, 0x0605040302070100u,
+    0x0605040301000702u, 0x0605040301070200u, 0x0605040300070201u, 0x0605040307020100u,
+    0x0605040201000703u, 0x0605040201070300u, 0x0605040200070301u, 0x0605040207030100u,
+    0x0605040100070302u, 0x0605040107030200u, 0x0605040007030201u, 0x0605040703020100u,
+    0x0605030201000704u, 0x0605030201070400u, 0x0605030200070401u, 0x0605030207040100u,
+    0x0605030100070402u, 0x0605030107040200u, 0x0605030007040201u, 0x0605030704020100u,
+    0x0605020100070403u, 0x0605020107040300u, 0x0605020007040301u, 0x0605020704030100u,
+    0x0605010007040302u, 0x0605010704030200u, 0x0605000704030201u, 0x0605070403020100u,
+    0x0604030201000705u, 0x0604030201070500u, 0x0604030200070501u, 0x0604030207050100u,
+    0x0604030100070502u, 0x0604030107050200u, 0x0604030007050201u, 0x0604030705020100u,
+    0x0604020100070503u, 0x0604020107050300u, 0x0604020007050301u, 0x0604020705030100u,
+    0x0604010007050302u, 0x0604010705030200u, 0x0604000705030201u, 0x0604070503020100u,
+    0x0603020100070504u, 0x0603020107050400u, 0x0603020007050401u, 0x0603020705040100u,
+    0x0603010007050402u, 0x0603010705040200u, 0x0603000705040201u, 0x0603070504020100u,
+    0x0602010007050403u, 0x0602010705040300u, 0x0602000705040301u, 0x0602070504030100u,
+    0x0601000705040302u, 0x0601070504030200u, 0x0600070504030201u, 0x0607050403020100u,
+    0x0504030201000706u, 0x0504030201070600u, 0x0504030200070601u, 0x0504030207060100u,
+    0x0504030100070602u, 0x0504030107060200u, 0x0504030007060201u, 0x0504030706020100u,
+    0x0504020100070603u, 0x0504020107060300u, 0x0504020007060301u, 0x0504020706030100u,
+    0x0504010007060302u, 0x0504010706030200u, 0x0504000706030201u, 0x0504070603020100u,
+    0x0503020100070604u, 0x0503020107060400u, 0x0503020007060401u, 0x0503020706040100u,
+    0x0503010007060402u, 0x0503010706040200u, 0x0503000706040201u, 0x0503070604020100u,
+    0x0502010007060403u, 0x0502010706040300u, 0x0502000706040301u, 0x0502070604030100u,
+    0x0501000706040302u, 0x0501070604030200u, 0x0500070604030201u, 0x0507060403020100u,
+    0x0403020100070605u, 0x0403020107060500u, 0x0403020007060501u, 0x0403020706050100u,
+    0x0403010007060502u, 0x0403010706050200u, 0x0403000706050201u, 0x0403070605020100u,
+    0x0402010007060503u, 0x0402010706050300u, 0x0402000706050301u, 0x0402070605030100u,
+    0x0401000706050302u, 0x0401070605030200u, 0x0400070605030201u, 0x0407060503020100u,
+    0x0302010007060504u, 0x0302010706050400u, 0x0302000706050401u, 0x0302070605040100u,
+    0x0301000706050402u, 0x0301070605040200u, 0x0300070605040201u, 0x0307060504020100u,
+    0x0201000706050403u, 0x0201070605040300u, 0x0200070605040301u, 0x0207060504030100u,
+    0x0100070605040302u, 0x0107060504030200u, 0x0007060504030201u, 0x0706050403020100u,
+};
+// The same for four 64-bit lanes: lane k is the pair of 32-bit lanes 2k and 2k + 1.
+static const uint64_t __array_partition_pairs[16] = {
+    0x0706050403020100u, 0x0706050403020100u, 0x0706050401000302u, 0x0706050403020100u,
+    0x0706030201000504u, 0x0706030205040100u, 0x0706010005040302u, 0x0706050403020100u,
+    0x0504030201000706u, 0x0504030207060100u, 0x0504010007060302u, 0x0504070603020100u,
+    0x0302010007060504u, 0x0302070605040100u, 0x0100070605040302u, 0x0706050403020100u,
+};
+
+#define __ARRAY_SCAN_PARTITION_AVX2(NAME, T, W, SPLAT, LESS, ORDER) \
+__SIMD_AVX2 static inline size_t __array_partition_avx2_##NAME(T* p, size_t n, T pivot) { \
+    if (n < 2 * W) return __array_partition_scalar_##NAME(p, n, pivot); \
+    const __m256i pv = SPLAT(pivot); \
+    __m256i held_left = _mm256_loadu_si256((const __m256i*)p), held_right = _mm256_loadu_si256((const __m256i*)(p + n - W)); \
+    size_t read_left = W, read_right = n - W, write_left = 0, write_right = n; \
+    while (read_right - read_left >= W) { \
+        __m256i x; \
+        if (read_left - write_left <= write_right - read_right) { \
+            x = _mm256_loadu_si256((const __m256i*)(p + read_left)); \
+            read_left += W; \
+        } else { \
+            read_right -= W; \
+            x = _mm256_loadu_si256((const __m256i*)(p + read_right)); \
+        } \
+        unsigned mask = (unsigned)LESS(x, pv); \
+        __m256i y = _mm256_permutevar8x32_epi32(x, ORDER(mask)); \
+        size_t less = (size_t)__builtin_popcount(mask); \
+        _mm256_storeu_si256((__m256i*)(p + write_left), y); \
+        _mm256_storeu_si256((__m256i*)(p + write_right - W), y); \
+        write_left += less; \
+        write_right -= W - less; \
+    } \
+    T rest[3 * W]; \
+    size_t count = read_right - read_left; \
+    memcpy(rest, p + read_left, count * sizeof(T)); \
+    _mm256_storeu_si256((__m256i*)(rest + count), held_left); \
+    _mm256_storeu_si256((__m256i*)(rest + count + W), held_right); \
+    for (size_t k = 0; k < count + 2 * W; k++) { \
+        if (rest[k] < pivot) p[write_left++] = rest[k]; \
+        else p[--write_right] = rest[k]; \
+    } \
+    return write_left; \
+}
+__SIMD_AVX2 static inline int __array_partition_less_int(__m256i x, __m256i pv) {
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pv, x)));
+}
+__SIMD_AVX2 static inline int __array_partition_less_uint(__m256i x, __m256i pv) {
+    const __m256i flip = _mm256_set1_epi32(INT_MIN);
+    return _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_xor_si256(pv, flip), _mm256_xor_si256(x, flip))));
+}
+__SIMD_AVX2 static inline int __array_partition_less_float(__m256i x, __m256i pv) {
+    return _mm256_movemask_ps(_mm256_cmp_ps(_mm256_castsi256_ps(x), _mm256_castsi256_ps(pv), _CMP_LT_OQ));
+}
+__SIMD_AVX2 static inline __m256i __array_partition_splat_int(int pivot) { return _mm256_set1_epi32(pivot); }
+__SIMD_AVX2 static inline __m256i __array_partition_splat_uint(unsigned int pivot) { return _mm256_set1_epi32((int)pivot); }
+__SIMD_AVX2 static inline __m256i __array_partition_splat_float(float pivot) { return _mm256_castps_si256(_mm256_set1_ps(pivot)); }
+__SIMD_AVX2 static inline int __array_partition_less_llong(__m256i x, __m256i pv) {
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(pv, x)));
+}
+__SIMD_AVX2 static inline int __array_partition_less_ullong(__m256i x, __m256i pv) {
+    const __m256i flip = _mm256_set1_epi64x(LLONG_MIN);
+    return _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(_mm256_xor_si256(pv, flip), _mm256_xor_si256(x, flip))));
+}
+__SIMD_AVX2 static inline int __array_partition_less_double(__m256i x, __m256i pv) {
+    return _mm256_movemask_pd(_mm256_cmp_pd(_mm256_castsi256_pd(x), _mm256_castsi256_pd(pv), _CMP_LT_OQ));
+}
+__SIMD_AVX2 static inline __m256i __array_partition_splat_llong(long long pivot) { return _mm256_set1_epi64x(pivot); }
+__SIMD_AVX2 static inline __m256i __array_partition_splat_ullong(unsigned long long pivot) { return _mm256_set1_epi64x((long long)pivot); }
+__SIMD_AVX2 static inline __m256i __array_partition_splat_double(double pivot) { return _mm256_castpd_si256(_mm256_set1_pd(pivot)); }
+__SIMD_AVX2 static inline __m256i __array_partition_order_32(unsigned mask) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&__array_partition_lanes[mask]));
+}
+__SIMD_AVX2 static inline __m256i __array_partition_order_64(unsigned mask) {
+    return _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)&__array_partition_pairs[mask]));
+}
+__ARRAY_SCAN_PARTITION_AVX2(int, int, 8, __array_partition_splat_int, __array_partition_less_int, __array_partition_order_32)
+__ARRAY_SCAN_PARTITION_AVX2(uint, unsigned int, 8, __array_partition_splat_uint, __array_partition_less_uint, __array_partition_order_32)
+__ARRAY_SCAN_PARTITION_AVX2(float, float, 8, __array_partition_splat_float, __array_partition_less_float, __array_partition_order_32)
+__ARRAY_SCAN_PARTITION_AVX2(llong, long long, 4, __array_partition_splat_llong, __array_partition_less_llong, __array_partition_order_64)
+__ARRAY_SCAN_PARTITION_AVX2(ullong, unsigned long long, 4, __array_partition_splat_ullong, __array_partition_less_ullong,
+    __array_partition_order_64)
+__ARRAY_SCAN_PARTITION_AVX2(double, double, 4, __array_partition_splat_double, __array_partition_less_double, __array_partition_order_64)
+#if LONG_MAX == LLONG_MAX
+__ARRAY_SCAN_PARTITION_AVX2(long, long, 4, __array_partition_splat_llong, __array_partition_less_llong, __array_partition_order_64)
+__ARRAY_SCAN_PARTITION_AVX2(ulong, unsigned long, 4, __array_partition_splat_ullong, __array_partition_less_ullong,
+    __array_partition_order_64)
+#endif
+
+#define __ARRAY_SCAN_SSE2_PICK(OP, NAME) __array_##OP##_sse2_##NAME
+#define __ARRAY_SCAN_AVX2_PICK(OP, NAME) (__simd_has_avx2() ? __array_##OP##_avx2_##NAME : __array_##OP##_scalar_##NAME)
+#else
+#define __ARRAY_SCAN_SSE2_PICK(OP, NAME) __array_##OP##_scalar_##NAME
+#define __ARRAY_SCAN_AVX2_PICK(OP, NAME) __array_##OP##_scalar_##NAME
+#endif
+#define __ARRAY_SCAN_SCALAR_PICK(OP, NAME) __array_##OP##_scalar_##NAME
+
+// Which kernel each type gets: PREFIX SUM, HISTOGRAM BLOCK, PARTITION
+#define __ARRAY_SCAN_VECTOR_char    __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_VECTOR_schar   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_VECTOR_uchar   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_VECTOR_short   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_VECTOR_ushort  __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_VECTOR_int     __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_AVX2_PICK
+#define __ARRAY_SCAN_VECTOR_uint    __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_AVX2_PICK
+#if LONG_MAX == LLONG_MAX
+    #define __ARRAY_SCAN_VECTOR_long    __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_AVX2_PICK
+    #define __ARRAY_SCAN_VECTOR_ulong   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_AVX2_PICK
+#else
+    #define __ARRAY_SCAN_VECTOR_long    __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK
+    #define __ARRAY_SCAN_VECTOR_ulong   __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK
+#endif
+#define __ARRAY_SCAN_VECTOR_llong   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_AVX2_PICK
+#define __ARRAY_SCAN_VECTOR_ullong  __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_AVX2_PICK
+#define __ARRAY_SCAN_VECTOR_float   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_AVX2_PICK
+#define __ARRAY_SCAN_VECTOR_double  __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_SSE2_PICK,   __ARRAY_SCAN_AVX2_PICK
+#define __ARRAY_SCAN_VECTOR_ldouble __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK, __ARRAY_SCAN_SCALAR_PICK
+#define __ARRAY_SCAN_KERNEL(WHICH, OP, NAME) __ARRAY_SCAN_KERNEL_(WHICH, OP, NAME, __ARRAY_SCAN_VECTOR_##NAME)
+#define __ARRAY_SCAN_KERNEL_(WHICH, OP, NAME, ...) __ARRAY_SCAN_KERNEL_##WHICH(OP, NAME, __VA_ARGS__)
+#define __ARRAY_SCAN_KERNEL_0(OP, NAME, PREFIX, HISTOGRAM, PARTITION) PREFIX(OP, NAME)
+#define __ARRAY_SCAN_KERNEL_1(OP, NAME, PREFIX, HISTOGRAM, PARTITION) HISTOGRAM(OP, NAME)
+#define __ARRAY_SCAN_KERNEL_2(OP, NAME, PREFIX, HISTOGRAM, PARTITION) PARTITION(OP, NAME)
+#define __ARRAY_SCAN_HISTOGRAM_PICK(NAME) __ARRAY_SCAN_KERNEL(1, histogram_block, NAME)
+
+// The entry points every _Generic arm lands on.
+#define __ARRAY_SCAN_ENTRY(NAME, T, U, CLASS, ...) \
+static inline void __array_prefix_sum_##NAME(T* destination, const T* source, size_t n) { \
+    __COUNTER_BEGIN("array_prefix_sum", #T) \
+    __ARRAY_SCAN_KERNEL(0, prefix_sum, NAME)(destination, source, n); \
+    __COUNTER_END(2 * n * sizeof(T)); \
+} \
+static inline size_t __array_partition_##NAME(T* p, size_t n, T pivot) { \
+    __COUNTER_BEGIN("array_partition", #T) \
+    size_t boundary = __ARRAY_SCAN_KERNEL(2, partition, NAME)(p, n, pivot); \
+    __COUNTER_END(n * sizeof(T)); \
+    return boundary; \
+}
+__ARRAY_SCAN_TYPES(__ARRAY_SCAN_ENTRY, )
+__ARRAY_SCAN_TYPES(__ARRAY_SCAN_HISTOGRAM, )
+
+#define __ARRAY_SCAN_ARM(NAME, T, U, CLASS, OP) T*: __array_##OP##_##NAME,
+#define __ARRAY_SCAN_CONST_ARM(NAME, T, U, CLASS, OP) T*: __array_##OP##_##NAME, const T*: __array_##OP##_##NAME,
+#define __array_scan_generic(OP, p) _Generic((p), __ARRAY_SCAN_TYPES(__ARRAY_SCAN_ARM, OP) default: NULL)
+#define __array_scan_const_generic(OP, p) _Generic((p), __ARRAY_SCAN_TYPES(__ARRAY_SCAN_CONST_ARM, OP) default: NULL)
+
+#ifndef __array_argc2
+    #define __array_argc2(_1, _2, NAME, ...) NAME
+#endif
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+#ifndef __array_argc6
+    #define __array_argc6(_1, _2, _3, _4, _5, _6, NAME, ...) NAME
+#endif
+
+#define __array_prefix_sum_n(destination, source, n) __array_scan_generic(prefix_sum, destination)((destination), (source), (n))
+#define __array_prefix_sum_info(destination, source) __array_prefix_sum_n(destination, source, allocated_info(source).arraysize)
+#define array_prefix_sum(...) __array_argc3(__VA_ARGS__, __array_prefix_sum_n, __array_prefix_sum_info, )(__VA_ARGS__)
+
+#define __array_histogram_n(p, n, bins, low, high, bin_count) \
+    __array_scan_const_generic(histogram, p)((p), (n), (bins), (low), (high), (bin_count))
+#define __array_histogram_info(p, n, bins, low, high) __array_histogram_n(p, n, bins, low, high, allocated_info(bins).arraysize)
+#define array_histogram(...) __array_argc6(__VA_ARGS__, __array_histogram_n, __array_histogram_info, , , , )(__VA_ARGS__)
+
+#define __array_partition_n(p, n, pivot) __array_scan_generic(partition, p)((p), (n), (pivot))
+#define __array_partition_info(p, pivot) __array_partition_n(p, allocated_info(p).arraysize, pivot)
+#define array_partition(...) __array_argc3(__VA_ARGS__, __array_partition_n, __array_partition_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,236 @@
+// Florestan's Array Search
+//
+// © dongwanpianist
+//
+// Type-generic searches in sorted arrays, chosen by _Generic like <florestan/array_sort.h>, without bsearch's comparator calls.
+// The binary search halves the range with a conditional move instead of a branch, so there is nothing to mispredict,
+// and prefetches both places where the next probe may land, so the cache misses of the two halves overlap.
+// Up to FLORESTAN_SEARCH_LINEAR elements it only counts the elements less than the key, eight lanes at a time with AVX2.
+// For many lookups into one big table, the Eytzinger layout stores the sorted array in the order of a breadth-first walk
+// over its search tree: the first probes of every lookup then share a few cache lines, and the children of an element
+// are next to each other, so four levels ahead fit in one prefetched line.
+//
+// 1. array_lower_bound(POINTER_OR_ARRAY, [COUNT,] KEY) -> size_t
+//      * the first index whose element is not less than KEY, COUNT when there is none
+//      * POINTER_OR_ARRAY must be sorted ascending, as array_sort() leaves it (with no NaN for floats)
+// 2. array_contains(POINTER_OR_ARRAY, [COUNT,] KEY) -> bool
+// 3. array_eytzinger_build(DESTINATION, SOURCE [, COUNT])
+//      * writes the sorted SOURCE into DESTINATION (COUNT elements, not overlapping SOURCE) in Eytzinger order:
+//        the children of DESTINATION[k] are DESTINATION[2k + 1] and DESTINATION[2k + 2]
+// 4. array_eytzinger_lower_bound(EYTZINGER, [COUNT,] KEY) -> size_t
+//      * the index in EYTZINGER of the smallest element not less than KEY, COUNT when there is none
+// 5. array_eytzinger_contains(EYTZINGER, [COUNT,] KEY) -> bool
+//      * COUNT is allocated_info(first argument).arraysize when omitted,
+//        so leave it out only for fixed arrays and blocks allocated_info() can measure
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double (and their const)
+//      * KEY is converted to the element type
+
+#ifndef FLORESTAN_ARRAY_SEARCH_H
+#define FLORESTAN_ARRAY_SEARCH_H
+#include "type_traits.h"
+#include "simd.h"
+#include <stdint.h>
+#include <limits.h>
+
+#ifndef FLORESTAN_SEARCH_LINEAR
+    #define FLORESTAN_SEARCH_LINEAR 64
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define __array_prefetch(p) __builtin_prefetch(p)
+#else
+    #define __array_prefetch(p) ((void)0)
+#endif
+
+// NAME, TYPE
+#define __ARRAY_SEARCH_TYPES(X, ...) \
+    X(char,    char,               __VA_ARGS__) \
+    X(schar,   signed char,        __VA_ARGS__) \
+    X(uchar,   unsigned char,      __VA_ARGS__) \
+    X(short,   short,              __VA_ARGS__) \
+    X(ushort,  unsigned short,     __VA_ARGS__) \
+    X(int,     int,                __VA_ARGS__) \
+    X(uint,    unsigned int,       __VA_ARGS__) \
+    X(long,    long,               __VA_ARGS__) \
+    X(ulong,   unsigned long,      __VA_ARGS__) \
+    X(llong,   long long,          __VA_ARGS__) \
+    X(ullong,  unsigned long long, __VA_ARGS__) \
+    X(float,   float,              __VA_ARGS__) \
+    X(double,  double,             __VA_ARGS__) \
+    X(ldouble, long double,        __VA_ARGS__)
+
+// The portable kernels: counting (the lower bound of a short sorted array), and the Eytzinger layout.
+#define __ARRAY_SEARCH_SCALAR(NAME, T, ...) \
+static inline size_t __array_count_less_scalar_##NAME(const T* p, size_t n, T key) { \
+    size_t c = 0; \
+    for (size_t i = 0; i < n; i++) c += p[i] < key; \
+    return c; \
+} \
+static inline size_t __array_eytzinger_fill_##NAME(T* e, const T* p, size_t i, size_t k, size_t n) { \
+    if (k < n) { \
+        i = __array_eytzinger_fill_##NAME(e, p, i, 2 * k + 1, n); \
+        e[k] = p[i++]; \
+        i = __array_eytzinger_fill_##NAME(e, p, i, 2 * k + 2, n); \
+    } \
+    return i; \
+}
+__ARRAY_SEARCH_TYPES(__ARRAY_SEARCH_SCALAR, )
+
+#ifdef FLORESTAN_X86_SIMD
+// Each lane compares to the key and becomes 0 or -1, and subtracting that counts the lanes that were less.
+// Unsigned lanes flip their sign bits first, because AVX2 only compares signed integers.
+__SIMD_AVX2 static inline __m256i __array_less_avx2_int(const int* p, int key) {
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32(key), _mm256_loadu_si256((const __m256i*)p));
+}
+__SIMD_AVX2 static inline __m256i __array_less_avx2_uint(const unsigned int* p, unsigned int key) {
+    const __m256i flip = _mm256_set1_epi32(INT32_MIN);
+    return _mm256_cmpgt_epi32(_mm256_set1_epi32((int)(key ^ 0x80000000u)), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), flip));
+}
+__SIMD_AVX2 static inline __m256i __array_less_avx2_llong(const long long* p, long long key) {
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x(key), _mm256_loadu_si256((const __m256i*)p));
+}
+__SIMD_AVX2 static inline __m256i __array_less_avx2_ullong(const unsigned long long* p, unsigned long long key) {
+    const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+    return _mm256_cmpgt_epi64(_mm256_set1_epi64x((long long)(key ^ 0x8000000000000000u)), _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)p), flip));
+}
+#if LONG_MAX == LLONG_MAX
+// long is as wide as long long here, and the loads do not care which of the two they read.
+__SIMD_AVX2 static inline __m256i __array_less_avx2_long(const long* p, long key) { return __array_less_avx2_llong((const long long*)p, key); }
+__SIMD_AVX2 static inline __m256i __array_less_avx2_ulong(const unsigned long* p, unsigned long key) { return __array_less_avx2_ullong((const unsigned long long*)p, key); }
+#endif
+__SIMD_AVX2 static inline __m256i __array_less_avx2_float(const float* p, float key) {
+    return _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(key), _CMP_LT_OQ));
+}
+__SIMD_AVX2 static inline __m256i __array_less_avx2_double(const double* p, double key) {
+    return _mm256_castpd_si256(_mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(key), _CMP_LT_OQ));
+}
+__SIMD_AVX2 static inline size_t __array_lanes_sum_epi32(__m256i count) {
+    int lanes[8];
+    _mm256_storeu_si256((__m256i*)lanes, count);
+    return (size_t)lanes[0] + (size_t)lanes[1] + (size_t)lanes[2] + (size_t)lanes[3]
+        + (size_t)lanes[4] + (size_t)lanes[5] + (size_t)lanes[6] + (size_t)lanes[7];
+}
+__SIMD_AVX2 static inline size_t __array_lanes_sum_epi64(__m256i count) {
+    long long lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, count);
+    return (size_t)lanes[0] + (size_t)lanes[1] + (size_t)lanes[2] + (size_t)lanes[3];
+}
+#define __ARRAY_SEARCH_COUNT_AVX2(NAME, T, W, SUB, SUM) \
+__SIMD_AVX2 static inline size_t __array_count_less_avx2_##NAME(const T* p, size_t n, T key) { \
+    __m256i count = _mm256_setzero_si256(); \
+    size_t i = 0; \
+    for (; i + W <= n; i += W) count = SUB(count, __array_less_avx2_##NAME(p + i, key)); \
+    return SUM(count) + __array_count_less_scalar_##NAME(p + i, n - i, key); \
+}
+__ARRAY_SEARCH_COUNT_AVX2(int, int, 8, _mm256_sub_epi32, __array_lanes_sum_epi32)
+__ARRAY_SEARCH_COUNT_AVX2(uint, unsigned int, 8, _mm256_sub_epi32, __array_lanes_sum_epi32)
+__ARRAY_SEARCH_COUNT_AVX2(llong, long long, 4, _mm256_sub_epi64, __array_lanes_sum_epi64)
+__ARRAY_SEARCH_COUNT_AVX2(ullong, unsigned long long, 4, _mm256_sub_epi64, __array_lanes_sum_epi64)
+#if LONG_MAX == LLONG_MAX
+__ARRAY_SEARCH_COUNT_AVX2(long, long, 4, _mm256_sub_epi64, __array_lanes_sum_epi64)
+__ARRAY_SEARCH_COUNT_AVX2(ulong, unsigned long, 4, _mm256_sub_epi64, __array_lanes_sum_epi64)
+#endif
+__ARRAY_SEARCH_COUNT_AVX2(float, float, 8, _mm256_sub_epi32, __array_lanes_sum_epi32)
+__ARRAY_SEARCH_COUNT_AVX2(double, double, 4, _mm256_sub_epi64, __array_lanes_sum_epi64)
+#define __ARRAY_SEARCH_AVX2_PICK(NAME) (__simd_has_avx2() ? __array_count_less_avx2_##NAME : __array_count_less_scalar_##NAME)
+#else
+#define __ARRAY_SEARCH_AVX2_PICK(NAME) __array_count_less_scalar_##NAME
+#endif
+#define __ARRAY_SEARCH_SCALAR_PICK(NAME) __array_count_less_scalar_##NAME
+#define __ARRAY_SEARCH_VECTOR_char    __ARRAY_SEARCH_SCALAR_PICK
+#define __ARRAY_SEARCH_VECTOR_schar   __ARRAY_SEARCH_SCALAR_PICK
+#define __ARRAY_SEARCH_VECTOR_uchar   __ARRAY_SEARCH_SCALAR_PICK
+#define __ARRAY_SEARCH_VECTOR_short   __ARRAY_SEARCH_SCALAR_PICK
+#define __ARRAY_SEARCH_VECTOR_ushort  __ARRAY_SEARCH_SCALAR_PICK
+#define __ARRAY_SEARCH_VECTOR_int     __ARRAY_SEARCH_AVX2_PICK
+#define __ARRAY_SEARCH_VECTOR_uint    __ARRAY_SEARCH_AVX2_PICK
+#if LONG_MAX == LLONG_MAX
+    #define __ARRAY_SEARCH_VECTOR_long    __ARRAY_SEARCH_AVX2_PICK
+    #define __ARRAY_SEARCH_VECTOR_ulong   __ARRAY_SEARCH_AVX2_PICK
+#else
+    #define __ARRAY_SEARCH_VECTOR_long    __ARRAY_SEARCH_SCALAR_PICK
+    #define __ARRAY_SEARCH_VECTOR_ulong   __ARRAY_SEARCH_SCALAR_PICK
+#endif
+#define __ARRAY_SEARCH_VECTOR_llong   __ARRAY_SEARCH_AVX2_PICK
+#define __ARRAY_SEARCH_VECTOR_ullong  __ARRAY_SEARCH_AVX2_PICK
+#define __ARRAY_SEARCH_VECTOR_float   __ARRAY_SEARCH_AVX2_PICK
+#define __ARRAY_SEARCH_VECTOR_double  __ARRAY_SEARCH_AVX2_PICK
+#define __ARRAY_SEARCH_VECTOR_ldouble __ARRAY_SEARCH_SCALAR_PICK
+
+static inline unsigned __array_search_ctz(size_t x) { // x != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(x);
+#else
+    unsigned n = 0;
+    while (!(x & 1)) { x >>= 1; n++; }
+    return n;
+#endif
+}
+
+// The binary search keeps the answer within [base, base + n] and every element before base less than KEY;
+// once n is short enough, counting the elements less than KEY in [base, base + n) finishes it.
+// In the Eytzinger search, k walks down the tree, right after every element less than KEY. It ends past the leaves,
+// and the answer is the last node it went left from: drop the trailing right turns (1 bits of k + 1) and that left turn.
+#define __ARRAY_SEARCH_FUNCTIONS(NAME, T, ...) \
+static inline size_t __array_lower_bound_##NAME(const T* p, size_t n, T key) { \
+    const T* base = p; \
+    while (n > FLORESTAN_SEARCH_LINEAR) { \
+        size_t half = n / 2; \
+        __array_prefetch(base + half / 2); \
+        __array_prefetch(base + half + half / 2); \
+        base = base[half] < key ? base + half : base; \
+        n -= half; \
+    } \
+    return (size_t)(base - p) + __ARRAY_SEARCH_VECTOR_##NAME(NAME)(base, n, key); \
+} \
+static inline bool __array_contains_##NAME(const T* p, size_t n, T key) { \
+    size_t i = __array_lower_bound_##NAME(p, n, key); \
+    return i < n && !(key < p[i]); \
+} \
+static inline void __array_eytzinger_build_##NAME(T* e, const T* p, size_t n) { __array_eytzinger_fill_##NAME(e, p, 0, 0, n); } \
+static inline size_t __array_eytzinger_lower_bound_##NAME(const T* e, size_t n, T key) { \
+    size_t k = 0; \
+    while (k < n) { \
+        __array_prefetch(e + (16 * k + 15 < n ? 16 * k + 15 : 0)); /* four levels down */ \
+        k = 2 * k + 1 + (e[k] < key); \
+    } \
+    k = (k + 1) >> (__array_search_ctz(~(k + 1)) + 1); \
+    return k ? k - 1 : n; \
+} \
+static inline bool __array_eytzinger_contains_##NAME(const T* e, size_t n, T key) { \
+    size_t i = __array_eytzinger_lower_bound_##NAME(e, n, key); \
+    return i < n && !(key < e[i]); \
+}
+__ARRAY_SEARCH_TYPES(__ARRAY_SEARCH_FUNCTIONS, )
+
+#define __ARRAY_SEARCH_ARM(NAME, T, OP) T*: __array_##OP##_##NAME,
+#define __ARRAY_SEARCH_CONST_ARM(NAME, T, OP) T*: __array_##OP##_##NAME, const T*: __array_##OP##_##NAME,
+#define __array_search_generic(OP, p) _Generic((p), __ARRAY_SEARCH_TYPES(__ARRAY_SEARCH_ARM, OP) default: NULL)
+#define __array_search_const_generic(OP, p) _Generic((p), __ARRAY_SEARCH_TYPES(__ARRAY_SEARCH_CONST_ARM, OP) default: NULL)
+
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+
+#define __array_lower_bound_n(p, n, key) __array_search_const_generic(lower_bound, p)((p), (n), (key))
+#define __array_lower_bound_info(p, key) __array_lower_bound_n(p, allocated_info(p).arraysize, key)
+#define array_lower_bound(...) __array_argc3(__VA_ARGS__, __array_lower_bound_n, __array_lower_bound_info, )(__VA_ARGS__)
+
+#define __array_contains_n(p, n, key) __array_search_const_generic(contains, p)((p), (n), (key))
+#define __array_contains_info(p, key) __array_contains_n(p, allocated_info(p).arraysize, key)
+#define array_contains(...) __array_argc3(__VA_ARGS__, __array_contains_n, __array_contains_info, )(__VA_ARGS__)
+
+#define __array_eytzinger_build_n(destination, source, n) __array_search_generic(eytzinger_build, destination)((destination), (source), (n))
+#define __array_eytzinger_build_info(destination, source) __array_eytzinger_build_n(destination, source, allocated_info(destination).arraysize)
+#define array_eytzinger_build(...) __array_argc3(__VA_ARGS__, __array_eytzinger_build_n, __array_eytzinger_build_info, )(__VA_ARGS__)
+
+#define __array_eytzinger_lower_bound_n(e, n, key) __array_search_const_generic(eytzinger_lower_bound, e)((e), (n), (key))
+#define __array_eytzinger_lower_bound_info(e, key) __array_eytzinger_lower_bound_n(e, allocated_info(e).arraysize, key)
+#define array_eytzinger_lower_bound(...) __array_argc3(__VA_ARGS__, __array_eytzinger_lower_bound_n, __array_eytzinger_lower_bound_info, )(__VA_ARGS__)
+
+#define __array_eytzinger_contains_n(e, n, key) __array_search_const_generic(eytzinger_contains, e)((e), (n), (key))
+#define __array_eytzinger_contains_info(e, key) __array_eytzinger_contains_n(e, allocated_info(e).arraysize, key)
+#define array_eytzinger_contains(...) __array_argc3(__VA_ARGS__, __array_eytzinger_contains_n, __array_eytzinger_contains_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,212 @@
+// Florestan's Array Sort
+//
+// © dongwanpianist
+//
+// Type-generic ascending sort over arrays of fundamental types, chosen by _Generic like <florestan/array_reduce.h>.
+// Every element type gets its own inlined code, so no comparator is ever called through a function pointer (unlike qsort).
+//
+// 1. array_sort(POINTER_OR_ARRAY [, COUNT])
+//      * COUNT is allocated_info(POINTER_OR_ARRAY).arraysize when omitted,
+//        so leave it out only for fixed arrays and blocks allocated_info() can measure
+//      * supported element types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+//        long, unsigned long, long long, unsigned long long, float, double, long double
+//      * integers: LSD radix sort, one byte per pass, with the sign bit flipped for signed types
+//      * float and double: the same radix sort on their bits, turned into unsigned keys that sort like the values
+//          -NaN < -infinity < ... < -0.0 < +0.0 < ... < +infinity < +NaN
+//      * long double: introsort with the same order (NaNs at the ends, by sign)
+//      * arrays shorter than FLORESTAN_SORT_RADIX_MIN, and any array when the scratch buffer (COUNT elements)
+//        cannot be allocated, fall back to introsort
+//
+// The radix sort counts every byte position in one pass over the input,
+// and skips a pass entirely when all the keys share that byte (small numbers in wide types).
+
+#ifndef FLORESTAN_ARRAY_SORT_H
+#define FLORESTAN_ARRAY_SORT_H
+#include "type_traits.h"
+#include "counters.h"
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#ifndef FLORESTAN_SORT_RADIX_MIN
+    #define FLORESTAN_SORT_RADIX_MIN 256
+#endif
+#define __ARRAY_SORT_INSERTION 16
+
+// NAME, TYPE, KEY TYPE, SIGNED
+#define __ARRAY_SORT_INTEGERS(X) \
+    X(char,    char,               unsigned char,      CHAR_MIN < 0) \
+    X(schar,   signed char,        unsigned char,      1) \
+    X(uchar,   unsigned char,      unsigned char,      0) \
+    X(short,   short,              unsigned short,     1) \
+    X(ushort,  unsigned short,     unsigned short,     0) \
+    X(int,     int,                unsigned int,       1) \
+    X(uint,    unsigned int,       unsigned int,       0) \
+    X(long,    long,               unsigned long,      1) \
+    X(ulong,   unsigned long,      unsigned long,      0) \
+    X(llong,   long long,          unsigned long long, 1) \
+    X(ullong,  unsigned long long, unsigned long long, 0)
+// NAME, TYPE, KEY TYPE
+#define __ARRAY_SORT_FLOATINGS(X) \
+    X(float,   float,              uint32_t) \
+    X(double,  double,             uint64_t)
+
+// Integers compare as they are; the key only moves the sign bit so that negatives come first.
+#define __ARRAY_SORT_INTEGER_KEY(NAME, T, U, SIGNED) \
+static inline U __array_sort_key_##NAME(T x) { \
+    return (U)((U)x ^ ((SIGNED) ? (U)((U)1 << (sizeof(U) * CHAR_BIT - 1)) : (U)0)); \
+} \
+static inline bool __array_sort_less_##NAME(T a, T b) { return a < b; }
+__ARRAY_SORT_INTEGERS(__ARRAY_SORT_INTEGER_KEY)
+
+// IEEE 754 bits: a positive value only needs its sign bit set, and a negative one is inverted entirely,
+// so bigger magnitudes of negatives get smaller keys.
+#define __ARRAY_SORT_FLOATING_KEY(NAME, T, U) \
+_Static_assert(sizeof(T) == sizeof(U), "array_sort expects IEEE 754 " #T); \
+static inline U __array_sort_key_##NAME(T x) { \
+    U bits; \
+    memcpy(&bits, &x, sizeof bits); \
+    U sign = (U)1 << (sizeof(U) * CHAR_BIT - 1); \
+    return bits ^ ((U)-(bits >> (sizeof(U) * CHAR_BIT - 1)) | sign); \
+} \
+static inline bool __array_sort_less_##NAME(T a, T b) { return __array_sort_key_##NAME(a) < __array_sort_key_##NAME(b); }
+__ARRAY_SORT_FLOATINGS(__ARRAY_SORT_FLOATING_KEY)
+
+// long double has no portable bit layout (x87 has padding bytes), so it orders by value, with NaNs at the ends by sign.
+static inline bool __array_sort_less_ldouble(long double a, long double b) {
+    if (!isnan(a) && !isnan(b)) return a < b || (a == b && signbit(a) && !signbit(b));
+    int ra = isnan(a) ? (signbit(a) ? -1 : 1) : 0;
+    int rb = isnan(b) ? (signbit(b) ? -1 : 1) : 0;
+    return ra < rb;
+}
+
+// Introsort: median-of-three quicksort on the larger side's loop and the smaller side's recursion,
+// heapsort once the depth budget runs out, and insertion sort for short ranges.
+#define __ARRAY_SORT_INTRO(NAME, T, ...) \
+static inline void __array_insertion_sort_##NAME(T* p, size_t n) { \
+    for (size_t i = 1; i < n; i++) { \
+        T x = p[i]; \
+        size_t j = i; \
+        for (; j > 0 && __array_sort_less_##NAME(x, p[j - 1]); j--) p[j] = p[j - 1]; \
+        p[j] = x; \
+    } \
+} \
+static inline void __array_sift_down_##NAME(T* p, size_t root, size_t n) { \
+    T x = p[root]; \
+    for (size_t child; (child = 2 * root + 1) < n; root = child) { \
+        if (child + 1 < n && __array_sort_less_##NAME(p[child], p[child + 1])) child++; \
+        if (!__array_sort_less_##NAME(x, p[child])) break; \
+        p[root] = p[child]; \
+    } \
+    p[root] = x; \
+} \
+static inline void __array_heap_sort_##NAME(T* p, size_t n) { \
+    for (size_t i = n / 2; i-- > 0;) __array_sift_down_##NAME(p, i, n); \
+    for (size_t i = n; i-- > 1;) { \
+        T x = p[0]; p[0] = p[i]; p[i] = x; \
+        __array_sift_down_##NAME(p, 0, i); \
+    } \
+} \
+static inline void __array_intro_sort_loop_##NAME(T* p, size_t n, unsigned int depth) { \
+    while (n > __ARRAY_SORT_INSERTION) { \
+        if (depth-- == 0) { __array_heap_sort_##NAME(p, n); return; } \
+        size_t mid = n / 2; \
+        T t; \
+        if (__array_sort_less_##NAME(p[mid], p[0]))     { t = p[mid]; p[mid] = p[0]; p[0] = t; } \
+        if (__array_sort_less_##NAME(p[n - 1], p[mid])) { t = p[mid]; p[mid] = p[n - 1]; p[n - 1] = t; } \
+        if (__array_sort_less_##NAME(p[mid], p[0]))     { t = p[mid]; p[mid] = p[0]; p[0] = t; } \
+        T pivot = p[mid]; \
+        size_t i = 0, j = n - 1; \
+        for (;;) { \
+            while (__array_sort_less_##NAME(p[i], pivot)) i++; \
+            while (__array_sort_less_##NAME(pivot, p[j])) j--; \
+            if (i >= j) break; \
+            t = p[i]; p[i] = p[j]; p[j] = t; \
+            i++; j--; \
+        } \
+        size_t left = j + 1; \
+        if (left < n - left) { __array_intro_sort_loop_##NAME(p, left, depth); p += left; n -= left; } \
+        else { __array_intro_sort_loop_##NAME(p + left, n - left, depth); n = left; } \
+    } \
+    __array_insertion_sort_##NAME(p, n); \
+} \
+static inline void __array_intro_sort_##NAME(T* p, size_t n) { \
+    unsigned int depth = 0; \
+    for (size_t m = n; m > 1; m >>= 1) depth += 2; \
+    __array_intro_sort_loop_##NAME(p, n, depth); \
+}
+__ARRAY_SORT_INTEGERS(__ARRAY_SORT_INTRO)
+__ARRAY_SORT_FLOATINGS(__ARRAY_SORT_INTRO)
+__ARRAY_SORT_INTRO(ldouble, long double)
+
+// LSD radix sort on the keys, moving whole elements between the array and one scratch buffer.
+// Returns false when the buffer cannot be allocated.
+#define __ARRAY_SORT_RADIX(NAME, T, U, ...) \
+static inline bool __array_radix_sort_##NAME(T* p, size_t n) { \
+    enum { passes = sizeof(U) }; \
+    T* buffer = malloc(n * sizeof(T)); \
+    if (buffer == NULL) return false; \
+    size_t counts[passes][256]; \
+    memset(counts, 0, sizeof counts); \
+    for (size_t i = 0; i < n; i++) { \
+        U key = __array_sort_key_##NAME(p[i]); \
+        for (int d = 0; d < passes; d++) counts[d][(key >> (8 * d)) & 0xFF]++; \
+    } \
+    T* from = p; \
+    T* to = buffer; \
+    for (int d = 0; d < passes; d++) { \
+        size_t* count = counts[d]; \
+        if (count[(__array_sort_key_##NAME(from[0]) >> (8 * d)) & 0xFF] == n) continue; \
+        size_t offset = 0; \
+        for (int b = 0; b < 256; b++) { size_t c = count[b]; count[b] = offset; offset += c; } \
+        for (size_t i = 0; i < n; i++) to[count[(__array_sort_key_##NAME(from[i]) >> (8 * d)) & 0xFF]++] = from[i]; \
+        T* swap = from; from = to; to = swap; \
+    } \
+    if (from != p) memcpy(p, from, n * sizeof(T)); \
+    free(buffer); \
+    return true; \
+}
+__ARRAY_SORT_INTEGERS(__ARRAY_SORT_RADIX)
+__ARRAY_SORT_FLOATINGS(__ARRAY_SORT_RADIX)
+
+// The entry points every _Generic arm lands on.
+#define __ARRAY_SORT_ENTRY(NAME, T, ...) \
+static inline void __array_sort_##NAME(T* p, size_t n) { \
+    __COUNTER_BEGIN("array_sort", #T) \
+    if (n >= 2 && (n < FLORESTAN_SORT_RADIX_MIN || !__array_radix_sort_##NAME(p, n))) __array_intro_sort_##NAME(p, n); \
+    __COUNTER_END(n * sizeof(T)); \
+}
+__ARRAY_SORT_INTEGERS(__ARRAY_SORT_ENTRY)
+__ARRAY_SORT_FLOATINGS(__ARRAY_SORT_ENTRY)
+static inline void __array_sort_ldouble(long double* p, size_t n) {
+    __COUNTER_BEGIN("array_sort", "long double")
+    __array_intro_sort_ldouble(p, n);
+    __COUNTER_END(n * sizeof(long double));
+}
+
+#define __array_sort_generic(p) _Generic((p), \
+    char*: __array_sort_char, \
+    signed char*: __array_sort_schar, \
+    unsigned char*: __array_sort_uchar, \
+    short*: __array_sort_short, \
+    unsigned short*: __array_sort_ushort, \
+    int*: __array_sort_int, \
+    unsigned int*: __array_sort_uint, \
+    long*: __array_sort_long, \
+    unsigned long*: __array_sort_ulong, \
+    long long*: __array_sort_llong, \
+    unsigned long long*: __array_sort_ullong, \
+    float*: __array_sort_float, \
+    double*: __array_sort_double, \
+    long double*: __array_sort_ldouble )
+
+#ifndef __array_argc2
+    #define __array_argc2(_1, _2, NAME, ...) NAME
+#endif
+
+#define __array_sort_n(p, n) __array_sort_generic(p)((p), (n))
+#define __array_sort_info(p) __array_sort_n(p, allocated_info(p).arraysize)
+#define array_sort(...) __array_argc2(__VA_ARGS__, __array_sort_n, __array_sort_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,263 @@
+// Florestan's Bitset
+//
+// © dongwanpianist
+//
+// A bool array spends a whole byte on every flag. A bitset_array packs 64 flags into every uint64_t word, 8 times smaller,
+// and answers its queries a word or four at a time: counts by popcnt or an AVX2 nibble table, searches by skipping
+// empty words, and selects with pdep, each picked at runtime where the CPU has it (see <florestan/simd.h>).
+// The bits past .size in the last word are always kept clear, so no query has to mask them out.
+//
+// 1. bitset_new(BITS) -> bitset_array* with every bit clear; NULL when out of memory
+//      .size           (size_t) bits
+//      .words          (uint64_t*) (.size + 63) / 64 words starting on a cache line; bit i is bit i % 64 of word i / 64
+// 2. bitset_free(BITSET)
+// 3. bitset_from_bools(BOOL_POINTER_OR_ARRAY [, COUNT]) -> bitset_array*
+//      * a new bitset whose bit i is BOOL_POINTER_OR_ARRAY[i]
+//      * COUNT is allocated_info(BOOL_POINTER_OR_ARRAY).arraysize when omitted
+// 4. bitset_get(BITSET, INDEX) -> bool
+//    bitset_set(BITSET, INDEX)
+//    bitset_clear(BITSET, INDEX)
+//      * an INDEX at or past .size reads false and writes nothing
+// 5. bitset_count(BITSET) -> size_t
+//      * the number of set bits
+// 6. bitset_find_first(BITSET [, FROM]) -> size_t
+//      * the first set bit at FROM (0 when omitted) or after it; .size when there is none
+// 7. bitset_select(BITSET, RANK) -> size_t
+//      * the set bit with RANK set bits before it, so bitset_select(BITSET, 0) is bitset_find_first(BITSET);
+//        .size when there are not that many
+// 8. bitset_and(DESTINATION, A, B)
+//    bitset_or(DESTINATION, A, B)
+//    bitset_xor(DESTINATION, A, B)
+//      * word by word, over as many words as the shortest of the three has; DESTINATION may be A or B
+// 9. __is_bitset(VARIABLE) and allocated_info(BITSET) (method "bitset") come with <florestan/type_traits.h>
+//      * with FLORESTAN_TRACKED_ALLOC, allocated_info(BITSET->words) shows the words too
+
+#ifndef FLORESTAN_BITSET_H
+#define FLORESTAN_BITSET_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include "simd.h"
+#include <stdint.h>
+#include <string.h>
+
+#define __BITSET_HEADER_SPACE 64 // the handle, padded so the words start on a cache line
+
+static inline size_t __bitset_words(size_t bits) { return bits / 64 + (bits % 64 != 0); }
+
+static inline unsigned __bitset_popcount(uint64_t w) {
+    w -= (w >> 1) & 0x5555555555555555u;
+    w = (w & 0x3333333333333333u) + ((w >> 2) & 0x3333333333333333u);
+    w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0Fu;
+    return (unsigned)((w * 0x0101010101010101u) >> 56);
+}
+static inline unsigned __bitset_ctz(uint64_t w) { // w != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctzll(w);
+#else
+    unsigned n = 0;
+    while (!(w & 1)) { w >>= 1; n++; }
+    return n;
+#endif
+}
+
+// Clears the bits past .size, after anything that may have written a whole last word.
+static inline void __bitset_trim(bitset_array* b) {
+    if (b->size % 64) b->words[b->size / 64] &= ~(uint64_t)0 >> (64 - b->size % 64);
+}
+
+static inline bitset_array* __bitset_new(size_t bits, const char* site) {
+    size_t words = __bitset_words(bits);
+    if (words > (SIZE_MAX / 2) / sizeof(uint64_t)) return NULL;
+    size_t size = words * sizeof(uint64_t);
+    size_t rounded = (size + __BITSET_HEADER_SPACE - 1) / __BITSET_HEADER_SPACE * __BITSET_HEADER_SPACE;
+    unsigned char* raw = aligned_alloc(__BITSET_HEADER_SPACE, __BITSET_HEADER_SPACE + rounded);
+    if (raw == NULL) return NULL;
+    bitset_array* b = (bitset_array*)raw;
+    *b = (bitset_array){ bits, (uint64_t*)(raw + __BITSET_HEADER_SPACE) };
+    memset(b->words, 0, size);
+#ifdef FLORESTAN_TRACKED_ALLOC
+    if (size) __registry_insert(b->words, size, sizeof(uint64_t), bitset, NULL);
+#endif
+    __heap_profile_note(size, 0, bitset, site);
+    return b;
+}
+#define bitset_new(bits) __bitset_new((bits), FLORESTAN_CALL_SITE)
+
+static inline void __bitset_free(bitset_array* b) {
+    if (b == NULL) return;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    if (b->size) __registry_remove(b->words);
+#endif
+    free(b);
+}
+#define bitset_free(b) __bitset_free(b)
+
+static inline bool __bitset_get(const bitset_array* b, size_t i) { return i < b->size && (b->words[i / 64] >> (i % 64) & 1); }
+static inline void __bitset_set(bitset_array* b, size_t i) { if (i < b->size) b->words[i / 64] |= (uint64_t)1 << (i % 64); }
+static inline void __bitset_clear(bitset_array* b, size_t i) { if (i < b->size) b->words[i / 64] &= ~((uint64_t)1 << (i % 64)); }
+#define bitset_get(b, i) __bitset_get((b), (i))
+#define bitset_set(b, i) __bitset_set((b), (i))
+#define bitset_clear(b, i) __bitset_clear((b), (i))
+
+// Portable kernels over n words; find returns the first nonzero word at or after i, or n.
+static inline size_t __bitset_count_scalar(const uint64_t* w, size_t n) {
+    size_t c = 0;
+    for (size_t i = 0; i < n; i++) c += __bitset_popcount(w[i]);
+    return c;
+}
+static inline size_t __bitset_find_scalar(const uint64_t* w, size_t i, size_t n) {
+    while (i < n && w[i] == 0) i++;
+    return i;
+}
+static inline unsigned __bitset_select_scalar(uint64_t w, unsigned rank) { // rank < popcount(w)
+    unsigned base = 0;
+    for (unsigned c; rank >= (c = __bitset_popcount(w & 0xFF)); rank -= c, w >>= 8) base += 8;
+    while (rank--) w &= w - 1;
+    return base + __bitset_ctz(w);
+}
+#define __BITSET_BINARY_SCALAR(OP, OPERATOR) \
+static inline void __bitset_##OP##_scalar(uint64_t* d, const uint64_t* a, const uint64_t* b, size_t n) { \
+    for (size_t i = 0; i < n; i++) d[i] = a[i] OPERATOR b[i]; \
+}
+__BITSET_BINARY_SCALAR(and, &)
+__BITSET_BINARY_SCALAR(or, |)
+__BITSET_BINARY_SCALAR(xor, ^)
+
+#ifdef FLORESTAN_X86_SIMD
+// Four independent sums, so one popcnt does not wait for the add of the previous one.
+__SIMD_POPCNT static inline size_t __bitset_count_popcnt(const uint64_t* w, size_t n) {
+    size_t c0 = 0, c1 = 0, c2 = 0, c3 = 0, i = 0;
+    for (; i + 4 <= n; i += 4) {
+        c0 += (size_t)__builtin_popcountll(w[i]);     c1 += (size_t)__builtin_popcountll(w[i + 1]);
+        c2 += (size_t)__builtin_popcountll(w[i + 2]); c3 += (size_t)__builtin_popcountll(w[i + 3]);
+    }
+    for (; i < n; i++) c0 += (size_t)__builtin_popcountll(w[i]);
+    return (c0 + c1) + (c2 + c3);
+}
+// Each nibble looks its count up in a 16-byte table (vpshufb); the byte counts add up for 31 vectors (at most 248 each)
+// before vpsadbw widens them into the four 64-bit sums.
+__SIMD_AVX2 static inline size_t __bitset_count_avx2(const uint64_t* w, size_t n) {
+    const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4, 0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low = _mm256_set1_epi8(0x0F);
+    __m256i total = _mm256_setzero_si256();
+    size_t i = 0, vectors = n / 4 * 4;
+    while (i < vectors) {
+        size_t end = vectors - i > 4 * 31 ? i + 4 * 31 : vectors;
+        __m256i bytes = _mm256_setzero_si256();
+        for (; i < end; i += 4) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(w + i));
+            bytes = _mm256_add_epi8(bytes, _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low))));
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(bytes, _mm256_setzero_si256()));
+    }
+    uint64_t lanes[4];
+    _mm256_storeu_si256((__m256i*)lanes, total);
+    size_t c = (size_t)(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    for (; i < n; i++) c += __bitset_popcount(w[i]);
+    return c;
+}
+__SIMD_AVX2 static inline size_t __bitset_find_avx2(const uint64_t* w, size_t i, size_t n) {
+    for (; i + 4 <= n; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(w + i));
+        if (!_mm256_testz_si256(v, v)) break;
+    }
+    return __bitset_find_scalar(w, i, n);
+}
+// pdep deposits the single bit 1 << rank into the rank-th set bit of w.
+__SIMD_BMI2 static inline unsigned __bitset_select_bmi2(uint64_t w, unsigned rank) {
+    return __bitset_ctz(_pdep_u64((uint64_t)1 << rank, w));
+}
+#define __BITSET_BINARY_AVX2(OP) \
+__SIMD_AVX2 static inline void __bitset_##OP##_avx2(uint64_t* d, const uint64_t* a, const uint64_t* b, size_t n) { \
+    size_t i = 0; \
+    for (; i + 4 <= n; i += 4) \
+        _mm256_storeu_si256((__m256i*)(d + i), _mm256_##OP##_si256(_mm256_loadu_si256((const __m256i*)(a + i)), \
+            _mm256_loadu_si256((const __m256i*)(b + i)))); \
+    __bitset_##OP##_scalar(d + i, a + i, b + i, n - i); \
+}
+__BITSET_BINARY_AVX2(and)
+__BITSET_BINARY_AVX2(or)
+__BITSET_BINARY_AVX2(xor)
+
+#define __BITSET_COUNT_PICK (__simd_has_avx2() ? __bitset_count_avx2 : __simd_has_popcnt() ? __bitset_count_popcnt : __bitset_count_scalar)
+#define __BITSET_SELECT_PICK (__simd_has_bmi2() ? __bitset_select_bmi2 : __bitset_select_scalar)
+#define __BITSET_PICK(OP) (__simd_has_avx2() ? __bitset_##OP##_avx2 : __bitset_##OP##_scalar)
+#else
+#define __BITSET_COUNT_PICK __bitset_count_scalar
+#define __BITSET_SELECT_PICK __bitset_select_scalar
+#define __BITSET_PICK(OP) __bitset_##OP##_scalar
+#endif
+
+static inline size_t __bitset_count(const bitset_array* b) { return __BITSET_COUNT_PICK(b->words, __bitset_words(b->size)); }
+#define bitset_count(b) __bitset_count(b)
+
+static inline size_t __bitset_find_first(const bitset_array* b, size_t from) {
+    if (from >= b->size) return b->size;
+    size_t i = from / 64, n = __bitset_words(b->size);
+    uint64_t w = b->words[i] & (~(uint64_t)0 << (from % 64));
+    if (w == 0) {
+        i = __BITSET_PICK(find)(b->words, i + 1, n);
+        if (i == n) return b->size;
+        w = b->words[i];
+    }
+    return i * 64 + __bitset_ctz(w);
+}
+#ifndef __array_argc2
+    #define __array_argc2(_1, _2, NAME, ...) NAME
+#endif
+#define __bitset_find_from(b, from) __bitset_find_first((b), (from))
+#define __bitset_find_start(b) __bitset_find_first((b), 0)
+#define bitset_find_first(...) __array_argc2(__VA_ARGS__, __bitset_find_from, __bitset_find_start, )(__VA_ARGS__)
+
+// Blocks of 64 words are counted by the fast kernel and skipped whole, then the words of the right block one by one.
+static inline size_t __bitset_select(const bitset_array* b, size_t rank) {
+    size_t n = __bitset_words(b->size), i = 0;
+    for (size_t c; i + 64 <= n && rank >= (c = __BITSET_COUNT_PICK(b->words + i, 64)); i += 64) rank -= c;
+    for (; i < n; i++) {
+        size_t c = __bitset_popcount(b->words[i]);
+        if (rank < c) return i * 64 + __BITSET_SELECT_PICK(b->words[i], (unsigned)rank);
+        rank -= c;
+    }
+    return b->size;
+}
+#define bitset_select(b, rank) __bitset_select((b), (rank))
+
+#define __BITSET_BINARY(OP) \
+static inline void __bitset_##OP(bitset_array* d, const bitset_array* a, const bitset_array* b) { \
+    size_t size = d->size < a->size ? d->size : a->size; \
+    size = size < b->size ? size : b->size; \
+    __BITSET_PICK(OP)(d->words, a->words, b->words, __bitset_words(size)); \
+    __bitset_trim(d); \
+}
+__BITSET_BINARY(and)
+__BITSET_BINARY(or)
+__BITSET_BINARY(xor)
+#define bitset_and(d, a, b) __bitset_and((d), (a), (b))
+#define bitset_or(d, a, b) __bitset_or((d), (a), (b))
+#define bitset_xor(d, a, b) __bitset_xor((d), (a), (b))
+
+// A bool is one byte holding 0 or 1, so SSE2 turns 16 of them into 16 bits with one compare and one movemask.
+static inline bitset_array* __bitset_from_bools(const bool* p, size_t n, const char* site) {
+    bitset_array* b = __bitset_new(n, site);
+    if (b == NULL) return NULL;
+    size_t i = 0;
+#ifdef FLORESTAN_X86_SIMD
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 64 <= n; i += 64) {
+        uint64_t w = 0;
+        for (unsigned k = 0; k < 4; k++) {
+            __m128i x = _mm_loadu_si128((const __m128i*)(p + i + 16 * k));
+            w |= (uint64_t)(~_mm_movemask_epi8(_mm_cmpeq_epi8(x, zero)) & 0xFFFF) << 16 * k;
+        }
+        b->words[i / 64] = w;
+    }
+#endif
+    for (; i < n; i++) b->words[i / 64] |= (uint64_t)p[i] << (i % 64);
+    return b;
+}
+#define __bitset_from_bools_n(p, n) __bitset_from_bools((p), (n), FLORESTAN_CALL_SITE)
+#define __bitset_from_bools_info(p) __bitset_from_bools_n(p, allocated_info(p).arraysize)
+#define bitset_from_bools(...) __array_argc2(__VA_ARGS__, __bitset_from_bools_n, __bitset_from_bools_info, )(__VA_ARGS__)
+
+#endif
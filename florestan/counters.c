@@ -0,0 +1,138 @@
+// Florestan's Counters
+//
+// © dongwanpianist
+//
+// The counters live in the translation units that count; this keeps a list of them, pushed once each under a spinlock
+// and never removed, so it is read without the lock, and sums them by (name, type) text when they are read.
+
+#define __FLORESTAN_COUNTERS_C
+#include "counters.h"
+#include <stdio.h>
+#include <string.h>
+
+unsigned long long __counter_clock(void) {
+    return __counter_ticks();
+}
+
+static _Atomic(counter_slot*) __counter_list;
+static atomic_flag __counter_enlisting = ATOMIC_FLAG_INIT;
+
+// Only the first count of each slot gets here; the flag keeps two threads from pushing the same slot twice.
+void __counter_enlist(counter_slot* slot) {
+    while (atomic_flag_test_and_set_explicit(&__counter_enlisting, memory_order_acquire));
+    if (!atomic_load_explicit(&slot->listed, memory_order_relaxed)) {
+        slot->next = atomic_load_explicit(&__counter_list, memory_order_relaxed);
+        atomic_store_explicit(&__counter_list, slot, memory_order_release);
+        atomic_store_explicit(&slot->listed, true, memory_order_release);
+    }
+    atomic_flag_clear_explicit(&__counter_enlisting, memory_order_release);
+}
+
+static int __counter_by_ticks(const void* a, const void* b) {
+    unsigned long long x = *(const unsigned long long*)a, y = *(const unsigned long long*)b;
+    return (x > y) - (x < y);
+}
+
+void __counter_settle(counter_slot* slot, unsigned long long* samples, size_t count) {
+    if (count) {
+        qsort(samples, count, sizeof(unsigned long long), __counter_by_ticks);
+        if (!atomic_load_explicit(&slot->listed, memory_order_acquire)) __counter_enlist(slot);
+        atomic_store_explicit(&slot->median, samples[count / 2], memory_order_relaxed);
+        atomic_store_explicit(&slot->p99, samples[count - 1 - count / 100], memory_order_relaxed);
+    }
+    free(samples);
+}
+
+static bool __counter_matches(const counter_slot* slot, const char* name, const char* type) {
+    return strcmp(slot->name, name) == 0 && (type == NULL || strcmp(slot->type, type) == 0);
+}
+
+static void __counter_sum(counter_totals* totals, const counter_slot* slot) {
+    totals->calls += atomic_load_explicit(&slot->calls, memory_order_relaxed);
+    totals->bytes += atomic_load_explicit(&slot->bytes, memory_order_relaxed);
+    totals->ticks += atomic_load_explicit(&slot->ticks, memory_order_relaxed);
+    unsigned long long median = atomic_load_explicit(&slot->median, memory_order_relaxed);
+    if (median) {
+        totals->median = median;
+        totals->p99 = atomic_load_explicit(&slot->p99, memory_order_relaxed);
+    }
+}
+
+counter_totals __counters_get(const char* name, const char* type) {
+    counter_totals totals = { 0 };
+    for (counter_slot* slot = atomic_load_explicit(&__counter_list, memory_order_acquire); slot; slot = slot->next) {
+        if (__counter_matches(slot, name, type)) __counter_sum(&totals, slot);
+    }
+    return totals;
+}
+
+void __counters_reset(void) {
+    for (counter_slot* slot = atomic_load_explicit(&__counter_list, memory_order_acquire); slot; slot = slot->next) {
+        atomic_store_explicit(&slot->calls, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->bytes, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->ticks, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->median, 0, memory_order_relaxed);
+        atomic_store_explicit(&slot->p99, 0, memory_order_relaxed);
+    }
+}
+
+typedef struct __counter_row {
+    const char* name;
+    const char* type;
+    counter_totals totals;
+} counter_row;
+
+static int __counter_rows_by_name(const void* a, const void* b) {
+    const counter_row* x = a;
+    const counter_row* y = b;
+    int order = strcmp(x->name, y->name);
+    return order ? order : strcmp(x->type, y->type);
+}
+
+// Names and types are string literals, written as they are: no quote or comma in the names given to counters_measure().
+bool __counters_dump(const char* path) {
+    size_t n = 0;
+    counter_slot* list = atomic_load_explicit(&__counter_list, memory_order_acquire);
+    for (counter_slot* slot = list; slot; slot = slot->next) n++;
+    counter_row* rows = malloc((n ? n : 1) * sizeof(counter_row));
+    if (rows == NULL) return false;
+    size_t count = 0;
+    for (counter_slot* slot = list; slot; slot = slot->next) {
+        counter_row row = { slot->name, slot->type, { 0 } };
+        __counter_sum(&row.totals, slot);
+        rows[count++] = row;
+    }
+    qsort(rows, count, sizeof(counter_row), __counter_rows_by_name);
+    size_t merged = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (merged && __counter_rows_by_name(&rows[merged - 1], &rows[i]) == 0) {
+            counter_totals* t = &rows[merged - 1].totals;
+            t->calls += rows[i].totals.calls;
+            t->bytes += rows[i].totals.bytes;
+            t->ticks += rows[i].totals.ticks;
+            if (rows[i].totals.median) {
+                t->median = rows[i].totals.median;
+                t->p99 = rows[i].totals.p99;
+            }
+        } else rows[merged++] = rows[i];
+    }
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        free(rows);
+        return false;
+    }
+    size_t length = strlen(path);
+    bool json = length >= 5 && strcmp(path + length - 5, ".json") == 0;
+    if (json) fprintf(file, "{\"unit\":\"%s\",\"counters\":[", __COUNTER_UNIT);
+    else fprintf(file, "name,type,calls,bytes,ticks,median,p99\n");
+    for (size_t i = 0; i < merged; i++) {
+        const counter_totals* t = &rows[i].totals;
+        if (json) fprintf(file, "%s\n{\"name\":\"%s\",\"type\":\"%s\",\"calls\":%llu,\"bytes\":%llu,\"ticks\":%llu,\"median\":%llu,\"p99\":%llu}",
+            i ? "," : "", rows[i].name, rows[i].type, t->calls, t->bytes, t->ticks, t->median, t->p99);
+        else fprintf(file, "%s,%s,%llu,%llu,%llu,%llu,%llu\n", rows[i].name, rows[i].type, t->calls, t->bytes, t->ticks, t->median, t->p99);
+    }
+    if (json) fprintf(file, "\n]}\n");
+    free(rows);
+    return fclose(file) == 0;
+}
@@ -0,0 +1,130 @@
+// Florestan's Counters
+//
+// © dongwanpianist
+//
+// Calls, bytes and ticks of the library's bulk entry points, to have a baseline to hold a new version against.
+// Every hooked function keeps one static counter per element type, and adds to it with three relaxed atomic additions
+// and two reads of the clock; counters of the same name from different translation units are summed when read.
+// Ticks are TSC cycles on x86 (__rdtsc), nanoseconds of timespec_get() elsewhere.
+//
+// #define FLORESTAN_COUNTERS when building your program (link florestan/counters.c); without it, every hook compiles to nothing.
+// counters_measure() and the functions below are there either way, and need florestan/counters.c.
+//
+// 1. hooked entry points, each counted by element type ("int", "float <- int", ...)
+//      * array_sum/min/max/minmax/dot, array_sort, array_convert(_saturate), array_prefix_sum/histogram/partition,
+//        array_compress/decompress, array_transpose/interleave/deinterleave, hash_map_insert_batch/find_batch
+//      * bytes are those of the elements read (and written, for the conversions and copies)
+//      * allocated_info() and alloc_sizeof() with FLORESTAN_TRACKED_ALLOC or FLORESTAN_SIZED_ALLOC, counted by calls;
+//        otherwise they are a few constant expressions and one OS call that nothing can hook, as are __sizeof() and printtype()
+// 2. counters_measure(NAME, REPETITIONS, BYTES, STATEMENT)
+//      * runs STATEMENT REPETITIONS / 8 + 1 times to warm up, then REPETITIONS times with the clock read around each,
+//        and keeps the median and the 99th percentile of those, with the calls, BYTES per call and ticks, under NAME
+//      * NAME is a string literal; STATEMENT may hold commas, and may call hooked functions, which count as well
+// 3. counters_get(NAME, TYPE) -> counter_totals
+//      .calls, .bytes, .ticks  (unsigned long long) summed over every counter of NAME, and of TYPE unless TYPE is NULL
+//      .median, .p99           (unsigned long long) ticks of one call, from the last counters_measure() of NAME, 0 for hooks
+// 4. counters_dump(FILE_PATH) -> bool
+//      * one row per (name, type) sorted by name: JSON when FILE_PATH ends with ".json", CSV otherwise
+//        (name,type,calls,bytes,ticks,median,p99)
+//      * false when the file cannot be written
+// 5. counters_reset()
+//      * zeroes every counter, for a run to count only itself
+
+#ifndef FLORESTAN_COUNTERS_H
+#define FLORESTAN_COUNTERS_H
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+    #define __COUNTER_UNIT "tsc"
+#else
+    #define __COUNTER_UNIT "ns"
+#endif
+
+typedef struct __counter_totals {
+    unsigned long long calls;
+    unsigned long long bytes;
+    unsigned long long ticks;
+    unsigned long long median;
+    unsigned long long p99;
+} counter_totals;
+
+// One per hook and translation unit, put on the global list the first time it counts.
+typedef struct __counter_slot {
+    const char* name;
+    const char* type;
+    atomic_ullong calls;
+    atomic_ullong bytes;
+    atomic_ullong ticks;
+    atomic_ullong median;
+    atomic_ullong p99;
+    atomic_bool listed;
+    struct __counter_slot* next;
+} counter_slot;
+
+void __counter_enlist(counter_slot* slot);
+void __counter_settle(counter_slot* slot, unsigned long long* samples, size_t count);
+counter_totals __counters_get(const char* name, const char* type);
+bool __counters_dump(const char* path);
+void __counters_reset(void);
+#define counters_get(name, type) __counters_get((name), (type))
+#define counters_dump(path) __counters_dump(path)
+#define counters_reset() __counters_reset()
+
+// The clock is read inline only where something counts (and in counters.c); every other translation unit
+// that includes the library is kept clear of <x86intrin.h>, and counters_measure() reads it through __counter_clock().
+unsigned long long __counter_clock(void);
+#if defined(FLORESTAN_COUNTERS) || defined(__FLORESTAN_COUNTERS_C)
+    #if defined(__x86_64__) || defined(__i386__)
+        #include <x86intrin.h>
+    #endif
+static inline unsigned long long __counter_ticks(void) {
+    #if defined(__x86_64__) || defined(__i386__)
+    return (unsigned long long)__rdtsc();
+    #else
+    struct timespec now;
+    timespec_get(&now, TIME_UTC);
+    return (unsigned long long)now.tv_sec * 1000000000ull + (unsigned long long)now.tv_nsec;
+    #endif
+}
+#else
+    #define __counter_ticks() __counter_clock()
+#endif
+
+static inline void __counter_add(counter_slot* slot, unsigned long long calls, unsigned long long bytes, unsigned long long ticks) {
+    if (!atomic_load_explicit(&slot->listed, memory_order_acquire)) __counter_enlist(slot);
+    atomic_fetch_add_explicit(&slot->calls, calls, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->bytes, bytes, memory_order_relaxed);
+    atomic_fetch_add_explicit(&slot->ticks, ticks, memory_order_relaxed);
+}
+
+// __COUNTER_BEGIN opens the function body, before anything else; __COUNTER_END goes right before its only return.
+#ifdef FLORESTAN_COUNTERS
+    #define __COUNTER_BEGIN(label, type_label) \
+        static counter_slot __counter_here = { .name = label, .type = type_label }; \
+        unsigned long long __counter_start = __counter_ticks();
+    #define __COUNTER_END(bytes) __counter_add(&__counter_here, 1, (bytes), __counter_ticks() - __counter_start)
+#else
+    #define __COUNTER_BEGIN(label, type_label)
+    #define __COUNTER_END(bytes) ((void)0)
+#endif
+
+#define counters_measure(label, repetitions, bytes, ...) do { \
+    static counter_slot __counter_measured = { .name = label, .type = "" }; \
+    size_t __counter_count = (repetitions); \
+    unsigned long long __counter_bytes = (bytes); \
+    unsigned long long* __counter_samples = (unsigned long long*)malloc((__counter_count ? __counter_count : 1) * sizeof(unsigned long long)); \
+    for (size_t __counter_i = 0; __counter_i < __counter_count / 8 + 1; __counter_i++) { __VA_ARGS__; } \
+    for (size_t __counter_i = 0; __counter_i < __counter_count; __counter_i++) { \
+        unsigned long long __counter_start = __counter_ticks(); \
+        { __VA_ARGS__; } \
+        unsigned long long __counter_spent = __counter_ticks() - __counter_start; \
+        if (__counter_samples) __counter_samples[__counter_i] = __counter_spent; \
+        __counter_add(&__counter_measured, 1, __counter_bytes, __counter_spent); \
+    } \
+    __counter_settle(&__counter_measured, __counter_samples, __counter_samples ? __counter_count : 0); \
+} while (0)
+
+#endif
@@ -0,0 +1,210 @@
+// Florestan's Format
+//
+// © dongwanpianist
+//
+// Type-generic number to text conversion without printf: no format string to parse, no locale, no stream lock.
+// Integers are written two digits at a time from a table of the 100 digit pairs.
+// float and double are written with the fewest digits that still read back (strtod/strtof) to the very same value,
+// found with the Ryu algorithm (Ulf Adams, 2018) in florestan/format.c.
+//
+// Build florestan/format.c with your program and link with -lpthread.
+//
+// 1. format_value(CHAR_BUFFER, VALUE) -> size_t
+//      * writes VALUE and a terminating '\0' into CHAR_BUFFER, which needs FLORESTAN_FORMAT_MAX bytes,
+//        and returns the length without the '\0'
+//      * bool -> true/false, char -> the character itself, other integers -> decimal,
+//        float/double -> shortest digits, as plain decimals from 1e-6 up to (not including) 1e21 and as 1.5e-7 / 1e+21 outside,
+//        nan, inf, -inf, -0; any pointer -> 0x hexadecimal
+//      * long double is written like double when it fits one exactly; otherwise with its full precision,
+//        the text of %.*Lg with LDBL_DECIMAL_DIG (21 digits for the x87 format), but with a '.' in every locale
+// 2. format_buffer     (typedef struct __format_buffer) a growable text buffer; start it empty with = {0}
+//      .data           (char*) always '\0'-terminated once something was written
+//      .length         (size_t)
+//      .capacity       (size_t)
+// 3. format_append(FORMAT_BUFFER_POINTER, VALUE) -> bool
+// 4. format_array(FORMAT_BUFFER_POINTER, POINTER_OR_ARRAY [, COUNT [, SEPARATOR]]) -> bool
+//      * appends every element, with SEPARATOR (a string, ", " when omitted) between two elements
+//      * COUNT is allocated_info(POINTER_OR_ARRAY).arraysize when omitted
+//      * false when out of memory, with the elements that fitted already appended
+// 5. format_write(FORMAT_BUFFER_POINTER, FILE*) -> bool
+//      * writes out the text with one fwrite and empties the buffer
+// 6. format_free(FORMAT_BUFFER_POINTER)
+// 7. format_thread_buffer() -> format_buffer*
+//      * one buffer per thread, kept between calls and freed when the thread exits;
+//        empty it yourself (.length = 0) before reusing it
+
+#ifndef FLORESTAN_FORMAT_H
+#define FLORESTAN_FORMAT_H
+#include "type_traits.h"
+#include "vector.h"
+#include <stdint.h>
+#include <string.h>
+
+#define FLORESTAN_FORMAT_MAX 48
+
+typedef struct __format_buffer {
+    char* data;
+    size_t length;
+    size_t capacity;
+} format_buffer;
+
+size_t __format_float(char* out, float value);
+size_t __format_double(char* out, double value);
+size_t __format_ldouble(char* out, long double value);
+format_buffer* __format_thread_buffer(void);
+#define format_thread_buffer() __format_thread_buffer()
+
+static const char __format_pairs[200] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829" "30313233343536373839" "40414243444546474849"
+    "50515253545556575859" "60616263646566676869" "70717273747576777879" "80818283848586878889" "90919293949596979899";
+
+// Decimal digits of v (1 for 0).
+static inline size_t __format_length10(uint64_t v) {
+    static const uint64_t powers[20] = { 1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u,
+        1000000000u, 10000000000u, 100000000000u, 1000000000000u, 10000000000000u, 100000000000000u, 1000000000000000u,
+        10000000000000000u, 100000000000000000u, 1000000000000000000u, 10000000000000000000u };
+#if defined(__GNUC__) || defined(__clang__)
+    size_t guess = (size_t)((64 - __builtin_clzll(v | 1)) * 1233 >> 12); // floor(log10(2^bits))
+    return guess + 1 - ((v | 1) < powers[guess]);
+#else
+    size_t length = 1;
+    while (length < 20 && v >= powers[length]) length++;
+    return length;
+#endif
+}
+
+// Writes exactly LENGTH digits of v, the last one at out[LENGTH - 1].
+static inline void __format_digits(char* out, uint64_t v, size_t length) {
+    char* end = out + length;
+    while (v >= 100) {
+        uint64_t pair = v % 100;
+        v /= 100;
+        end -= 2;
+        memcpy(end, __format_pairs + 2 * pair, 2);
+    }
+    if (v >= 10) {
+        end -= 2;
+        memcpy(end, __format_pairs + 2 * v, 2);
+    } else {
+        *--end = (char)('0' + v);
+    }
+}
+
+static inline size_t __format_unsigned(char* out, uint64_t v) {
+    size_t length = __format_length10(v);
+    __format_digits(out, v, length);
+    return length;
+}
+static inline size_t __format_signed(char* out, int64_t v) {
+    if (v >= 0) return __format_unsigned(out, (uint64_t)v);
+    *out = '-';
+    return 1 + __format_unsigned(out + 1, 0 - (uint64_t)v);
+}
+
+static inline size_t __format_bool(char* out, bool value) {
+    memcpy(out, value ? "true" : "false", 5);
+    return value ? 4 : 5;
+}
+static inline size_t __format_char(char* out, char value) {
+    *out = value;
+    return 1;
+}
+static inline size_t __format_pointer(char* out, const void* value) {
+    uintptr_t v = (uintptr_t)value;
+    size_t length = 1;
+    while (length < sizeof v * 2 && v >> 4 * length) length++;
+    out[0] = '0';
+    out[1] = 'x';
+    for (size_t i = 0; i < length; i++) out[2 + length - 1 - i] = "0123456789abcdef"[(v >> 4 * i) & 0xF];
+    return 2 + length;
+}
+
+// NAME, TYPE, KERNEL: every supported element type, and how one value of it is written
+#define __FORMAT_TYPES(X) \
+    X(bool,    bool,               __format_bool) \
+    X(char,    char,               __format_char) \
+    X(schar,   signed char,        __format_signed) \
+    X(uchar,   unsigned char,      __format_unsigned) \
+    X(short,   short,              __format_signed) \
+    X(ushort,  unsigned short,     __format_unsigned) \
+    X(int,     int,                __format_signed) \
+    X(uint,    unsigned int,       __format_unsigned) \
+    X(long,    long,               __format_signed) \
+    X(ulong,   unsigned long,      __format_unsigned) \
+    X(llong,   long long,          __format_signed) \
+    X(ullong,  unsigned long long, __format_unsigned) \
+    X(float,   float,              __format_float) \
+    X(double,  double,             __format_double) \
+    X(ldouble, long double,        __format_ldouble)
+
+#define __FORMAT_FUNCTIONS(NAME, T, KERNEL) \
+static inline size_t __format_value_##NAME(char* out, T value) { \
+    size_t length = KERNEL(out, value); \
+    out[length] = '\0'; \
+    return length; \
+} \
+static inline bool __format_append_##NAME(format_buffer* b, T value) { \
+    if (!vector_reserve(b, b->length + FLORESTAN_FORMAT_MAX)) return false; \
+    b->length += __format_value_##NAME(b->data + b->length, value); \
+    return true; \
+} \
+static inline bool __format_array_##NAME(format_buffer* b, const T* p, size_t n, const char* separator) { \
+    size_t gap = strlen(separator); \
+    if (!vector_reserve(b, b->length + 1)) return false; \
+    b->data[b->length] = '\0'; \
+    for (size_t i = 0; i < n;) { \
+        size_t block = n - i < 4096 ? n - i : 4096; \
+        if (!vector_reserve(b, b->length + block * (FLORESTAN_FORMAT_MAX + gap) + 1)) return false; \
+        char* out = b->data + b->length; \
+        for (size_t end = i + block; i < end; i++) { \
+            if (i) { memcpy(out, separator, gap); out += gap; } \
+            out += KERNEL(out, p[i]); \
+        } \
+        *out = '\0'; \
+        b->length = (size_t)(out - b->data); \
+    } \
+    return true; \
+}
+__FORMAT_TYPES(__FORMAT_FUNCTIONS)
+
+static inline size_t __format_value_pointer(char* out, const void* value) {
+    size_t length = __format_pointer(out, value);
+    out[length] = '\0';
+    return length;
+}
+static inline bool __format_append_pointer(format_buffer* b, const void* value) {
+    if (!vector_reserve(b, b->length + FLORESTAN_FORMAT_MAX)) return false;
+    b->length += __format_value_pointer(b->data + b->length, value);
+    return true;
+}
+
+// Anything that is not a fundamental type is taken as a pointer, so a struct VALUE does not compile.
+#define __FORMAT_VALUE_ARM(NAME, T, KERNEL) T: __format_value_##NAME,
+#define __FORMAT_APPEND_ARM(NAME, T, KERNEL) T: __format_append_##NAME,
+#define __FORMAT_ARRAY_ARM(NAME, T, KERNEL) T*: __format_array_##NAME, const T*: __format_array_##NAME,
+#define __format_value_generic(x) _Generic((x), __FORMAT_TYPES(__FORMAT_VALUE_ARM) default: __format_value_pointer)
+#define __format_append_generic(x) _Generic((x), __FORMAT_TYPES(__FORMAT_APPEND_ARM) default: __format_append_pointer)
+#define __format_array_generic(p) _Generic((p), __FORMAT_TYPES(__FORMAT_ARRAY_ARM) default: NULL)
+
+#define format_value(out, x) __format_value_generic(x)((out), (x))
+#define format_append(b, x) __format_append_generic(x)((b), (x))
+
+#ifndef __array_argc4
+    #define __array_argc4(_1, _2, _3, _4, NAME, ...) NAME
+#endif
+#define __format_array_separator(b, p, n, separator) __format_array_generic(p)((b), (p), (n), (separator))
+#define __format_array_n(b, p, n) __format_array_separator(b, p, n, ", ")
+#define __format_array_info(b, p) __format_array_separator(b, p, allocated_info(p).arraysize, ", ")
+#define format_array(...) __array_argc4(__VA_ARGS__, __format_array_separator, __format_array_n, __format_array_info, )(__VA_ARGS__)
+
+#define format_write(b, file) __format_write((b), (file))
+static inline bool __format_write(format_buffer* b, FILE* file) {
+    bool written = b->length == 0 || fwrite(b->data, 1, b->length, file) == b->length;
+    b->length = 0;
+    if (b->data) b->data[0] = '\0';
+    return written;
+}
+
+#define format_free(b) vector_free(b)
+
+#endif
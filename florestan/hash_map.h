@@ -0,0 +1,369 @@
+// Florestan's Hash Map
+//
+// © dongwanpianist
+//
+// An open-addressing hash map from any fundamental key type to any value type, laid out like Abseil's SwissTable.
+// Keys and values sit inline in two arrays, and one control byte per slot says whether the slot is empty, deleted,
+// or full, in which case it holds 7 bits of the key's hash. A lookup loads the 16 control bytes from the key's home slot on
+// and compares them all at once (SSE2, see <florestan/simd.h>), so it only reads the keys whose 7 bits match,
+// almost always just the one it is looking for; an empty byte among the 16 ends the search.
+// The hash function and the key comparison are picked by _Generic from the key type, so they inline: no void*, no callbacks.
+// The batch versions hash a few keys ahead and prefetch their control bytes and slots, so the cache misses of
+// consecutive keys overlap instead of coming one after another.
+//
+// 1. hash_map(KEY_TYPE, VALUE_TYPE) -> an anonymous struct type; start it empty with = {0}
+//      .keys           (KEY_TYPE*) the key of every slot, valid where hash_map_occupied() is true
+//      .values         (VALUE_TYPE*) the value of every slot, likewise
+//      .control        (unsigned char*) the control bytes
+//      .count          (size_t) entries
+//      .capacity       (size_t) slots, 0 or a power of two of at least 16; at most 7/8 of them are used
+//      .growth         (size_t) entries that still fit before the next rehash
+// 2. hash_map_insert(MAP_POINTER, KEY, VALUE) -> bool
+//      * adds KEY, or gives an existing KEY the new VALUE; false when out of memory, and the map is left as it was
+// 3. hash_map_find(MAP_POINTER, KEY) -> size_t
+//      * the slot of KEY, so its value is MAP.values[slot]; MAP.capacity when KEY is not there
+//    hash_map_contains(MAP_POINTER, KEY) -> bool
+// 4. hash_map_erase(MAP_POINTER, KEY) -> bool
+//      * false when KEY was not there
+// 5. hash_map_insert_batch(MAP_POINTER, KEYS, VALUES [, COUNT]) -> bool
+//      * inserts KEYS[i] with VALUES[i] in order, as hash_map_insert() would; false when out of memory,
+//        or when the elements of VALUES are not as large as VALUE_TYPE (nothing is inserted then)
+//    hash_map_find_batch(MAP_POINTER, KEYS, SLOTS [, COUNT]) -> size_t
+//      * SLOTS[i] = hash_map_find(MAP_POINTER, KEYS[i]) for size_t SLOTS, and returns how many were found
+//      * COUNT is allocated_info(KEYS).arraysize when omitted
+// 6. hash_map_reserve(MAP_POINTER, COUNT) -> bool
+//      * makes room for COUNT entries in total, so inserting up to them does not rehash
+// 7. hash_map_occupied(MAP_POINTER, SLOT) -> bool
+//      * for walking the entries: for (size_t i = 0; i < map.capacity; i++) if (hash_map_occupied(&map, i)) ...
+// 8. hash_map_free(MAP_POINTER)
+//      * the map is empty (= {0}) again afterwards
+//
+// supported key types: char, signed char, unsigned char, short, unsigned short, int, unsigned int,
+// long, unsigned long, long long, unsigned long long, float, double, long double.
+// Floating keys compare with ==, so 0.0 and -0.0 are one key, and a NaN key is never found again.
+// MAP_POINTER is evaluated more than once; KEY, VALUE and COUNT are evaluated once.
+// Inserting, erasing and rehashing move slots around, so a slot from hash_map_find() lasts until the next change.
+
+#ifndef FLORESTAN_HASH_MAP_H
+#define FLORESTAN_HASH_MAP_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include "counters.h"
+#include "simd.h"
+#include <float.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef FLORESTAN_HASH_MAP_AHEAD
+    #define FLORESTAN_HASH_MAP_AHEAD 8 // keys hashed and prefetched ahead in the batch versions
+#endif
+#define __HASH_MAP_GROUP 16
+#define __HASH_MAP_EMPTY ((unsigned char)0x80)
+#define __HASH_MAP_DELETED ((unsigned char)0xFE)
+#define __HASH_MAP_ROUND(n) (((n) + 63) / 64 * 64)
+
+#if defined(__GNUC__) || defined(__clang__)
+    #define __hash_map_prefetch(p) __builtin_prefetch(p)
+#else
+    #define __hash_map_prefetch(p) ((void)0)
+#endif
+
+#define hash_map(K, V) struct { K* keys; V* values; unsigned char* control; size_t count; size_t capacity; size_t growth; }
+
+// Every hash_map(K, V) has this layout, whatever K and V are, and is read and written through memcpy as one.
+typedef struct __hash_map_layout {
+    unsigned char* keys;
+    unsigned char* values;
+    unsigned char* control;
+    size_t count;
+    size_t capacity;
+    size_t growth;
+} __hash_map_layout;
+
+// The hash: the low 7 bits go to the control byte, the rest choose the home slot.
+static inline uint64_t __hash_map_mix(uint64_t x) {
+    x ^= x >> 32;
+    x *= 0x9E3779B97F4A7C15u;
+    return x ^ (x >> 29);
+}
+#define __hash_map_hash_integer(x) __hash_map_mix((uint64_t)(x))
+static inline uint64_t __hash_map_hash_float(float x) {
+    uint32_t bits;
+    x = x == 0 ? 0.0f : x; // -0.0 == 0.0
+    memcpy(&bits, &x, sizeof bits);
+    return __hash_map_mix(bits);
+}
+static inline uint64_t __hash_map_hash_double(double x) {
+    uint64_t bits;
+    x = x == 0 ? 0.0 : x;
+    memcpy(&bits, &x, sizeof bits);
+    return __hash_map_mix(bits);
+}
+// The bytes of a long double include padding, so it is hashed as the nearest double; values out of its range share two hashes.
+static inline uint64_t __hash_map_hash_ldouble(long double x) {
+    if (x > DBL_MAX || x < -DBL_MAX) return __hash_map_mix(x > 0 ? 1 : 2);
+    return __hash_map_hash_double((double)x);
+}
+
+// NAME, TYPE, HASH
+#define __HASH_MAP_TYPES(X, ...) \
+    X(char,    char,               __hash_map_hash_integer, __VA_ARGS__) \
+    X(schar,   signed char,        __hash_map_hash_integer, __VA_ARGS__) \
+    X(uchar,   unsigned char,      __hash_map_hash_integer, __VA_ARGS__) \
+    X(short,   short,              __hash_map_hash_integer, __VA_ARGS__) \
+    X(ushort,  unsigned short,     __hash_map_hash_integer, __VA_ARGS__) \
+    X(int,     int,                __hash_map_hash_integer, __VA_ARGS__) \
+    X(uint,    unsigned int,       __hash_map_hash_integer, __VA_ARGS__) \
+    X(long,    long,               __hash_map_hash_integer, __VA_ARGS__) \
+    X(ulong,   unsigned long,      __hash_map_hash_integer, __VA_ARGS__) \
+    X(llong,   long long,          __hash_map_hash_integer, __VA_ARGS__) \
+    X(ullong,  unsigned long long, __hash_map_hash_integer, __VA_ARGS__) \
+    X(float,   float,              __hash_map_hash_float,   __VA_ARGS__) \
+    X(double,  double,             __hash_map_hash_double,  __VA_ARGS__) \
+    X(ldouble, long double,        __hash_map_hash_ldouble, __VA_ARGS__)
+
+// Bit i of a match is set for control[i] of the 16 from GROUP on.
+#ifdef FLORESTAN_X86_SIMD
+static inline unsigned __hash_map_match(const unsigned char* group, unsigned char h2) {
+    __m128i g = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(g, _mm_set1_epi8((char)h2)));
+}
+// Empty and deleted are the only control bytes with the top bit set.
+static inline unsigned __hash_map_match_free(const unsigned char* group) {
+    return (unsigned)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)group));
+}
+#else
+static inline unsigned __hash_map_match(const unsigned char* group, unsigned char h2) {
+    unsigned m = 0;
+    for (unsigned i = 0; i < __HASH_MAP_GROUP; i++) m |= (unsigned)(group[i] == h2) << i;
+    return m;
+}
+static inline unsigned __hash_map_match_free(const unsigned char* group) {
+    unsigned m = 0;
+    for (unsigned i = 0; i < __HASH_MAP_GROUP; i++) m |= (unsigned)(group[i] >> 7) << i;
+    return m;
+}
+#endif
+static inline unsigned __hash_map_ctz(unsigned m) { // m != 0
+#if defined(__GNUC__) || defined(__clang__)
+    return (unsigned)__builtin_ctz(m);
+#else
+    unsigned n = 0;
+    while (!(m & 1)) { m >>= 1; n++; }
+    return n;
+#endif
+}
+
+static inline size_t __hash_map_home(const __hash_map_layout* t, uint64_t h) { return (size_t)(h >> 7) & (t->capacity - 1); }
+
+// The first GROUP control bytes are repeated after the last one, so a group never wraps around.
+static inline void __hash_map_set_control(__hash_map_layout* t, size_t i, unsigned char c) {
+    t->control[i] = c;
+    if (i < __HASH_MAP_GROUP) t->control[t->capacity + i] = c;
+}
+
+// The groups are probed at the home slot + 16, + 48, + 96, ... (triangular steps), which visits every group of a power-of-two table.
+// A free slot for hash H, marked full; there is always one, because growth never lets the table fill up.
+static inline size_t __hash_map_claim(__hash_map_layout* t, uint64_t h) {
+    size_t mask = t->capacity - 1, pos = __hash_map_home(t, h);
+    for (size_t step = __HASH_MAP_GROUP;; pos = (pos + step) & mask, step += __HASH_MAP_GROUP) {
+        unsigned m = __hash_map_match_free(t->control + pos);
+        if (m) {
+            size_t i = (pos + __hash_map_ctz(m)) & mask;
+            if (t->control[i] == __HASH_MAP_EMPTY) t->growth--;
+            __hash_map_set_control(t, i, (unsigned char)(h & 0x7F));
+            t->count++;
+            return i;
+        }
+    }
+}
+
+// Slots of size KEYSIZE and VALUESIZE, all in one block: the control bytes, then the keys, then the values, each on a cache line.
+static inline bool __hash_map_allocate(__hash_map_layout* t, size_t capacity, size_t keysize, size_t valuesize, const char* site) {
+    if (capacity > (SIZE_MAX / 4) / (keysize + valuesize + 1)) return false;
+    size_t control = __HASH_MAP_ROUND(capacity + __HASH_MAP_GROUP), keys = __HASH_MAP_ROUND(capacity * keysize);
+    size_t size = control + keys + __HASH_MAP_ROUND(capacity * valuesize);
+    unsigned char* block = aligned_alloc(64, size);
+    if (block == NULL) return false;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(block, size, 1, allocated, NULL);
+#endif
+    __heap_profile_note(size, keysize + valuesize, allocated, site);
+    memset(block, __HASH_MAP_EMPTY, capacity + __HASH_MAP_GROUP);
+    *t = (__hash_map_layout){ .keys = block + control, .values = block + control + keys, .control = block,
+        .count = 0, .capacity = capacity, .growth = capacity - capacity / 8 };
+    return true;
+}
+static inline void __hash_map_release(unsigned char* control) {
+    if (control == NULL) return;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_remove(control);
+#endif
+    free(control);
+}
+
+// The capacity for COUNT entries, 0 when that is too many.
+static inline size_t __hash_map_capacity(size_t count) {
+    size_t c = __HASH_MAP_GROUP;
+    while (c - c / 8 < count && c <= SIZE_MAX / 4) c *= 2;
+    return c - c / 8 < count ? 0 : c;
+}
+
+#define __HASH_MAP_FUNCTIONS(NAME, T, HASH, ...) \
+static inline size_t __hash_map_probe_##NAME(const __hash_map_layout* t, T key, uint64_t h) { \
+    const T* keys = (const T*)t->keys; \
+    size_t mask = t->capacity - 1, pos = __hash_map_home(t, h); \
+    for (size_t step = __HASH_MAP_GROUP;; pos = (pos + step) & mask, step += __HASH_MAP_GROUP) { \
+        const unsigned char* group = t->control + pos; \
+        for (unsigned m = __hash_map_match(group, (unsigned char)(h & 0x7F)); m; m &= m - 1) { \
+            size_t i = (pos + __hash_map_ctz(m)) & mask; \
+            if (keys[i] == key) return i; \
+        } \
+        if (__hash_map_match(group, __HASH_MAP_EMPTY)) return t->capacity; \
+    } \
+} \
+static inline size_t __hash_map_find_##NAME(const void* map, T key) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    return t.count ? __hash_map_probe_##NAME(&t, key, HASH(key)) : t.capacity; \
+} \
+/* The slot of KEY, claimed for it when it is new; growth must be at least 1. */ \
+static inline size_t __hash_map_place_##NAME(__hash_map_layout* t, T key, uint64_t h) { \
+    size_t i = __hash_map_probe_##NAME(t, key, h); \
+    if (i < t->capacity) return i; \
+    i = __hash_map_claim(t, h); \
+    ((T*)t->keys)[i] = key; \
+    return i; \
+} \
+static inline bool __hash_map_rehash_##NAME(__hash_map_layout* t, size_t valuesize, size_t capacity, const char* site) { \
+    __hash_map_layout fresh; \
+    if (!__hash_map_allocate(&fresh, capacity, sizeof(T), valuesize, site)) return false; \
+    for (size_t i = 0; i < t->capacity; i++) { \
+        if (t->control[i] & 0x80) continue; \
+        T key = ((const T*)t->keys)[i]; \
+        size_t j = __hash_map_claim(&fresh, HASH(key)); \
+        ((T*)fresh.keys)[j] = key; \
+        memcpy(fresh.values + j * valuesize, t->values + i * valuesize, valuesize); \
+    } \
+    __hash_map_release(t->control); \
+    *t = fresh; \
+    return true; \
+} \
+/* Deleted slots count against growth, so a table full of them is rehashed at the same capacity to clear them. */ \
+static inline bool __hash_map_make_room_##NAME(__hash_map_layout* t, size_t valuesize, size_t count, const char* site) { \
+    if (count <= t->count + t->growth) return true; \
+    size_t capacity = __hash_map_capacity(count); \
+    if (capacity == 0) return false; \
+    return __hash_map_rehash_##NAME(t, valuesize, capacity > t->capacity ? capacity : t->capacity, site); \
+} \
+static inline bool __hash_map_reserve_##NAME(void* map, size_t valuesize, size_t count, const char* site) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    if (!__hash_map_make_room_##NAME(&t, valuesize, count, site)) return false; \
+    memcpy(map, &t, sizeof t); \
+    return true; \
+} \
+/* Only after hash_map_reserve() for one more entry. */ \
+static inline size_t __hash_map_slot_##NAME(void* map, T key) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    size_t i = __hash_map_place_##NAME(&t, key, HASH(key)); \
+    memcpy(map, &t, sizeof t); \
+    return i; \
+} \
+static inline bool __hash_map_erase_##NAME(void* map, T key) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    size_t i = t.count ? __hash_map_probe_##NAME(&t, key, HASH(key)) : t.capacity; \
+    if (i == t.capacity) return false; \
+    __hash_map_set_control(&t, i, __HASH_MAP_DELETED); \
+    t.count--; \
+    memcpy(map, &t, sizeof t); \
+    return true; \
+} \
+/* HASHES keeps the next AHEAD keys' hashes, whose home groups and slots are already on their way into the cache. */ \
+static inline bool __hash_map_insert_many_##NAME(void* map, size_t valuesize, const T* keys, const void* values, size_t sourcesize, size_t n, const char* site) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    if (sourcesize != valuesize || n > SIZE_MAX - t.count) return false; \
+    if (!__hash_map_make_room_##NAME(&t, valuesize, t.count + n, site)) return false; \
+    uint64_t hashes[FLORESTAN_HASH_MAP_AHEAD]; \
+    for (size_t i = 0; i < n && i < FLORESTAN_HASH_MAP_AHEAD; i++) hashes[i] = HASH(keys[i]); \
+    for (size_t i = 0; i < n; i++) { \
+        uint64_t h = hashes[i % FLORESTAN_HASH_MAP_AHEAD]; \
+        if (i + FLORESTAN_HASH_MAP_AHEAD < n) { \
+            uint64_t next = hashes[i % FLORESTAN_HASH_MAP_AHEAD] = HASH(keys[i + FLORESTAN_HASH_MAP_AHEAD]); \
+            size_t home = __hash_map_home(&t, next); \
+            __hash_map_prefetch(t.control + home); \
+            __hash_map_prefetch((T*)t.keys + home); \
+            __hash_map_prefetch(t.values + home * valuesize); \
+        } \
+        size_t slot = __hash_map_place_##NAME(&t, keys[i], h); \
+        memcpy(t.values + slot * valuesize, (const unsigned char*)values + i * valuesize, valuesize); \
+    } \
+    memcpy(map, &t, sizeof t); \
+    return true; \
+} \
+static inline size_t __hash_map_find_many_##NAME(const void* map, const T* keys, size_t* slots, size_t n) { \
+    __hash_map_layout t; \
+    memcpy(&t, map, sizeof t); \
+    if (t.count == 0) { \
+        for (size_t i = 0; i < n; i++) slots[i] = t.capacity; \
+        return 0; \
+    } \
+    uint64_t hashes[FLORESTAN_HASH_MAP_AHEAD]; \
+    size_t found = 0; \
+    for (size_t i = 0; i < n && i < FLORESTAN_HASH_MAP_AHEAD; i++) hashes[i] = HASH(keys[i]); \
+    for (size_t i = 0; i < n; i++) { \
+        uint64_t h = hashes[i % FLORESTAN_HASH_MAP_AHEAD]; \
+        if (i + FLORESTAN_HASH_MAP_AHEAD < n) { \
+            uint64_t next = hashes[i % FLORESTAN_HASH_MAP_AHEAD] = HASH(keys[i + FLORESTAN_HASH_MAP_AHEAD]); \
+            size_t home = __hash_map_home(&t, next); \
+            __hash_map_prefetch(t.control + home); \
+            __hash_map_prefetch((const T*)t.keys + home); \
+        } \
+        slots[i] = __hash_map_probe_##NAME(&t, keys[i], h); \
+        found += slots[i] < t.capacity; \
+    } \
+    return found; \
+} \
+static inline bool __hash_map_insert_batch_##NAME(void* map, size_t valuesize, const T* keys, const void* values, size_t sourcesize, size_t n, const char* site) { \
+    __COUNTER_BEGIN("hash_map_insert_batch", #T) \
+    bool inserted = __hash_map_insert_many_##NAME(map, valuesize, keys, values, sourcesize, n, site); \
+    __COUNTER_END(n * (sizeof(T) + valuesize)); \
+    return inserted; \
+} \
+static inline size_t __hash_map_find_batch_##NAME(const void* map, const T* keys, size_t* slots, size_t n) { \
+    __COUNTER_BEGIN("hash_map_find_batch", #T) \
+    size_t found = __hash_map_find_many_##NAME(map, keys, slots, n); \
+    __COUNTER_END(n * (sizeof(T) + sizeof(size_t))); \
+    return found; \
+}
+__HASH_MAP_TYPES(__HASH_MAP_FUNCTIONS, )
+
+#define __HASH_MAP_ARM(NAME, T, HASH, OP) T*: __hash_map_##OP##_##NAME,
+#define __hash_map_generic(OP, m) _Generic(((m)->keys), __HASH_MAP_TYPES(__HASH_MAP_ARM, OP) default: NULL)
+
+#define hash_map_reserve(m, count) __hash_map_generic(reserve, m)((void*)(m), sizeof(*(m)->values), (count), FLORESTAN_CALL_SITE)
+#define hash_map_insert(m, key, value) \
+    (hash_map_reserve((m), (m)->count + 1) ? ((m)->values[__hash_map_generic(slot, m)((void*)(m), (key))] = (value), true) : false)
+#define hash_map_find(m, key) __hash_map_generic(find, m)((const void*)(m), (key))
+#define hash_map_contains(m, key) (hash_map_find((m), (key)) < (m)->capacity)
+#define hash_map_erase(m, key) __hash_map_generic(erase, m)((void*)(m), (key))
+#define hash_map_occupied(m, slot) ((m)->control[slot] < 0x80)
+
+#ifndef __array_argc4
+    #define __array_argc4(_1, _2, _3, _4, NAME, ...) NAME
+#endif
+#define __hash_map_insert_batch_n(m, key_array, value_array, n) __hash_map_generic(insert_batch, m)((void*)(m), sizeof(*(m)->values), \
+    (key_array), (const void*)(value_array), sizeof(*(value_array)), (n), FLORESTAN_CALL_SITE)
+#define __hash_map_insert_batch_info(m, key_array, value_array) __hash_map_insert_batch_n(m, key_array, value_array, allocated_info(key_array).arraysize)
+#define hash_map_insert_batch(...) __array_argc4(__VA_ARGS__, __hash_map_insert_batch_n, __hash_map_insert_batch_info, , )(__VA_ARGS__)
+#define __hash_map_find_batch_n(m, key_array, slots, n) __hash_map_generic(find_batch, m)((const void*)(m), (key_array), (slots), (n))
+#define __hash_map_find_batch_info(m, key_array, slots) __hash_map_find_batch_n(m, key_array, slots, allocated_info(key_array).arraysize)
+#define hash_map_find_batch(...) __array_argc4(__VA_ARGS__, __hash_map_find_batch_n, __hash_map_find_batch_info, , )(__VA_ARGS__)
+
+#define hash_map_free(m) (__hash_map_release((m)->control), \
+    (m)->keys = NULL, (m)->values = NULL, (m)->control = NULL, (m)->count = (m)->capacity = (m)->growth = 0)
+
+#endif
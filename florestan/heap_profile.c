@@ -0,0 +1,221 @@
+// Florestan's Heap Profile
+//
+// © dongwanpianist
+//
+// Samples are summed into one bucket per (call site, method, typesize, totalsize),
+// kept in an open-addressing table behind one spinlock; only sampled allocations ever take it.
+// Call sites are string literals, so buckets are keyed by the pointer and merged by text when dumped.
+
+#include "heap_profile.h"
+#include "type_traits.h"
+#include <stdint.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <math.h>
+
+typedef struct __profile_bucket {
+    const char* site;
+    size_t typesize;
+    size_t totalsize;
+    unsigned char method;
+    size_t samples;
+    double count;
+    double bytes;
+} profile_bucket;
+
+typedef struct __profile_row {
+    const char* label;
+    size_t key;
+    double count;
+    double bytes;
+} profile_row;
+
+atomic_size_t __heap_profile_sampling = FLORESTAN_HEAP_PROFILE_RATE;
+_Thread_local long long __heap_profile_countdown;
+static _Thread_local uint64_t __profile_random;
+
+static atomic_flag __profile_lock = ATOMIC_FLAG_INIT;
+static profile_bucket* __profile_buckets;
+static size_t __profile_capacity;
+static size_t __profile_used;
+
+static inline void __profile_lock_acquire(void) {
+    while (atomic_flag_test_and_set_explicit(&__profile_lock, memory_order_acquire));
+}
+static inline void __profile_lock_release(void) {
+    atomic_flag_clear_explicit(&__profile_lock, memory_order_release);
+}
+
+// Exponentially distributed gap with the given mean, from a per-thread xorshift generator.
+static long long __profile_gap(size_t rate) {
+    if (__profile_random == 0) __profile_random = ((uint64_t)(uintptr_t)&__profile_random * 0x9E3779B97F4A7C15ull) | 1;
+    __profile_random ^= __profile_random << 13;
+    __profile_random ^= __profile_random >> 7;
+    __profile_random ^= __profile_random << 17;
+    double u = (double)((__profile_random >> 11) + 1) * 0x1p-53; // (0, 1]
+    return (long long)(-log(u) * (double)rate) + 1;
+}
+
+static inline size_t __profile_hash(const char* site, size_t typesize, size_t totalsize, unsigned char method) {
+    uint64_t h = (uint64_t)(uintptr_t)site;
+    h = (h ^ typesize) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ totalsize) * 0x9E3779B97F4A7C15ull;
+    h = (h ^ method) * 0x9E3779B97F4A7C15ull;
+    return (size_t)(h ^ (h >> 32));
+}
+
+// Called with the lock held. Returns NULL only when the table cannot grow.
+static profile_bucket* __profile_find(const char* site, size_t typesize, size_t totalsize, unsigned char method) {
+    if (2 * (__profile_used + 1) > __profile_capacity) {
+        size_t capacity = __profile_capacity ? 2 * __profile_capacity : 256;
+        profile_bucket* grown = calloc(capacity, sizeof(profile_bucket));
+        if (grown == NULL) {
+            if (__profile_used == __profile_capacity) return NULL;
+        } else {
+            for (size_t i = 0; i < __profile_capacity; i++) {
+                profile_bucket* b = &__profile_buckets[i];
+                if (b->site == NULL) continue;
+                size_t slot = __profile_hash(b->site, b->typesize, b->totalsize, b->method) & (capacity - 1);
+                while (grown[slot].site) slot = (slot + 1) & (capacity - 1);
+                grown[slot] = *b;
+            }
+            free(__profile_buckets);
+            __profile_buckets = grown;
+            __profile_capacity = capacity;
+        }
+    }
+    size_t slot = __profile_hash(site, typesize, totalsize, method) & (__profile_capacity - 1);
+    for (;; slot = (slot + 1) & (__profile_capacity - 1)) {
+        profile_bucket* b = &__profile_buckets[slot];
+        if (b->site == NULL) {
+            *b = (profile_bucket){ site, typesize, totalsize, method, 0, 0, 0 };
+            __profile_used++;
+            return b;
+        }
+        if (b->site == site && b->typesize == typesize && b->totalsize == totalsize && b->method == method) return b;
+    }
+}
+
+// The countdown ran out inside this allocation.
+// A thread's countdown starts at zero, so its first allocation always lands here: that one first draws the gap
+// the countdown should have started with, and is sampled only if the allocation still reaches past it.
+void __heap_profile_sample(size_t size, size_t typesize, unsigned char method, const char* site) {
+    size_t rate = atomic_load_explicit(&__heap_profile_sampling, memory_order_relaxed);
+    if (rate == 0) return;
+    if (__profile_random == 0 && (__heap_profile_countdown += __profile_gap(rate)) > 0) return;
+    while (__heap_profile_countdown <= 0) __heap_profile_countdown += __profile_gap(rate);
+
+    // An allocation of SIZE bytes is picked with probability 1 - exp(-SIZE / rate); dividing by it keeps the sums unbiased.
+    double picked = -expm1(-(double)size / (double)rate);
+    if (picked <= 0) return;
+    __profile_lock_acquire();
+    profile_bucket* b = __profile_find(site ? site : "?", typesize, size, method);
+    if (b) {
+        b->samples++;
+        b->count += 1 / picked;
+        b->bytes += (double)size / picked;
+    }
+    __profile_lock_release();
+}
+
+void __heap_profile_rate(size_t rate) {
+    atomic_store_explicit(&__heap_profile_sampling, rate, memory_order_relaxed);
+}
+
+void __heap_profile_reset(void) {
+    __profile_lock_acquire();
+    if (__profile_buckets) memset(__profile_buckets, 0, __profile_capacity * sizeof(profile_bucket));
+    __profile_used = 0;
+    __profile_lock_release();
+}
+
+static int __profile_by_bytes(const void* a, const void* b) {
+    double x = ((const profile_bucket*)a)->bytes, y = ((const profile_bucket*)b)->bytes;
+    return (x < y) - (x > y);
+}
+static int __profile_rows_by_bytes(const void* a, const void* b) {
+    double x = ((const profile_row*)a)->bytes, y = ((const profile_row*)b)->bytes;
+    return (x < y) - (x > y);
+}
+
+static int __profile_rows_by_group(const void* a, const void* b) {
+    const profile_row* x = a;
+    const profile_row* y = b;
+    if (x->label) return strcmp(x->label, y->label);
+    return (x->key > y->key) - (x->key < y->key);
+}
+
+// Sums the buckets into rows that share a call site (by text), a typesize or an arraysize bucket.
+static size_t __profile_group(const profile_bucket* buckets, size_t n, profile_row* rows, int by) {
+    for (size_t i = 0; i < n; i++) {
+        const profile_bucket* b = &buckets[i];
+        size_t arraysize = b->typesize ? b->totalsize / b->typesize : 0;
+        size_t bucket = 0;
+        while (bucket < arraysize) bucket = bucket ? bucket * 2 : 1;
+        rows[i] = (profile_row){ by == 0 ? b->site : NULL, by == 1 ? b->typesize : bucket, b->count, b->bytes };
+    }
+    qsort(rows, n, sizeof(profile_row), __profile_rows_by_group);
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (count && __profile_rows_by_group(&rows[count - 1], &rows[i]) == 0) {
+            rows[count - 1].count += rows[i].count;
+            rows[count - 1].bytes += rows[i].bytes;
+        } else rows[count++] = rows[i];
+    }
+    qsort(rows, count, sizeof(profile_row), __profile_rows_by_bytes);
+    return count;
+}
+
+bool __heap_profile_dump(const char* path) {
+    __profile_lock_acquire();
+    size_t n = __profile_used;
+    profile_bucket* buckets = malloc((n ? n : 1) * sizeof(profile_bucket));
+    if (buckets) {
+        for (size_t i = 0, k = 0; i < __profile_capacity; i++) {
+            if (__profile_buckets[i].site) buckets[k++] = __profile_buckets[i];
+        }
+    }
+    __profile_lock_release();
+    if (buckets == NULL) return false;
+    profile_row* rows = malloc((n ? n : 1) * sizeof(profile_row));
+    FILE* file = rows ? fopen(path, "w") : NULL;
+    if (file == NULL) {
+        free(rows);
+        free(buckets);
+        return false;
+    }
+
+    static const char* const methods[] = { "dynamic", "allocated", "fixed", "arena", "mapped", "slab", "ndarray", "bitset", "ring" };
+    double total = 0;
+    for (size_t i = 0; i < n; i++) total += buckets[i].bytes;
+    fprintf(file, "# florestan heap profile: 1 sample every %zu bytes on average\n",
+        atomic_load_explicit(&__heap_profile_sampling, memory_order_relaxed));
+    fprintf(file, "# estimated bytes %.0f\n", total);
+
+    fprintf(file, "\n## by call site\n# bytes count site\n");
+    size_t rowcount = __profile_group(buckets, n, rows, 0);
+    for (size_t i = 0; i < rowcount; i++) fprintf(file, "%.0f %.0f %s\n", rows[i].bytes, rows[i].count, rows[i].label);
+
+    fprintf(file, "\n## by typesize\n# bytes count typesize\n");
+    rowcount = __profile_group(buckets, n, rows, 1);
+    for (size_t i = 0; i < rowcount; i++) fprintf(file, "%.0f %.0f %zu\n", rows[i].bytes, rows[i].count, rows[i].key);
+
+    fprintf(file, "\n## by arraysize (up to a power of two, 0 when typesize is unknown)\n# bytes count arraysize\n");
+    rowcount = __profile_group(buckets, n, rows, 2);
+    for (size_t i = 0; i < rowcount; i++) fprintf(file, "%.0f %.0f %zu\n", rows[i].bytes, rows[i].count, rows[i].key);
+
+    fprintf(file, "\n## allocations\n# bytes count samples method typesize totalsize arraysize site\n");
+    qsort(buckets, n, sizeof(profile_bucket), __profile_by_bytes);
+    for (size_t i = 0; i < n; i++) {
+        const profile_bucket* b = &buckets[i];
+        fprintf(file, "%.0f %.0f %zu %s %zu %zu %zu %s\n", b->bytes, b->count, b->samples,
+            b->method < sizeof(methods) / sizeof(methods[0]) ? methods[b->method] : "?",
+            b->typesize, b->totalsize, b->typesize ? b->totalsize / b->typesize : 0, b->site);
+    }
+
+    bool written = !ferror(file);
+    if (fclose(file) != 0) written = false;
+    free(rows);
+    free(buckets);
+    return written;
+}
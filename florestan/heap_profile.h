@@ -0,0 +1,68 @@
+// Florestan's Heap Profile
+//
+// © dongwanpianist
+//
+// A sampling profiler for the florestan allocators, to find which call sites allocate the most memory.
+// Instead of recording every allocation, it picks one byte out of every FLORESTAN_HEAP_PROFILE_RATE bytes on average
+// (the gaps are drawn from an exponential distribution, so the picks form a Poisson process),
+// and records the allocation holding that byte, scaled up by its chance of being picked.
+// An allocation that is not picked costs one relaxed atomic load and one thread-local subtraction.
+//
+// #define FLORESTAN_HEAP_PROFILE when building florestan/heap_profile.c, florestan/alloc_registry.c and your program
+// (link with -lm); without it, every hook below compiles to nothing.
+//
+// 1. hooked entry points
+//      * tracked_malloc/calloc/realloc (method "allocated"), arena_new (method "arena"),
+//        slab_new (method "slab", <florestan/slab.h>), ndarray_alloc (method "ndarray", <florestan/ndarray.h>),
+//        bitset_new (method "bitset", <florestan/bitset.h>), ring_new (method "ring", <florestan/ring.h>),
+//        and the growth of a vector (<florestan/vector.h>)
+//      * each sample keeps the fields of the allocated_record it would report:
+//        method, typesize, totalsize and arraysize, with its call site ("file.c:123") as the name
+// 2. heap_profile_rate(BYTES)
+//      * the mean number of bytes between two samples; 0 stops sampling
+// 3. heap_profile_dump(FILE_PATH) -> bool
+//      * plain text, the estimated bytes and counts allocated since the last reset, biggest first:
+//          by call site, by typesize, by arraysize (power of two buckets), and every (site, method, typesize, arraysize)
+//      * false when the file cannot be written
+// 4. heap_profile_reset()
+//
+// Only allocations are counted, not frees: the profile tells where the bytes come from over time, not what is live.
+
+#ifndef FLORESTAN_HEAP_PROFILE_H
+#define FLORESTAN_HEAP_PROFILE_H
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifndef FLORESTAN_HEAP_PROFILE_RATE
+    #define FLORESTAN_HEAP_PROFILE_RATE ((size_t)512 * 1024)
+#endif
+
+#define __FLORESTAN_LINE_STRING(line) #line
+#define __FLORESTAN_LINE(line) __FLORESTAN_LINE_STRING(line)
+#define FLORESTAN_CALL_SITE (__FILE__ ":" __FLORESTAN_LINE(__LINE__))
+
+void __heap_profile_rate(size_t rate);
+bool __heap_profile_dump(const char* path);
+void __heap_profile_reset(void);
+#define heap_profile_rate(bytes) __heap_profile_rate(bytes)
+#define heap_profile_dump(path) __heap_profile_dump(path)
+#define heap_profile_reset() __heap_profile_reset()
+
+#ifdef FLORESTAN_HEAP_PROFILE
+#include <stdatomic.h>
+extern atomic_size_t __heap_profile_sampling;
+extern _Thread_local long long __heap_profile_countdown;
+void __heap_profile_sample(size_t size, size_t typesize, unsigned char method, const char* site);
+
+static inline void __heap_profile_note(size_t size, size_t typesize, unsigned char method, const char* site) {
+    if (atomic_load_explicit(&__heap_profile_sampling, memory_order_relaxed) == 0) return;
+    if ((__heap_profile_countdown -= (long long)size) > 0) return;
+    __heap_profile_sample(size, typesize, method, site);
+}
+#else
+static inline void __heap_profile_note(size_t size, size_t typesize, unsigned char method, const char* site) {
+    (void)size; (void)typesize; (void)method; (void)site;
+}
+#endif
+
+#endif
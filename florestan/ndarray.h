@@ -0,0 +1,149 @@
+// Florestan's N-dimensional Array
+//
+// © dongwanpianist
+//
+// A T** (or T***, T****) built row by row takes one malloc per row, and every a[i][j] chases pointers
+// into memory scattered all over the heap. Here the whole array is one block from a single allocation:
+// a small header, the row-pointer tables of every level, and then all the elements, contiguous in row-major order
+// and starting on a cache line. a[i][j][k] works exactly as before, and the elements can also be walked flat.
+//
+// 1. ndarray_alloc(TYPE, D0 [, D1 [, D2 [, D3]]]) -> TYPE* / TYPE** / TYPE*** / TYPE****
+//      * one pointer level per dimension; the elements are uninitialized, like malloc
+//      * the elements start at a multiple of FLORESTAN_NDARRAY_ALIGN; NULL when out of memory or too large
+// 2. ndarray_free(NDARRAY)
+//      * frees everything at once; NDARRAY must be the pointer ndarray_alloc returned
+// 3. ndarray_info(NDARRAY) -> const ndarray_shape* (NULL when NDARRAY has no valid header)
+//      .rank           (uint32_t) number of dimensions, 1 .. FLORESTAN_NDARRAY_RANK
+//      .dimensions     (size_t[FLORESTAN_NDARRAY_RANK]) D0, D1, ..., and 0 beyond the rank
+//      .strides        (size_t[FLORESTAN_NDARRAY_RANK]) elements between neighbours along each dimension,
+//                          row-major, so the last one is 1
+//      .count          (size_t) all the elements
+//      .typesize       (size_t)
+//      .data           (void*) the first element, from which all .count of them follow each other
+// 4. ndarray_data(NDARRAY) -> void*
+//      * ndarray_info(NDARRAY)->data, for one flat loop over every element; NULL where ndarray_info() is NULL
+// 5. allocated_info(NDARRAY) -> allocated_record with method "ndarray"
+//      * only when FLORESTAN_TRACKED_ALLOC is defined where ndarray_alloc() is called
+//      * .shape is ndarray_info(NDARRAY) for the pointer ndarray_alloc returned, and .arraysize counts every element
+//      * a pointer into the elements shows the rest of them from that pointer, with .shape NULL
+//
+// Without FLORESTAN_TRACKED_ALLOC, allocated_info() must not be given an ndarray: it would ask the OS allocator
+// about a pointer that is not the start of its block.
+
+#ifndef FLORESTAN_NDARRAY_H
+#define FLORESTAN_NDARRAY_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#define FLORESTAN_NDARRAY_RANK 4 // as deep as __pointer_depth goes
+#ifndef FLORESTAN_NDARRAY_ALIGN
+    #define FLORESTAN_NDARRAY_ALIGN 64 // a power of two, at least sizeof(void*)
+#endif
+
+typedef struct __ndarray_shape {
+    void* data;
+    size_t typesize;
+    size_t count;
+    size_t dimensions[FLORESTAN_NDARRAY_RANK];
+    size_t strides[FLORESTAN_NDARRAY_RANK];
+    uint32_t rank;
+    uint32_t check;
+} ndarray_shape;
+// The header ends right where the returned pointer starts; the space before it keeps the block aligned.
+#define __NDARRAY_HEADER_SPACE ((sizeof(ndarray_shape) + FLORESTAN_NDARRAY_ALIGN - 1) / FLORESTAN_NDARRAY_ALIGN * FLORESTAN_NDARRAY_ALIGN)
+#define __ndarray_round(n) (((n) + (FLORESTAN_NDARRAY_ALIGN - 1)) & ~(size_t)(FLORESTAN_NDARRAY_ALIGN - 1))
+
+static inline uint32_t __ndarray_check(const void* p, size_t count, uint32_t rank) {
+    uint64_t h = ((uint64_t)(uintptr_t)p ^ (uint64_t)count ^ (uint64_t)rank << 56) * 0x9E3779B97F4A7C15ull;
+    return (uint32_t)(h >> 32);
+}
+
+static inline const ndarray_shape* __ndarray_info(const void* p) {
+    if (p == NULL) return NULL;
+    const ndarray_shape* shape = (const ndarray_shape*)p - 1;
+    return shape->check == __ndarray_check(p, shape->count, shape->rank) ? shape : NULL;
+}
+#define ndarray_info(p) __ndarray_info((const void*)(p))
+static inline void* __ndarray_data(const void* p) {
+    const ndarray_shape* shape = __ndarray_info(p);
+    return shape ? shape->data : NULL;
+}
+#define ndarray_data(p) __ndarray_data((const void*)(p))
+
+#ifdef FLORESTAN_TRACKED_ALLOC
+// The registered block runs from the returned pointer to the last element, so both the tables and the elements resolve here.
+static inline void __ndarray_resolve(allocated_block* block, const void* p) {
+    const ndarray_shape* shape = (const ndarray_shape*)block->base - 1;
+    const unsigned char* data = shape->data;
+    const unsigned char* address = p;
+    size_t size = shape->count * shape->typesize;
+    if (p == block->base) *block = (allocated_block){ p, size, shape->typesize, ndarray, shape };
+    else if (address >= data && address < data + size) *block = (allocated_block){ data, size, shape->typesize, ndarray, NULL };
+    else *block = (allocated_block){ p, 0, 0, ndarray, NULL }; // inside a row-pointer table
+}
+#endif
+
+static inline void* __ndarray_alloc(size_t typesize, uint32_t rank, const size_t* dimensions, const char* site) {
+    // the elements, and the pointers of every level but the last: D0, D0 * D1, ...
+    size_t count = 1, pointers = 0;
+    for (uint32_t k = 0; k < rank; k++) {
+        if (dimensions[k] && count > SIZE_MAX / dimensions[k]) return NULL;
+        count *= dimensions[k];
+        if (k + 1 < rank) pointers += count;
+    }
+    if (typesize && count > (SIZE_MAX / 2) / typesize) return NULL;
+    if (pointers > (SIZE_MAX / 2) / sizeof(void*)) return NULL;
+    size_t size = count * typesize;
+    size_t offset = __ndarray_round(__NDARRAY_HEADER_SPACE + pointers * sizeof(void*));
+    if (size > SIZE_MAX - offset - FLORESTAN_NDARRAY_ALIGN) return NULL;
+    unsigned char* raw = aligned_alloc(FLORESTAN_NDARRAY_ALIGN, __ndarray_round(offset + size));
+    if (raw == NULL) return NULL;
+    unsigned char* p = raw + __NDARRAY_HEADER_SPACE;
+    unsigned char* data = raw + offset;
+
+    ndarray_shape* shape = (ndarray_shape*)p - 1;
+    *shape = (ndarray_shape){ data, typesize, count, { 0 }, { 0 }, rank, __ndarray_check(p, count, rank) };
+    for (uint32_t k = rank; k-- > 0;) {
+        shape->dimensions[k] = dimensions[k];
+        shape->strides[k] = k + 1 < rank ? shape->strides[k + 1] * dimensions[k + 1] : 1;
+    }
+
+    // Level k holds D0 * ... * Dk pointers, each to the start of its row in level k + 1 (or in the elements, for the last level).
+    void** level = (void**)p;
+    size_t rows = 1;
+    for (uint32_t k = 0; k + 1 < rank; k++) {
+        rows *= dimensions[k];
+        bool last = k + 2 == rank;
+        unsigned char* next = last ? data : (unsigned char*)(level + rows);
+        size_t step = dimensions[k + 1] * (last ? typesize : sizeof(void*));
+        for (size_t i = 0; i < rows; i++) level[i] = next + i * step;
+        level = (void**)next;
+    }
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(p, (size_t)(data + size - p), typesize, ndarray, __ndarray_resolve);
+#endif
+    __heap_profile_note(size, typesize, ndarray, site);
+    return p;
+}
+#define __ndarray_alloc1(T, d0) ((T*)__ndarray_alloc(sizeof(T), 1, (const size_t[]){ (d0) }, FLORESTAN_CALL_SITE))
+#define __ndarray_alloc2(T, d0, d1) ((T**)__ndarray_alloc(sizeof(T), 2, (const size_t[]){ (d0), (d1) }, FLORESTAN_CALL_SITE))
+#define __ndarray_alloc3(T, d0, d1, d2) ((T***)__ndarray_alloc(sizeof(T), 3, (const size_t[]){ (d0), (d1), (d2) }, FLORESTAN_CALL_SITE))
+#define __ndarray_alloc4(T, d0, d1, d2, d3) ((T****)__ndarray_alloc(sizeof(T), 4, (const size_t[]){ (d0), (d1), (d2), (d3) }, FLORESTAN_CALL_SITE))
+
+#ifndef __array_argc5
+    #define __array_argc5(_1, _2, _3, _4, _5, NAME, ...) NAME
+#endif
+#define ndarray_alloc(...) __array_argc5(__VA_ARGS__, __ndarray_alloc4, __ndarray_alloc3, __ndarray_alloc2, __ndarray_alloc1, )(__VA_ARGS__)
+
+static inline void __ndarray_free(void* p) {
+    if (p == NULL) return;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_remove(p);
+#endif
+    free((unsigned char*)p - __NDARRAY_HEADER_SPACE);
+}
+#define ndarray_free(p) __ndarray_free((void*)(p))
+
+#endif
@@ -0,0 +1,137 @@
+// Florestan's Parallel Arrays
+//
+// © dongwanpianist
+//
+// The reductions of <florestan/array_reduce.h> and two simple transforms, split across thread_pool_default()
+// (see <florestan/thread_pool.h>; build florestan/thread_pool.c and link with -lpthread).
+// Every chunk runs the same vector kernel a single-threaded call would,
+// and each worker adds its chunks into its own partial result, on its own cache line, until the partials are combined at the end.
+//
+// 1. parallel_reduce(OPERATION, POINTER_OR_ARRAY [, COUNT])
+//      * OPERATION is sum, min or max, with the same result types as array_sum, array_min and array_max
+//      * float sums are added in a different order than array_sum, so the last bits may differ from run to run
+// 2. parallel_fill(POINTER_OR_ARRAY, VALUE [, COUNT])
+// 3. parallel_map(DESTINATION, SOURCE, FUNCTION [, COUNT])
+//      * DESTINATION[i] = FUNCTION(SOURCE[i]), where FUNCTION is a plain function TYPE (TYPE)
+//      * DESTINATION and SOURCE may be the same array
+//      * FUNCTION may call parallel_* itself: that inner call runs on the worker calling FUNCTION alone
+//      * COUNT is allocated_info(first array argument).arraysize when omitted, as with <florestan/array_reduce.h>
+//      * arrays shorter than FLORESTAN_PARALLEL_MIN run on the calling thread alone
+//      * supported element types: the ones of <florestan/array_reduce.h>
+
+#ifndef FLORESTAN_PARALLEL_H
+#define FLORESTAN_PARALLEL_H
+#include "array_reduce.h"
+#include "thread_pool.h"
+
+#ifndef FLORESTAN_PARALLEL_MIN
+    #define FLORESTAN_PARALLEL_MIN ((size_t)1 << 16)
+#endif
+
+// One partial result per worker, each on its own cache line.
+typedef union __parallel_partial {
+    _Alignas(FLORESTAN_CACHE_LINE) unsigned char line[FLORESTAN_CACHE_LINE];
+    long double widest;
+} parallel_partial;
+
+static inline parallel_partial* __parallel_partials(thread_pool* pool) {
+    return aligned_alloc(FLORESTAN_CACHE_LINE, thread_pool_threads(pool) * sizeof(parallel_partial));
+}
+
+#define __PARALLEL_TYPES(NAME, T, S, A, LOWEST, HIGHEST) \
+typedef struct __parallel_reduce_##NAME { const T* source; parallel_partial* partials; } parallel_reduce_##NAME; \
+static inline void __parallel_sum_task_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    parallel_reduce_##NAME* c = context; \
+    A* partial = (A*)c->partials[worker].line; \
+    *partial += (A)__array_sum_##NAME(c->source + begin, end - begin); \
+} \
+static inline void __parallel_min_task_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    parallel_reduce_##NAME* c = context; \
+    T* partial = (T*)c->partials[worker].line; \
+    T m = __array_min_##NAME(c->source + begin, end - begin); \
+    *partial = m < *partial ? m : *partial; \
+} \
+static inline void __parallel_max_task_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    parallel_reduce_##NAME* c = context; \
+    T* partial = (T*)c->partials[worker].line; \
+    T m = __array_max_##NAME(c->source + begin, end - begin); \
+    *partial = m > *partial ? m : *partial; \
+} \
+static inline S __array_parallel_sum_##NAME(const T* p, size_t n) { \
+    thread_pool* pool = n < FLORESTAN_PARALLEL_MIN ? NULL : thread_pool_default(); \
+    parallel_partial* partials = pool ? __parallel_partials(pool) : NULL; \
+    if (partials == NULL) return __array_sum_##NAME(p, n); \
+    size_t threads = thread_pool_threads(pool); \
+    for (size_t w = 0; w < threads; w++) *(A*)partials[w].line = 0; \
+    parallel_reduce_##NAME context = { p, partials }; \
+    thread_pool_run(pool, __parallel_sum_task_##NAME, &context, n, 0); \
+    A s = 0; \
+    for (size_t w = 0; w < threads; w++) s += *(A*)partials[w].line; \
+    free(partials); \
+    return (S)s; \
+} \
+static inline T __array_parallel_min_##NAME(const T* p, size_t n) { \
+    thread_pool* pool = n < FLORESTAN_PARALLEL_MIN ? NULL : thread_pool_default(); \
+    parallel_partial* partials = pool ? __parallel_partials(pool) : NULL; \
+    if (partials == NULL) return __array_min_##NAME(p, n); \
+    size_t threads = thread_pool_threads(pool); \
+    for (size_t w = 0; w < threads; w++) *(T*)partials[w].line = HIGHEST; \
+    parallel_reduce_##NAME context = { p, partials }; \
+    thread_pool_run(pool, __parallel_min_task_##NAME, &context, n, 0); \
+    T m = HIGHEST; \
+    for (size_t w = 0; w < threads; w++) m = *(T*)partials[w].line < m ? *(T*)partials[w].line : m; \
+    free(partials); \
+    return m; \
+} \
+static inline T __array_parallel_max_##NAME(const T* p, size_t n) { \
+    thread_pool* pool = n < FLORESTAN_PARALLEL_MIN ? NULL : thread_pool_default(); \
+    parallel_partial* partials = pool ? __parallel_partials(pool) : NULL; \
+    if (partials == NULL) return __array_max_##NAME(p, n); \
+    size_t threads = thread_pool_threads(pool); \
+    for (size_t w = 0; w < threads; w++) *(T*)partials[w].line = LOWEST; \
+    parallel_reduce_##NAME context = { p, partials }; \
+    thread_pool_run(pool, __parallel_max_task_##NAME, &context, n, 0); \
+    T m = LOWEST; \
+    for (size_t w = 0; w < threads; w++) m = *(T*)partials[w].line > m ? *(T*)partials[w].line : m; \
+    free(partials); \
+    return m; \
+} \
+typedef struct __parallel_fill_##NAME { T* target; T value; } parallel_fill_##NAME; \
+static inline void __parallel_fill_task_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    parallel_fill_##NAME* c = context; \
+    (void)worker; \
+    for (size_t i = begin; i < end; i++) c->target[i] = c->value; \
+} \
+static inline void __array_parallel_fill_##NAME(T* p, T value, size_t n) { \
+    parallel_fill_##NAME context = { p, value }; \
+    thread_pool* pool = n < FLORESTAN_PARALLEL_MIN ? NULL : thread_pool_default(); \
+    if (pool) thread_pool_run(pool, __parallel_fill_task_##NAME, &context, n, 0); \
+    else __parallel_fill_task_##NAME(&context, 0, n, 0); \
+} \
+typedef struct __parallel_map_##NAME { T* target; const T* source; T (*function)(T); } parallel_map_##NAME; \
+static inline void __parallel_map_task_##NAME(void* context, size_t begin, size_t end, size_t worker) { \
+    parallel_map_##NAME* c = context; \
+    (void)worker; \
+    for (size_t i = begin; i < end; i++) c->target[i] = c->function(c->source[i]); \
+} \
+static inline void __array_parallel_map_##NAME(T* target, const T* source, T (*function)(T), size_t n) { \
+    parallel_map_##NAME context = { target, source, function }; \
+    thread_pool* pool = n < FLORESTAN_PARALLEL_MIN ? NULL : thread_pool_default(); \
+    if (pool) thread_pool_run(pool, __parallel_map_task_##NAME, &context, n, 0); \
+    else __parallel_map_task_##NAME(&context, 0, n, 0); \
+}
+__ARRAY_REDUCE_TYPES(__PARALLEL_TYPES)
+
+#define __parallel_reduce_n(OP, p, n) __array_reduce_generic(parallel_##OP, p)((p), (n))
+#define __parallel_reduce_info(OP, p) __parallel_reduce_n(OP, p, allocated_info(p).arraysize)
+#define parallel_reduce(OP, ...) __array_argc2(__VA_ARGS__, __parallel_reduce_n, __parallel_reduce_info, )(OP, __VA_ARGS__)
+
+#define __parallel_fill_n(p, value, n) __array_reduce_generic(parallel_fill, p)((p), (value), (n))
+#define __parallel_fill_info(p, value) __parallel_fill_n(p, value, allocated_info(p).arraysize)
+#define parallel_fill(...) __array_argc3(__VA_ARGS__, __parallel_fill_n, __parallel_fill_info, )(__VA_ARGS__)
+
+#define __parallel_map_n(target, source, function, n) __array_reduce_generic(parallel_map, source)((target), (source), (function), (n))
+#define __parallel_map_info(target, source, function) __parallel_map_n(target, source, function, allocated_info(target).arraysize)
+#define parallel_map(...) __array_argc4(__VA_ARGS__, __parallel_map_n, __parallel_map_info, )(__VA_ARGS__)
+
+#endif
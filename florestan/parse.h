@@ -0,0 +1,226 @@
+// Florestan's Parse
+//
+// © dongwanpianist
+//
+// The mirror image of <florestan/format.h>: separated text into an array of numbers, chosen by the destination's type.
+// Integers are read eight digits at a time (SWAR: the eight characters are checked and combined as one 64-bit word),
+// and float/double are rounded exactly like strtod/strtof, but without them: small values take Clinger's exact path,
+// the rest the Eisel-Lemire algorithm on 128-bit powers of five, and the rare ambiguous ones
+// (more than 19 significant digits) a slow but exact big decimal, all in florestan/parse.c.
+// Nothing reads the locale or touches errno; every error comes back in the result.
+//
+// Build florestan/parse.c with your program.
+//
+// 1. parse_array(DESTINATION, TEXT, LENGTH, SEPARATOR [, CAPACITY]) -> parse_result
+//      * reads the values of TEXT[0 .. LENGTH) separated by the character SEPARATOR (',', '\t', '\n', ...)
+//        into DESTINATION[0], DESTINATION[1], ...; TEXT need not be '\0'-terminated
+//      * blanks (space, tab, \r, \n unless SEPARATOR is one of them) around a value are skipped,
+//        and so is one SEPARATOR at the very end; an empty field is an error
+//      * CAPACITY is allocated_info(DESTINATION).arraysize when omitted
+//      * integers: optional sign and decimal digits; out of range is an error, not a wrap-around or a clamp
+//      * float/double: optional sign, digits with an optional '.', an optional e/E exponent, or inf, infinity, nan
+//        (any case); values beyond the range become infinity and those below it zero, as with strtod
+//      * bool: true, false, 1 or 0; char: exactly one character
+//      * supported element types: bool, char, signed char, unsigned char, short, unsigned short,
+//        int, unsigned int, long, unsigned long, long long, unsigned long long, float, double
+// 2. parse_value(DESTINATION_POINTER, TEXT, LENGTH) -> parse_result
+//      * TEXT must hold exactly one value, blanks aside: empty or blank TEXT is parse_invalid, at offset LENGTH
+//        (while parse_array() reads it as an empty list, parse_ok with count 0)
+// 3. parse_result      (typedef struct __parse_result)
+//      .count          (size_t) values stored, all of them before the error if there is one
+//      .offset         (size_t) where the text ended, or where the field with the error starts
+//      .status         (enum: parse_ok, parse_invalid, parse_range, parse_full)
+//                          * parse_range: an integer does not fit its type
+//                          * parse_full: more values than CAPACITY
+
+#ifndef FLORESTAN_PARSE_H
+#define FLORESTAN_PARSE_H
+#include "type_traits.h"
+#include <limits.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef struct __parse_result {
+    size_t count;
+    size_t offset;
+    enum parse_status __ENUM_TYPE(unsigned char) { parse_ok, parse_invalid, parse_range, parse_full } status;
+} parse_result;
+
+// Each reads one value starting right at p, and returns where it stopped, or NULL when there was no valid value there.
+const char* __parse_double(const char* p, const char* end, double* value);
+const char* __parse_float(const char* p, const char* end, float* value);
+
+// Eight ASCII digits in a little-endian word, as a number; false when any of the eight bytes is not a digit.
+static inline bool __parse_eight_digits(const char* p, uint64_t* value) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    uint64_t v;
+    memcpy(&v, p, sizeof v);
+    // A digit is 0x30..0x39: its high nibble is 3, and adding 6 to the low nibble does not carry.
+    if ((((v & 0xF0F0F0F0F0F0F0F0u) | (((v + 0x0606060606060606u) & 0xF0F0F0F0F0F0F0F0u) >> 4))) != 0x3333333333333333u) return false;
+    v -= 0x3030303030303030u;
+    v = v * 10 + (v >> 8); // pairs of digits, in every other byte
+    v = (((v & 0x000000FF000000FFu) * (100 + (1000000ull << 32))) + (((v >> 16) & 0x000000FF000000FFu) * (1 + (10000ull << 32)))) >> 32;
+    *value = v;
+    return true;
+#else
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        unsigned d = (unsigned char)p[i] - '0';
+        if (d > 9) return false;
+        v = v * 10 + d;
+    }
+    *value = v;
+    return true;
+#endif
+}
+
+// Reads an optional sign and decimal digits; the magnitude saturates at UINT64_MAX and *overflow is set.
+static inline const char* __parse_integer(const char* p, const char* end, bool* negative, uint64_t* magnitude, bool* overflow) {
+    *negative = false;
+    *overflow = false;
+    if (p < end && (*p == '-' || *p == '+')) *negative = *p++ == '-';
+    const char* digits = p;
+    uint64_t v = 0, eight;
+    // Up to 19 digits cannot overflow, so the first 16 of them may be taken eight at a time.
+    while (end - p >= 8 && p - digits <= 11 && __parse_eight_digits(p, &eight)) {
+        v = v * 100000000u + eight;
+        p += 8;
+    }
+    for (; p < end && (unsigned)(unsigned char)*p - '0' <= 9; p++) {
+        unsigned d = (unsigned char)*p - '0';
+        if (v > (UINT64_MAX - d) / 10) *overflow = true;
+        else v = v * 10 + d;
+    }
+    *magnitude = *overflow ? UINT64_MAX : v;
+    return p == digits ? NULL : p;
+}
+
+static inline bool __parse_blank(char c, char separator) {
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n') && c != separator;
+}
+
+static inline bool __parse_word(const char* p, const char* end, const char* word) {
+    size_t length = strlen(word);
+    if ((size_t)(end - p) < length) return false;
+    for (size_t i = 0; i < length; i++) if ((p[i] | 0x20) != word[i]) return false;
+    return true;
+}
+
+// NAME, TYPE, MAX for the integers; each reader returns where it stopped (NULL when invalid)
+// and sets *range when the value does not fit.
+#define __PARSE_SIGNED(NAME, T, MAX) \
+static inline const char* __parse_one_##NAME(const char* p, const char* end, T* value, bool* range) { \
+    bool negative, overflow; \
+    uint64_t magnitude; \
+    p = __parse_integer(p, end, &negative, &magnitude, &overflow); \
+    *range = overflow || magnitude > (negative ? (uint64_t)MAX + 1 : (uint64_t)MAX); \
+    if (p && !*range) *value = negative && magnitude ? (T)(-(long long)(magnitude - 1) - 1) : (T)magnitude; \
+    return p; \
+}
+#define __PARSE_UNSIGNED(NAME, T, MAX) \
+static inline const char* __parse_one_##NAME(const char* p, const char* end, T* value, bool* range) { \
+    bool negative, overflow; \
+    uint64_t magnitude; \
+    p = __parse_integer(p, end, &negative, &magnitude, &overflow); \
+    *range = overflow || magnitude > (uint64_t)MAX || (negative && magnitude != 0); \
+    if (p && !*range) *value = (T)magnitude; \
+    return p; \
+}
+__PARSE_SIGNED(schar, signed char, SCHAR_MAX)
+__PARSE_UNSIGNED(uchar, unsigned char, UCHAR_MAX)
+__PARSE_SIGNED(short, short, SHRT_MAX)
+__PARSE_UNSIGNED(ushort, unsigned short, USHRT_MAX)
+__PARSE_SIGNED(int, int, INT_MAX)
+__PARSE_UNSIGNED(uint, unsigned int, UINT_MAX)
+__PARSE_SIGNED(long, long, LONG_MAX)
+__PARSE_UNSIGNED(ulong, unsigned long, ULONG_MAX)
+__PARSE_SIGNED(llong, long long, LLONG_MAX)
+__PARSE_UNSIGNED(ullong, unsigned long long, ULLONG_MAX)
+
+static inline const char* __parse_one_float(const char* p, const char* end, float* value, bool* range) {
+    *range = false;
+    return __parse_float(p, end, value);
+}
+static inline const char* __parse_one_double(const char* p, const char* end, double* value, bool* range) {
+    *range = false;
+    return __parse_double(p, end, value);
+}
+static inline const char* __parse_one_bool(const char* p, const char* end, bool* value, bool* range) {
+    *range = false;
+    if (__parse_word(p, end, "true")) { *value = true; return p + 4; }
+    if (__parse_word(p, end, "false")) { *value = false; return p + 5; }
+    if (p < end && (*p == '0' || *p == '1')) { *value = *p == '1'; return p + 1; }
+    return NULL;
+}
+static inline const char* __parse_one_char(const char* p, const char* end, char* value, bool* range) {
+    *range = false;
+    if (p == end) return NULL;
+    *value = *p;
+    return p + 1;
+}
+
+// NAME, TYPE
+#define __PARSE_TYPES(X) \
+    X(bool,    bool) \
+    X(char,    char) \
+    X(schar,   signed char) \
+    X(uchar,   unsigned char) \
+    X(short,   short) \
+    X(ushort,  unsigned short) \
+    X(int,     int) \
+    X(uint,    unsigned int) \
+    X(long,    long) \
+    X(ulong,   unsigned long) \
+    X(llong,   long long) \
+    X(ullong,  unsigned long long) \
+    X(float,   float) \
+    X(double,  double)
+
+#define __PARSE_ARRAY(NAME, T) \
+static inline parse_result __parse_array_##NAME(T* destination, const char* text, size_t length, char separator, size_t capacity) { \
+    const char* p = text; \
+    const char* end = text + length; \
+    size_t count = 0; \
+    for (;;) { \
+        while (p < end && __parse_blank(*p, separator)) p++; \
+        if (p == end) break; \
+        const char* field = p; \
+        if (count == capacity) return (parse_result){ count, (size_t)(field - text), parse_full }; \
+        bool range; \
+        p = __parse_one_##NAME(p, end, &destination[count], &range); \
+        if (p == NULL) return (parse_result){ count, (size_t)(field - text), parse_invalid }; \
+        if (range) return (parse_result){ count, (size_t)(field - text), parse_range }; \
+        while (p < end && __parse_blank(*p, separator)) p++; \
+        if (p < end && *p != separator) return (parse_result){ count, (size_t)(field - text), parse_invalid }; \
+        count++; \
+        if (p == end) break; \
+        p++; \
+        /* an empty field, unless it is the separator's own at the very end */ \
+        const char* next = p; \
+        while (next < end && __parse_blank(*next, separator)) next++; \
+        if (next < end && *next == separator) return (parse_result){ count, (size_t)(next - text), parse_invalid }; \
+    } \
+    return (parse_result){ count, length, parse_ok }; \
+}
+__PARSE_TYPES(__PARSE_ARRAY)
+
+#define __PARSE_ARRAY_ARM(NAME, T) T*: __parse_array_##NAME,
+#define __parse_array_generic(p) _Generic((p), __PARSE_TYPES(__PARSE_ARRAY_ARM) default: NULL)
+
+#ifndef __array_argc5
+    #define __array_argc5(_1, _2, _3, _4, _5, NAME, ...) NAME
+#endif
+#define __parse_array_capacity(p, text, length, separator, capacity) \
+    __parse_array_generic(p)((p), (text), (length), (separator), (capacity))
+#define __parse_array_info(p, text, length, separator) \
+    __parse_array_capacity(p, text, length, separator, allocated_info(p).arraysize)
+#define parse_array(...) __array_argc5(__VA_ARGS__, __parse_array_capacity, __parse_array_info, )(__VA_ARGS__)
+
+// '\0' as the separator: a second value after the first one is junk, not a new field. No value at all is junk as well.
+static inline parse_result __parse_one_value(parse_result result) {
+    if (result.status == parse_ok && result.count == 0) result.status = parse_invalid;
+    return result;
+}
+#define parse_value(p, text, length) __parse_one_value(__parse_array_capacity(p, text, length, '\0', 1))
+
+#endif
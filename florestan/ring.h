@@ -0,0 +1,230 @@
+// Florestan's Ring Buffers
+//
+// © dongwanpianist
+//
+// Bounded queues between threads, without a lock: an spsc_ring for one producer and one consumer,
+// and an mpmc_ring for any number of both (Dmitry Vyukov's bounded queue, with a sequence number in every slot).
+// Elements are copied in and out by value, and their size comes from sizeof(*POINTER) at compile time,
+// so a ring of doubles moves 8-byte copies and nothing else.
+// The producer's and the consumer's indexes sit on cache lines of their own, so the two sides do not keep
+// stealing one line from each other; the spsc_ring side also keeps a copy of the other side's index,
+// and reads the real one again only when its copy says the ring is full (or empty).
+//
+// 1. ring_new(TYPE, CAPACITY) -> spsc_ring*
+//    ring_new_mpmc(TYPE, CAPACITY) -> mpmc_ring*
+//      * CAPACITY is rounded up to a power of two (at least 2); NULL when out of memory or too large
+// 2. ring_free(RING)
+//      * when no thread uses RING any more
+// 3. ring_push(RING, VALUE_POINTER) -> bool
+//      * copies *VALUE_POINTER in; false when RING is full
+// 4. ring_pop(RING, VALUE_POINTER) -> bool
+//      * copies the oldest element out into *VALUE_POINTER; false when RING is empty
+// 5. ring_push_batch(RING, POINTER_OR_ARRAY [, COUNT]) -> size_t
+//    ring_pop_batch(RING, POINTER_OR_ARRAY [, COUNT]) -> size_t
+//      * moves up to COUNT elements in order, as many as fit (or are there), with one atomic update of the index
+//        instead of one per element, and returns how many
+//      * COUNT is allocated_info(POINTER_OR_ARRAY).arraysize when omitted
+// 6. ring_size(RING) -> size_t
+//      * the elements in RING at some moment during the call
+// 7. allocated_info(RING) -> allocated_record with method "ring"
+//      * .arraysize is the capacity, and .typesize the element size
+//
+// The pointee of VALUE_POINTER and POINTER_OR_ARRAY must have the size of TYPE; other sizes move nothing (false, 0).
+// An spsc_ring must have a single producer thread and a single consumer thread at a time; an mpmc_ring takes any.
+
+#ifndef FLORESTAN_RING_H
+#define FLORESTAN_RING_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifndef FLORESTAN_CACHE_LINE
+    #define FLORESTAN_CACHE_LINE 64
+#endif
+
+typedef struct __spsc_ring {
+    ring_shape shape;
+    size_t mask;
+    unsigned char* slots;
+    _Alignas(FLORESTAN_CACHE_LINE) atomic_size_t head; // the next element to pop, written by the consumer
+    size_t tail_seen; // the consumer's copy of tail
+    _Alignas(FLORESTAN_CACHE_LINE) atomic_size_t tail; // the next slot to push into, written by the producer
+    size_t head_seen; // the producer's copy of head
+} spsc_ring;
+
+// A slot is its sequence number and the element after it: the push of ticket t waits for sequence t,
+// and leaves t + 1 for the pop; the pop leaves t + capacity, which is the next lap's push ticket.
+typedef struct __mpmc_ring {
+    ring_shape shape;
+    size_t mask;
+    size_t stride;
+    unsigned char* slots;
+    _Alignas(FLORESTAN_CACHE_LINE) atomic_size_t head;
+    _Alignas(FLORESTAN_CACHE_LINE) atomic_size_t tail;
+} mpmc_ring;
+#define __RING_SEQUENCE(ring, ticket) ((atomic_size_t*)((ring)->slots + ((ticket) & (ring)->mask) * (ring)->stride))
+#define __RING_ELEMENT(ring, ticket) ((ring)->slots + ((ticket) & (ring)->mask) * (ring)->stride + sizeof(atomic_size_t))
+
+static inline size_t __ring_capacity(size_t capacity) {
+    size_t c = 2;
+    while (c < capacity && c <= SIZE_MAX / 4) c *= 2;
+    return c < capacity ? 0 : c;
+}
+#define __RING_ROUND(n) (((n) + FLORESTAN_CACHE_LINE - 1) / FLORESTAN_CACHE_LINE * FLORESTAN_CACHE_LINE)
+
+// One block: the handle, then the slots from the next cache line on.
+static inline void* __ring_alloc(size_t header, size_t capacity, size_t stride, const char* site) {
+    if (capacity == 0 || stride == 0 || capacity > (SIZE_MAX / 2) / stride) return NULL;
+    unsigned char* raw = aligned_alloc(FLORESTAN_CACHE_LINE, __RING_ROUND(header) + __RING_ROUND(capacity * stride));
+    if (raw) __heap_profile_note(capacity * stride, stride, ring, site);
+    return raw;
+}
+
+static inline spsc_ring* __ring_new_spsc(size_t typesize, size_t capacity, const char* site) {
+    capacity = __ring_capacity(capacity);
+    spsc_ring* r = __ring_alloc(sizeof(spsc_ring), capacity, typesize, site);
+    if (r == NULL) return NULL;
+    r->shape = (ring_shape){ capacity, typesize };
+    r->mask = capacity - 1;
+    r->slots = (unsigned char*)r + __RING_ROUND(sizeof(spsc_ring));
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    r->tail_seen = r->head_seen = 0;
+    return r;
+}
+static inline mpmc_ring* __ring_new_mpmc(size_t typesize, size_t capacity, const char* site) {
+    capacity = __ring_capacity(capacity);
+    size_t stride = (sizeof(atomic_size_t) + typesize + _Alignof(atomic_size_t) - 1) / _Alignof(atomic_size_t) * _Alignof(atomic_size_t);
+    mpmc_ring* r = __ring_alloc(sizeof(mpmc_ring), capacity, stride, site);
+    if (r == NULL) return NULL;
+    r->shape = (ring_shape){ capacity, typesize };
+    r->mask = capacity - 1;
+    r->stride = stride;
+    r->slots = (unsigned char*)r + __RING_ROUND(sizeof(mpmc_ring));
+    for (size_t i = 0; i < capacity; i++) atomic_init(__RING_SEQUENCE(r, i), i);
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    return r;
+}
+#define ring_new(T, capacity) __ring_new_spsc(sizeof(T), (capacity), FLORESTAN_CALL_SITE)
+#define ring_new_mpmc(T, capacity) __ring_new_mpmc(sizeof(T), (capacity), FLORESTAN_CALL_SITE)
+
+static inline void __ring_free(void* r) { free(r); }
+#define ring_free(r) __ring_free(r)
+
+// spsc_ring: the slots of [from, from + n) as at most two runs, split where the ring wraps.
+static inline void __ring_copy_in(spsc_ring* r, size_t from, const unsigned char* p, size_t n, size_t typesize) {
+    size_t start = from & r->mask, first = r->shape.capacity - start < n ? r->shape.capacity - start : n;
+    memcpy(r->slots + start * typesize, p, first * typesize);
+    memcpy(r->slots, p + first * typesize, (n - first) * typesize);
+}
+static inline void __ring_copy_out(const spsc_ring* r, size_t from, unsigned char* p, size_t n, size_t typesize) {
+    size_t start = from & r->mask, first = r->shape.capacity - start < n ? r->shape.capacity - start : n;
+    memcpy(p, r->slots + start * typesize, first * typesize);
+    memcpy(p + first * typesize, r->slots, (n - first) * typesize);
+}
+
+static inline size_t __spsc_push_batch(spsc_ring* r, const void* p, size_t n, size_t typesize) {
+    if (typesize != r->shape.typesize) return 0;
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (r->shape.capacity - (tail - r->head_seen) < n)
+        r->head_seen = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t space = r->shape.capacity - (tail - r->head_seen);
+    if (n > space) n = space;
+    if (n == 0) return 0;
+    __ring_copy_in(r, tail, p, n, typesize);
+    atomic_store_explicit(&r->tail, tail + n, memory_order_release);
+    return n;
+}
+static inline size_t __spsc_pop_batch(spsc_ring* r, void* p, size_t n, size_t typesize) {
+    if (typesize != r->shape.typesize) return 0;
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    if (r->tail_seen - head < n)
+        r->tail_seen = atomic_load_explicit(&r->tail, memory_order_acquire);
+    size_t ready = r->tail_seen - head;
+    if (n > ready) n = ready;
+    if (n == 0) return 0;
+    __ring_copy_out(r, head, p, n, typesize);
+    atomic_store_explicit(&r->head, head + n, memory_order_release);
+    return n;
+}
+static inline bool __spsc_push(spsc_ring* r, const void* p, size_t typesize) { return __spsc_push_batch(r, p, 1, typesize) == 1; }
+static inline bool __spsc_pop(spsc_ring* r, void* p, size_t typesize) { return __spsc_pop_batch(r, p, 1, typesize) == 1; }
+
+// mpmc_ring: a side first counts the slots from its ticket on that are ready for it (at most n),
+// then claims all of them with one compare-and-swap of its index. A slot ready for ticket t can only be taken
+// by the holder of ticket t, so the count still holds if the swap succeeds; if it fails, another thread took
+// some of them, and the count starts over from the new ticket.
+static inline size_t __mpmc_push_batch(mpmc_ring* r, const void* p, size_t n, size_t typesize) {
+    if (typesize != r->shape.typesize || n == 0) return 0;
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed), count;
+    for (;;) {
+        count = 0;
+        while (count < n && atomic_load_explicit(__RING_SEQUENCE(r, tail + count), memory_order_acquire) == tail + count) count++;
+        if (count == 0) {
+            // full, unless another producer has claimed this ticket meanwhile
+            size_t now = atomic_load_explicit(&r->tail, memory_order_relaxed);
+            if (now == tail) return 0;
+            tail = now;
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&r->tail, &tail, tail + count, memory_order_relaxed, memory_order_relaxed)) break;
+    }
+    for (size_t i = 0; i < count; i++) {
+        memcpy(__RING_ELEMENT(r, tail + i), (const unsigned char*)p + i * typesize, typesize);
+        atomic_store_explicit(__RING_SEQUENCE(r, tail + i), tail + i + 1, memory_order_release);
+    }
+    return count;
+}
+static inline size_t __mpmc_pop_batch(mpmc_ring* r, void* p, size_t n, size_t typesize) {
+    if (typesize != r->shape.typesize || n == 0) return 0;
+    size_t head = atomic_load_explicit(&r->head, memory_order_relaxed), count;
+    for (;;) {
+        count = 0;
+        while (count < n && atomic_load_explicit(__RING_SEQUENCE(r, head + count), memory_order_acquire) == head + count + 1) count++;
+        if (count == 0) {
+            size_t now = atomic_load_explicit(&r->head, memory_order_relaxed);
+            if (now == head) return 0;
+            head = now;
+            continue;
+        }
+        if (atomic_compare_exchange_weak_explicit(&r->head, &head, head + count, memory_order_relaxed, memory_order_relaxed)) break;
+    }
+    for (size_t i = 0; i < count; i++) {
+        memcpy((unsigned char*)p + i * typesize, __RING_ELEMENT(r, head + i), typesize);
+        atomic_store_explicit(__RING_SEQUENCE(r, head + i), head + i + r->shape.capacity, memory_order_release);
+    }
+    return count;
+}
+static inline bool __mpmc_push(mpmc_ring* r, const void* p, size_t typesize) { return __mpmc_push_batch(r, p, 1, typesize) == 1; }
+static inline bool __mpmc_pop(mpmc_ring* r, void* p, size_t typesize) { return __mpmc_pop_batch(r, p, 1, typesize) == 1; }
+
+static inline size_t __spsc_size(spsc_ring* r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return atomic_load_explicit(&r->tail, memory_order_acquire) - head;
+}
+static inline size_t __mpmc_size(mpmc_ring* r) {
+    size_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    size_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    return tail > head ? tail - head : 0; // a pop may claim its ticket between the two loads
+}
+
+#define __ring_generic(OP, r) _Generic((r), spsc_ring*: __spsc_##OP, mpmc_ring*: __mpmc_##OP)
+#define ring_push(r, p) __ring_generic(push, r)((r), (p), sizeof(*(p)))
+#define ring_pop(r, p) __ring_generic(pop, r)((r), (p), sizeof(*(p)))
+#define ring_size(r) __ring_generic(size, r)(r)
+
+#ifndef __array_argc3
+    #define __array_argc3(_1, _2, _3, NAME, ...) NAME
+#endif
+#define __ring_push_batch_n(r, p, n) __ring_generic(push_batch, r)((r), (p), (n), sizeof(*(p)))
+#define __ring_push_batch_info(r, p) __ring_push_batch_n(r, p, allocated_info(p).arraysize)
+#define ring_push_batch(...) __array_argc3(__VA_ARGS__, __ring_push_batch_n, __ring_push_batch_info, )(__VA_ARGS__)
+#define __ring_pop_batch_n(r, p, n) __ring_generic(pop_batch, r)((r), (p), (n), sizeof(*(p)))
+#define __ring_pop_batch_info(r, p) __ring_pop_batch_n(r, p, allocated_info(p).arraysize)
+#define ring_pop_batch(...) __array_argc3(__VA_ARGS__, __ring_pop_batch_n, __ring_pop_batch_info, )(__VA_ARGS__)
+
+#endif
@@ -0,0 +1,39 @@
+// Florestan's SIMD Dispatch
+//
+// © dongwanpianist
+//
+// Shared switches for the type-generic kernels that come with SSE2/AVX2 versions.
+// The kernels are compiled for AVX2 with a function attribute, not with -mavx2,
+// so one binary runs everywhere and picks the AVX2 version only on CPUs that have it.
+//
+// 1. FLORESTAN_X86_SIMD -> defined when the SSE2/AVX2 kernels are compiled in
+//      * GCC and Clang on x86 only; #define FLORESTAN_NO_SIMD to force the portable loops
+// 2. __simd_has_avx2() -> bool
+//      * always false without FLORESTAN_X86_SIMD
+// 3. __SIMD_AVX2 -> function attribute for AVX2 kernels
+// 4. __simd_has_popcnt() / __simd_has_bmi2() -> bool, and __SIMD_POPCNT / __SIMD_BMI2 for their kernels
+//      * the scalar bit instructions that x86-64 CPUs added alongside (popcnt with SSE4.2, pdep/pext with AVX2)
+
+#ifndef FLORESTAN_SIMD_H
+#define FLORESTAN_SIMD_H
+#include <stdbool.h>
+
+#if !defined(FLORESTAN_NO_SIMD) && (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || (defined(__i386__) && defined(__SSE2__)))
+    #define FLORESTAN_X86_SIMD
+    #include <immintrin.h>
+    #define __SIMD_AVX2 __attribute__((target("avx2")))
+    #define __SIMD_POPCNT __attribute__((target("popcnt")))
+    #define __SIMD_BMI2 __attribute__((target("bmi2")))
+    static inline bool __simd_has_avx2(void) { return __builtin_cpu_supports("avx2"); }
+    static inline bool __simd_has_popcnt(void) { return __builtin_cpu_supports("popcnt"); }
+    static inline bool __simd_has_bmi2(void) { return __builtin_cpu_supports("bmi2"); }
+#else
+    #define __SIMD_AVX2
+    #define __SIMD_POPCNT
+    #define __SIMD_BMI2
+    static inline bool __simd_has_avx2(void) { return false; }
+    static inline bool __simd_has_popcnt(void) { return false; }
+    static inline bool __simd_has_bmi2(void) { return false; }
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+// Florestan's Sized Allocation
+//
+// © dongwanpianist
+//
+// alloc_sizeof() asks the OS allocator about a block, which is a library call on Linux and Apple,
+// and is not available at all elsewhere, so allocated_info() can only answer "dynamic" there.
+// With #define FLORESTAN_SIZED_ALLOC before including <florestan/type_traits.h>,
+// these wrappers put a small header right before every block with its element count, element size and type_id,
+// and alloc_sizeof(), __is_allocated() and allocated_info() read that header inline instead, on every platform.
+//
+// 1. sized_malloc(SIZE) -> void*
+// 2. sized_calloc(COUNT, TYPESIZE) -> void*
+// 3. sized_new(TYPE, COUNT) -> TYPE*
+//      * uninitialized, like sized_malloc, but the header keeps COUNT, TYPE's size and type_id
+// 4. sized_realloc(POINTER, SIZE) -> void*
+//      * keeps the element size and type_id of POINTER while SIZE is a whole number of elements
+// 5. sized_free(POINTER)
+// 6. sized_info(POINTER) -> const sized_header* (NULL when POINTER has no valid header)
+//      .count          (size_t) elements; the requested bytes for sized_malloc and sized_realloc of an untyped block
+//      .typesize       (uint32_t) 1 when unknown, so .count * .typesize is always the requested size
+//      .type_id        (uint16_t) type_id() of the element, 0 when unknown
+//
+// The header is checked against the block's address, so a stray pointer is most likely reported as "dynamic",
+// but it is still read: in this mode, give alloc_sizeof() and allocated_info() only
+// NULL, fixed arrays, and the start of blocks from these wrappers (or from the other florestan allocators with
+// FLORESTAN_TRACKED_ALLOC, which asks its registry first). Memory from plain malloc must not be passed to sized_free.
+
+// <florestan/type_traits.h> includes this header back in the middle, once allocated_record is declared.
+#include "type_traits.h"
+#ifndef FLORESTAN_SIZED_ALLOC_H
+#define FLORESTAN_SIZED_ALLOC_H
+#include "heap_profile.h"
+#include "counters.h"
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct __sized_header {
+    size_t count;
+    uint32_t typesize;
+    uint16_t type_id;
+    uint16_t check;
+} sized_header;
+// The header ends right where the block starts; the space before it only pads the block to max_align_t.
+#define __SIZED_HEADER_SPACE ((sizeof(sized_header) + _Alignof(max_align_t) - 1) / _Alignof(max_align_t) * _Alignof(max_align_t))
+
+static inline uint16_t __sized_check(const void* block, size_t count, uint32_t typesize) {
+    uint64_t h = ((uint64_t)(uintptr_t)block ^ (uint64_t)count ^ (uint64_t)typesize << 40) * 0x9E3779B97F4A7C15ull;
+    return (uint16_t)(h >> 48);
+}
+
+static inline const sized_header* __sized_info(const void* p) {
+    if (p == NULL) return NULL;
+    const sized_header* header = (const sized_header*)p - 1;
+    return header->check == __sized_check(p, header->count, header->typesize) ? header : NULL;
+}
+#define sized_info(p) __sized_info((const void*)(p))
+
+static inline size_t __sized_sizeof(const void* p) {
+    __COUNTER_BEGIN("alloc_sizeof", "")
+    const sized_header* header = __sized_info(p);
+    size_t size = header ? header->count * header->typesize : 0;
+    __COUNTER_END(0);
+    return size;
+}
+
+static inline void* __sized_stamp(unsigned char* raw, size_t count, size_t typesize, int type_id) {
+    unsigned char* block = raw + __SIZED_HEADER_SPACE;
+    *((sized_header*)block - 1) = (sized_header){ count, (uint32_t)typesize, (uint16_t)type_id, __sized_check(block, count, (uint32_t)typesize) };
+    return block;
+}
+
+// Resizes p (NULL for a new block) to COUNT elements and writes a fresh header; the heap profile is left to the callers.
+static inline void* __sized_resize(void* p, size_t count, size_t typesize, int type_id) {
+    if (typesize == 0 || typesize > UINT32_MAX || count > (SIZE_MAX - __SIZED_HEADER_SPACE) / typesize) return NULL;
+    unsigned char* raw = realloc(p ? (unsigned char*)p - __SIZED_HEADER_SPACE : NULL, __SIZED_HEADER_SPACE + count * typesize);
+    return raw ? __sized_stamp(raw, count, typesize, type_id) : NULL;
+}
+
+static inline void* __sized_alloc(size_t count, size_t typesize, int type_id, bool zero, const char* site) {
+    if (typesize == 0 || typesize > UINT32_MAX || count > (SIZE_MAX - __SIZED_HEADER_SPACE) / typesize) return NULL;
+    size_t size = count * typesize;
+    unsigned char* raw = zero ? calloc(1, __SIZED_HEADER_SPACE + size) : malloc(__SIZED_HEADER_SPACE + size);
+    if (raw == NULL) return NULL;
+    __heap_profile_note(size, typesize == 1 && type_id == 0 ? 0 : typesize, allocated, site);
+    return __sized_stamp(raw, count, typesize, type_id);
+}
+#define sized_malloc(size) __sized_alloc((size), 1, 0, false, FLORESTAN_CALL_SITE)
+#define sized_calloc(count, typesize) __sized_alloc((count), (typesize), 0, true, FLORESTAN_CALL_SITE)
+#define sized_new(T, count) ((T*)__sized_alloc((count), sizeof(T), type_id((T){0}), false, FLORESTAN_CALL_SITE))
+
+// A SIZE that is not a whole number of elements turns the block into plain bytes.
+static inline void* __sized_realloc(void* p, size_t size, const char* site) {
+    const sized_header* header = __sized_info(p);
+    size_t typesize = header && size % header->typesize == 0 ? header->typesize : 1;
+    int type_id = header && typesize == header->typesize ? header->type_id : 0;
+    void* q = __sized_resize(p, size / typesize, typesize, type_id);
+    if (q) __heap_profile_note(size, typesize == 1 && type_id == 0 ? 0 : typesize, allocated, site);
+    return q;
+}
+#define sized_realloc(p, size) __sized_realloc((void*)(p), (size), FLORESTAN_CALL_SITE)
+
+static inline void __sized_free(void* p) {
+    if (p) free((unsigned char*)p - __SIZED_HEADER_SPACE);
+}
+#define sized_free(p) __sized_free((void*)(p))
+
+// allocated_info() of FLORESTAN_SIZED_ALLOC: one header read, and no division when the element size matches the header's.
+static inline allocated_record __read_sized_record(const char* name, const void* p, unsigned char pointer_depth, size_t typesize) {
+    const sized_header* header = __sized_info(p);
+    if (header == NULL) return (allocated_record){ name, dynamic, pointer_depth, typesize, 0, 0, __address_alignment(p), NULL };
+    size_t size = header->count * header->typesize;
+    if (typesize == 0) typesize = header->typesize;
+    size_t arraysize = typesize == header->typesize ? header->count : size / typesize;
+    return (allocated_record){ name, allocated, pointer_depth, typesize, size, arraysize, __address_alignment(p), NULL };
+}
+static inline allocated_record __make_sized_record(const char* name, const void* p, unsigned char pointer_depth, size_t typesize) {
+    __COUNTER_BEGIN("allocated_info", "")
+    allocated_record record = __read_sized_record(name, p, pointer_depth, typesize);
+    __COUNTER_END(0);
+    return record;
+}
+
+#endif
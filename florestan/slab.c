@@ -0,0 +1,214 @@
+// Florestan's Slab Allocator
+//
+// © dongwanpianist
+//
+// The depot of every size class is an array of FLORESTAN_SLAB_DEPOT slots, each either empty or holding one batch.
+// A batch is put into an empty slot with a compare-and-swap from NULL, and taken out by exchanging the slot with NULL,
+// so whoever takes a batch owns all of it and no slot can be fooled by a batch that left and came back (ABA).
+// Only when every slot is full do batches spill into a list behind a mutex, which a taker checks last.
+// Each thread starts its scans at a slot of its own, so threads rarely race for the same one.
+
+#define _POSIX_C_SOURCE 200809L
+#include "slab.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+
+_Thread_local slab_cache __slab_caches[FLORESTAN_SLAB_CLASSES];
+
+typedef struct __slab_depot {
+    _Alignas(64) _Atomic(slab_object*) slots[FLORESTAN_SLAB_DEPOT];
+    atomic_size_t spilled;
+    pthread_mutex_t lock;
+    slab_object** spill;
+    size_t spill_capacity;
+} slab_depot;
+
+static slab_depot __slab_depots[FLORESTAN_SLAB_CLASSES];
+static pthread_once_t __slab_once = PTHREAD_ONCE_INIT;
+static pthread_key_t __slab_exit_key;
+static _Thread_local bool __slab_registered;
+static _Thread_local size_t __slab_start;
+static atomic_size_t __slab_threads;
+
+static void __slab_thread_exit(void* unused);
+static void __slab_init(void) {
+    for (size_t class = 0; class < FLORESTAN_SLAB_CLASSES; class++) pthread_mutex_init(&__slab_depots[class].lock, NULL);
+    pthread_key_create(&__slab_exit_key, __slab_thread_exit);
+}
+
+// Every thread that touches the caches is registered once, so its caches are handed back when it exits.
+static void __slab_register(void) {
+    pthread_once(&__slab_once, __slab_init);
+    pthread_setspecific(__slab_exit_key, __slab_caches);
+    __slab_start = atomic_fetch_add_explicit(&__slab_threads, 1, memory_order_relaxed) * 7 % FLORESTAN_SLAB_DEPOT;
+    __slab_registered = true;
+}
+
+// Returns false only when every slot is full and the spill list cannot grow.
+static bool __slab_depot_put(size_t class, slab_object* batch) {
+    slab_depot* depot = &__slab_depots[class];
+    size_t start = __slab_start;
+    for (size_t k = 0; k < FLORESTAN_SLAB_DEPOT; k++) {
+        _Atomic(slab_object*)* slot = &depot->slots[(start + k) % FLORESTAN_SLAB_DEPOT];
+        slab_object* empty = NULL;
+        if (atomic_load_explicit(slot, memory_order_relaxed) == NULL
+            && atomic_compare_exchange_strong_explicit(slot, &empty, batch, memory_order_release, memory_order_relaxed)) return true;
+    }
+    bool put = true;
+    pthread_mutex_lock(&depot->lock);
+    size_t spilled = atomic_load_explicit(&depot->spilled, memory_order_relaxed);
+    if (spilled == depot->spill_capacity) {
+        size_t capacity = depot->spill_capacity ? depot->spill_capacity * 2 : FLORESTAN_SLAB_DEPOT;
+        slab_object** grown = realloc(depot->spill, capacity * sizeof(slab_object*));
+        if (grown) {
+            depot->spill = grown;
+            depot->spill_capacity = capacity;
+        } else {
+            put = false;
+        }
+    }
+    if (put) {
+        depot->spill[spilled] = batch;
+        atomic_store_explicit(&depot->spilled, spilled + 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&depot->lock);
+    return put;
+}
+
+static slab_object* __slab_depot_take(size_t class) {
+    slab_depot* depot = &__slab_depots[class];
+    size_t start = __slab_start;
+    for (size_t k = 0; k < FLORESTAN_SLAB_DEPOT; k++) {
+        _Atomic(slab_object*)* slot = &depot->slots[(start + k) % FLORESTAN_SLAB_DEPOT];
+        if (atomic_load_explicit(slot, memory_order_relaxed) == NULL) continue;
+        slab_object* batch = atomic_exchange_explicit(slot, NULL, memory_order_acquire);
+        if (batch) return batch;
+    }
+    if (atomic_load_explicit(&depot->spilled, memory_order_relaxed) == 0) return NULL;
+    slab_object* batch = NULL;
+    pthread_mutex_lock(&depot->lock);
+    size_t spilled = atomic_load_explicit(&depot->spilled, memory_order_relaxed);
+    if (spilled) {
+        batch = depot->spill[spilled - 1];
+        atomic_store_explicit(&depot->spilled, spilled - 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&depot->lock);
+    return batch;
+}
+
+// Links COUNT objects of SIZE bytes starting at FIRST into one batch.
+static slab_object* __slab_link(unsigned char* first, size_t size, size_t count) {
+    for (size_t i = 0; i + 1 < count; i++) ((slab_object*)(first + i * size))->next = (slab_object*)(first + (i + 1) * size);
+    ((slab_object*)(first + (count - 1) * size))->next = NULL;
+    ((slab_object*)first)->count = count;
+    return (slab_object*)first;
+}
+
+#ifdef FLORESTAN_TRACKED_ALLOC
+// Narrows a registered slab down to the object containing p; the slab was registered with its class size as typesize.
+static void __slab_resolve(allocated_block* block, const void* p) {
+    const unsigned char* base = block->base;
+    size_t size = block->typesize;
+    size_t offset = (size_t)((const unsigned char*)p - base);
+    size_t start = offset / size * size;
+    if (start + size > FLORESTAN_SLAB_SIZE) {
+        *block = (allocated_block){ p, 0, 0, slab, NULL };
+        return;
+    }
+    *block = (allocated_block){ base + start, size, 0, slab, NULL };
+}
+#endif
+
+static bool __slab_carve(slab_cache* cache, size_t class) {
+    unsigned char* region = aligned_alloc(FLORESTAN_SLAB_SIZE, FLORESTAN_SLAB_SIZE);
+    if (region == NULL) return false;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(region, FLORESTAN_SLAB_SIZE, __slab_class_size(class), slab, __slab_resolve);
+#else
+    (void)class;
+#endif
+    cache->next = region;
+    cache->end = region + FLORESTAN_SLAB_SIZE;
+    return true;
+}
+
+// Slow path of slab_new: the thread's free list is empty.
+// Takes a batch from the depot, or else links the next batch out of the thread's slab, carving a new one if needed.
+slab_object* __slab_refill(size_t class) {
+    if (!__slab_registered) __slab_register();
+    slab_cache* cache = &__slab_caches[class];
+    slab_object* batch = __slab_depot_take(class);
+    if (batch == NULL) {
+        size_t size = __slab_class_size(class);
+        if ((size_t)(cache->end - cache->next) < size && !__slab_carve(cache, class)) return NULL;
+        size_t count = (size_t)(cache->end - cache->next) / size;
+        if (count > FLORESTAN_SLAB_BATCH) count = FLORESTAN_SLAB_BATCH;
+        batch = __slab_link(cache->next, size, count);
+        cache->next += count * size;
+    }
+    cache->free = batch->next;
+    cache->count = batch->count - 1;
+    return batch;
+}
+
+// Slow path of slab_free: the thread holds two batches' worth of free objects.
+// The most recently freed batch stays, as it is likely still in cache, and the older rest goes to the depot.
+// When the depot cannot take it (out of memory), the objects just stay with the thread.
+void __slab_flush(size_t class) {
+    if (!__slab_registered) __slab_register();
+    slab_cache* cache = &__slab_caches[class];
+    slab_object* last = cache->free;
+    for (size_t i = 1; i < FLORESTAN_SLAB_BATCH; i++) last = last->next;
+    slab_object* rest = last->next;
+    last->next = NULL;
+    rest->count = cache->count - FLORESTAN_SLAB_BATCH;
+    if (__slab_depot_put(class, rest)) cache->count = FLORESTAN_SLAB_BATCH;
+    else last->next = rest;
+}
+
+// Runs when a thread that used the slabs exits: its free lists and the untouched rest of its slabs go to the depot.
+static void __slab_thread_exit(void* unused) {
+    (void)unused;
+    for (size_t class = 0; class < FLORESTAN_SLAB_CLASSES; class++) {
+        slab_cache* cache = &__slab_caches[class];
+        while (cache->free) {
+            slab_object* batch = cache->free;
+            slab_object* last = batch;
+            size_t count = 1;
+            for (; count < FLORESTAN_SLAB_BATCH && last->next; count++) last = last->next;
+            cache->free = last->next;
+            last->next = NULL;
+            batch->count = count;
+            __slab_depot_put(class, batch);
+        }
+        size_t size = __slab_class_size(class);
+        while ((size_t)(cache->end - cache->next) >= size) {
+            size_t count = (size_t)(cache->end - cache->next) / size;
+            if (count > FLORESTAN_SLAB_BATCH) count = FLORESTAN_SLAB_BATCH;
+            __slab_depot_put(class, __slab_link(cache->next, size, count));
+            cache->next += count * size;
+        }
+        *cache = (slab_cache){ 0 };
+    }
+    // Lets a later slab_new in another destructor of this thread register it again.
+    __slab_registered = false;
+}
+
+void* __slab_alloc_large(size_t size, const char* site) {
+#ifdef FLORESTAN_TRACKED_ALLOC
+    return __tracked_malloc(size, site);
+#else
+    void* p = malloc(size);
+    if (p) __heap_profile_note(size, size, allocated, site);
+    return p;
+#endif
+}
+
+void __slab_free_large(void* p) {
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __tracked_free(p);
+#else
+    free(p);
+#endif
+}
@@ -0,0 +1,106 @@
+// Florestan's Slab Allocator
+//
+// © dongwanpianist
+//
+// A pool for many small objects of the same size, like list or tree nodes, that are allocated and freed all the time.
+// The size class comes from sizeof at compile time, so a block carries no header,
+// and freeing needs no lookup: slab_free() learns the size again from sizeof(*POINTER).
+// Each thread keeps its own free list per size class and touches no shared memory while it has objects to spare.
+// A thread that frees much more than it allocates hands whole batches of FLORESTAN_SLAB_BATCH objects to a global depot,
+// and a thread that runs dry takes a batch back from there, each with a single atomic operation, before carving a fresh slab.
+//
+// Build florestan/slab.c with your program and link with -lpthread.
+//
+// 1. slab_new(TYPE) -> TYPE*
+//      * uninitialized; aligned for TYPE; NULL when out of memory
+//      * a TYPE bigger than FLORESTAN_SLAB_MAX comes from malloc (tracked_malloc with FLORESTAN_TRACKED_ALLOC)
+// 2. slab_free(POINTER)
+//      * POINTER must have the same pointee size as in slab_new, so a void* cannot be freed
+//      * any thread may free an object, not only the one that allocated it
+// 3. allocated_info(SLAB_POINTER) -> allocated_record with method "slab"
+//      * only when FLORESTAN_TRACKED_ALLOC is defined for florestan/slab.c as well:
+//        each slab is registered once, and an object is found from the slab's address and its size class
+//      * .totalsize is the size class (a multiple of 8), which may be a little more than sizeof(TYPE)
+//
+// Slabs are never given back to the system; freed objects only go back to the free lists.
+// An exiting thread hands its free lists and the rest of its slabs to the depot.
+
+#ifndef FLORESTAN_SLAB_H
+#define FLORESTAN_SLAB_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifndef FLORESTAN_SLAB_MAX
+    #define FLORESTAN_SLAB_MAX 256 // a multiple of 8
+#endif
+#ifndef FLORESTAN_SLAB_SIZE
+    #define FLORESTAN_SLAB_SIZE ((size_t)64 * 1024) // a power of two; small enough for the registry to index by granule
+#endif
+#ifndef FLORESTAN_SLAB_BATCH
+    #define FLORESTAN_SLAB_BATCH 64
+#endif
+#ifndef FLORESTAN_SLAB_DEPOT
+    #define FLORESTAN_SLAB_DEPOT 64 // batches per size class that the depot holds without a lock
+#endif
+
+// Classes are 16, 24, 32, ... FLORESTAN_SLAB_MAX bytes: a free object holds two pointers, and a size that is
+// a multiple of 8 keeps every object aligned for anything whose alignment divides its size.
+#define FLORESTAN_SLAB_CLASSES (FLORESTAN_SLAB_MAX / 8 - 1)
+#define __slab_class(size) ((size) <= 16 ? 0 : ((size) - 9) / 8)
+#define __slab_class_size(class) (((size_t)(class) + 2) * 8)
+
+// A free object. The first object of a batch also keeps the batch's length in .count.
+typedef struct __slab_object {
+    struct __slab_object* next;
+    size_t count;
+} slab_object;
+
+// The thread's cache for one size class: a free list, and the untouched end of the slab it carves from.
+typedef struct __slab_cache {
+    slab_object* free;
+    size_t count;
+    unsigned char* next;
+    unsigned char* end;
+} slab_cache;
+extern _Thread_local slab_cache __slab_caches[FLORESTAN_SLAB_CLASSES];
+
+slab_object* __slab_refill(size_t class);
+void __slab_flush(size_t class);
+void* __slab_alloc_large(size_t size, const char* site);
+void __slab_free_large(void* p);
+
+static inline void* __slab_alloc(size_t size, const char* site) {
+    if (size > FLORESTAN_SLAB_MAX) return __slab_alloc_large(size, site);
+    size_t class = __slab_class(size);
+    slab_cache* cache = &__slab_caches[class];
+    slab_object* object = cache->free;
+    if (object) {
+        cache->free = object->next;
+        cache->count--;
+    } else {
+        object = __slab_refill(class);
+        if (object == NULL) return NULL;
+    }
+    __heap_profile_note(__slab_class_size(class), size, slab, site);
+    return object;
+}
+#define slab_new(T) ((T*)__slab_alloc(sizeof(T), FLORESTAN_CALL_SITE))
+
+static inline void __slab_free(void* p, size_t size) {
+    if (p == NULL) return;
+    if (size > FLORESTAN_SLAB_MAX) {
+        __slab_free_large(p);
+        return;
+    }
+    size_t class = __slab_class(size);
+    slab_cache* cache = &__slab_caches[class];
+    slab_object* object = p;
+    object->next = cache->free;
+    cache->free = object;
+    if (++cache->count >= 2 * FLORESTAN_SLAB_BATCH) __slab_flush(class);
+}
+#define slab_free(p) __slab_free((void*)(p), sizeof(*(p)))
+
+#endif
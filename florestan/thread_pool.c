@@ -0,0 +1,225 @@
+// Florestan's Thread Pool
+//
+// © dongwanpianist
+//
+// Every worker owns a share of chunk numbers packed in one atomic word: the next chunk in the low half, the end in the high half.
+// The owner takes chunks from the front and thieves cut off the back half, both with a compare-and-swap on that word,
+// so a worker never waits on a lock while there is still work anywhere.
+// The mutex and condition variables are only used to start a run and to learn that it has finished.
+// Each thread keeps a chain of the pools it is working for, on its own stack: a run of a pool already on the chain
+// would wait forever for the run mutex it holds, or for a worker that is itself, so it runs inline instead.
+
+#define _POSIX_C_SOURCE 200809L
+#include "thread_pool.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define __POOL_CHUNKS_PER_THREAD 64
+
+typedef struct __pool_worker {
+    _Alignas(FLORESTAN_CACHE_LINE) _Atomic uint64_t chunks;
+    _Alignas(FLORESTAN_CACHE_LINE) pthread_t thread;
+    struct __thread_pool* pool;
+    size_t id;
+} pool_worker;
+
+struct __thread_pool {
+    size_t threads;
+    pool_worker* workers;
+    pthread_mutex_t run;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    unsigned long generation;
+    size_t running;
+    bool stopping;
+    pool_task task;
+    void* context;
+    size_t count;
+    size_t chunk;
+};
+
+typedef struct __pool_frame {
+    const thread_pool* pool;
+    const struct __pool_frame* outer;
+} pool_frame;
+static _Thread_local const pool_frame* __pool_frames;
+
+static bool __pool_entered(const thread_pool* pool) {
+    for (const pool_frame* frame = __pool_frames; frame; frame = frame->outer) {
+        if (frame->pool == pool) return true;
+    }
+    return false;
+}
+
+static inline uint64_t __pool_pack(uint64_t begin, uint64_t end) { return begin | end << 32; }
+
+static bool __pool_take(pool_worker* worker, size_t* index) {
+    uint64_t chunks = atomic_load_explicit(&worker->chunks, memory_order_relaxed);
+    for (;;) {
+        uint64_t begin = chunks & 0xFFFFFFFFu, end = chunks >> 32;
+        if (begin >= end) return false;
+        if (atomic_compare_exchange_weak_explicit(&worker->chunks, &chunks, __pool_pack(begin + 1, end),
+            memory_order_acquire, memory_order_relaxed)) {
+            *index = (size_t)begin;
+            return true;
+        }
+    }
+}
+
+// Moves the back half of some other worker's share into the thief's own, which is empty at this point.
+static bool __pool_steal(thread_pool* pool, size_t thief) {
+    for (size_t k = 1; k < pool->threads; k++) {
+        pool_worker* victim = &pool->workers[(thief + k) % pool->threads];
+        uint64_t chunks = atomic_load_explicit(&victim->chunks, memory_order_relaxed);
+        for (;;) {
+            uint64_t begin = chunks & 0xFFFFFFFFu, end = chunks >> 32;
+            if (begin >= end) break;
+            uint64_t middle = end - (end - begin + 1) / 2;
+            if (atomic_compare_exchange_weak_explicit(&victim->chunks, &chunks, __pool_pack(begin, middle),
+                memory_order_acquire, memory_order_relaxed)) {
+                atomic_store_explicit(&pool->workers[thief].chunks, __pool_pack(middle, end), memory_order_release);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void __pool_work(thread_pool* pool, size_t id) {
+    pool_worker* worker = &pool->workers[id];
+    size_t index;
+    for (;;) {
+        if (__pool_take(worker, &index)) {
+            size_t begin = index * pool->chunk;
+            size_t end = pool->count - begin < pool->chunk ? pool->count : begin + pool->chunk;
+            pool->task(pool->context, begin, end, id);
+        } else if (!__pool_steal(pool, id)) {
+            return;
+        }
+    }
+}
+
+static void* __pool_main(void* argument) {
+    pool_worker* worker = argument;
+    thread_pool* pool = worker->pool;
+    pool_frame frame = { pool, NULL };
+    __pool_frames = &frame;
+    unsigned long seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stopping) pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stopping) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        __pool_work(pool, worker->id);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->running == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+thread_pool* __thread_pool_create(size_t threads) {
+    if (threads == 0) {
+        const char* environment = getenv("FLORESTAN_THREADS");
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = environment && atol(environment) > 0 ? (size_t)atol(environment) : online > 0 ? (size_t)online : 1;
+    }
+    thread_pool* pool = malloc(sizeof(thread_pool));
+    if (pool == NULL) return NULL;
+    pool->workers = aligned_alloc(FLORESTAN_CACHE_LINE, threads * sizeof(pool_worker));
+    if (pool->workers == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->run, NULL);
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->done, NULL);
+    pool->generation = 0;
+    pool->running = 0;
+    pool->stopping = false;
+    pool->threads = 1;
+    for (size_t i = 0; i < threads; i++) {
+        atomic_init(&pool->workers[i].chunks, 0);
+        pool->workers[i].pool = pool;
+        pool->workers[i].id = i;
+    }
+    // A worker that cannot be started just shrinks the pool; the calling thread alone still runs everything.
+    for (size_t i = 1; i < threads; i++) {
+        if (pthread_create(&pool->workers[i].thread, NULL, __pool_main, &pool->workers[i]) != 0) break;
+        pool->threads++;
+    }
+    return pool;
+}
+
+void __thread_pool_destroy(thread_pool* pool) {
+    if (pool == NULL) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t i = 1; i < pool->threads; i++) pthread_join(pool->workers[i].thread, NULL);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    pthread_mutex_destroy(&pool->run);
+    free(pool->workers);
+    free(pool);
+}
+
+static thread_pool* __pool_default;
+static pthread_once_t __pool_default_once = PTHREAD_ONCE_INIT;
+static void __pool_default_create(void) { __pool_default = __thread_pool_create(0); }
+
+thread_pool* __thread_pool_default(void) {
+    pthread_once(&__pool_default_once, __pool_default_create);
+    return __pool_default;
+}
+
+size_t __thread_pool_threads(const thread_pool* pool) {
+    return pool ? pool->threads : 1;
+}
+
+void __thread_pool_run(thread_pool* pool, pool_task task, void* context, size_t count, size_t grain) {
+    if (count == 0) return;
+    if (grain == 0) grain = FLORESTAN_POOL_GRAIN;
+    size_t chunks = count / grain + (count % grain != 0);
+    size_t most = pool->threads * __POOL_CHUNKS_PER_THREAD;
+    if (chunks > most) chunks = most;
+    if (pool->threads == 1 || chunks == 1 || __pool_entered(pool)) {
+        task(context, 0, count, 0);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->run);
+    pool->task = task;
+    pool->context = context;
+    pool->count = count;
+    pool->chunk = count / chunks + (count % chunks != 0);
+    chunks = count / pool->chunk + (count % pool->chunk != 0);
+    for (size_t i = 0; i < pool->threads; i++) {
+        uint64_t begin = (uint64_t)(chunks * i / pool->threads), end = (uint64_t)(chunks * (i + 1) / pool->threads);
+        atomic_store_explicit(&pool->workers[i].chunks, __pool_pack(begin, end), memory_order_relaxed);
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->generation++;
+    pool->running = pool->threads - 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    pool_frame frame = { pool, __pool_frames };
+    __pool_frames = &frame;
+    __pool_work(pool, 0);
+    __pool_frames = frame.outer;
+
+    pthread_mutex_lock(&pool->lock);
+    while (pool->running) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+    pthread_mutex_unlock(&pool->run);
+}
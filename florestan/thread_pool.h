@@ -0,0 +1,56 @@
+// Florestan's Thread Pool
+//
+// © dongwanpianist
+//
+// A fixed set of pthread workers that split one range of indices among themselves.
+// The range is cut into chunks, and every worker starts with an equal, contiguous share of them;
+// a worker that runs out steals the back half of another worker's share, so uneven chunks still finish together.
+// The calling thread works as worker 0 instead of waiting idle.
+//
+// Build florestan/thread_pool.c with your program and link with -lpthread.
+//
+// 1. thread_pool       (typedef struct __thread_pool)
+// 2. thread_pool_create(THREADS) -> thread_pool*
+//      * THREADS counts the calling thread; 0 means the FLORESTAN_THREADS environment variable,
+//        or every online CPU when it is not set
+//      * NULL when out of memory; workers that cannot be started leave the pool smaller
+// 3. thread_pool_destroy(POOL)
+// 4. thread_pool_default() -> thread_pool*
+//      * created on first use with thread_pool_create(0), and never destroyed
+// 5. thread_pool_threads(POOL) -> size_t
+// 6. thread_pool_run(POOL, TASK, CONTEXT, COUNT, GRAIN)
+//      * calls TASK(CONTEXT, BEGIN, END, WORKER) for chunks [BEGIN, END) covering [0, COUNT) exactly once
+//      * chunks hold at least GRAIN indices (0 means FLORESTAN_POOL_GRAIN), except the last one
+//      * returns after every chunk is done; one run at a time per pool, and other threads wait for theirs
+//      * a run from inside a TASK of the same pool (a parallel_* call in a parallel_map() function, say)
+//        calls its TASK once for the whole range on that thread, as worker 0, instead of waiting on itself
+//      * WORKER is below thread_pool_threads(POOL), so per-worker partial results can live in an array indexed by it;
+//        keep each one on its own FLORESTAN_CACHE_LINE, or the cores will keep stealing the line from each other
+
+#ifndef FLORESTAN_THREAD_POOL_H
+#define FLORESTAN_THREAD_POOL_H
+#include <stddef.h>
+
+#ifndef FLORESTAN_POOL_GRAIN
+    #define FLORESTAN_POOL_GRAIN ((size_t)1 << 15)
+#endif
+#ifndef FLORESTAN_CACHE_LINE
+    #define FLORESTAN_CACHE_LINE 64
+#endif
+
+typedef struct __thread_pool thread_pool;
+typedef void (*pool_task)(void* context, size_t begin, size_t end, size_t worker);
+
+thread_pool* __thread_pool_create(size_t threads);
+void __thread_pool_destroy(thread_pool* pool);
+thread_pool* __thread_pool_default(void);
+size_t __thread_pool_threads(const thread_pool* pool);
+void __thread_pool_run(thread_pool* pool, pool_task task, void* context, size_t count, size_t grain);
+
+#define thread_pool_create(threads) __thread_pool_create(threads)
+#define thread_pool_destroy(pool) __thread_pool_destroy(pool)
+#define thread_pool_default() __thread_pool_default()
+#define thread_pool_threads(pool) __thread_pool_threads(pool)
+#define thread_pool_run(pool, task, context, count, grain) __thread_pool_run((pool), (task), (context), (count), (grain))
+
+#endif
@@ -13,13 +13,25 @@
 // 2. allocated_info(POINTER_OR_ARRAY) -> allocated_record
 // 3. allocated_record  (typedef struct __allocated_record)
 //      .name           (const char*)
-//      .method         (enum: dynamic, allocated, fixed)
+//      .method         (enum: dynamic, allocated, fixed, arena, mapped, slab, ndarray, bitset, ring)
 //                          * allocated and fixed pointer variable can show the correct sizes,
 //                            while dynamic record cannot show any specific size. Have your own count!
+//                          * arena blocks come from <florestan/arena.h> and need FLORESTAN_TRACKED_ALLOC
+//                          * mapped arrays come from array_map() of <florestan/array_file.h> and need FLORESTAN_TRACKED_ALLOC
+//                          * slab objects come from slab_new() of <florestan/slab.h> and need FLORESTAN_TRACKED_ALLOC
+//                          * ndarray blocks come from ndarray_alloc() of <florestan/ndarray.h> and need FLORESTAN_TRACKED_ALLOC
+//                          * bitset_array handles come from bitset_new() of <florestan/bitset.h>, in every mode:
+//                            .arraysize counts bits, .totalsize the bytes of their words, and .typesize is 0
+//                          * spsc_ring and mpmc_ring handles come from ring_new() and ring_new_mpmc() of <florestan/ring.h>:
+//                            .arraysize is the capacity, and .typesize the size of one element
+//                          * aligned_array_alloc() of <florestan/aligned_array.h> gives "allocated" blocks, like malloc
 //      .pointer_depth  (uint8_t / unsigned char)
 //      .size           (size_t)
 //      .typesize       (size_t)
 //      .arraysize      (size_t)
+//      .alignment      (size_t) the largest power of two (up to 4096) the address is a multiple of, 0 for NULL;
+//                          read from the address itself, so it holds for any pointer, however it was allocated
+//      .shape          (const ndarray_shape*) dimensions and strides of an ndarray, NULL for everything else
 // 4. __is_{type}(VARIABLE) -> bool(0 or 1)
 //      * Supported types: all fundamental types of C
 //          bool, char, signed char, unsigned char, short, unsigned short,
@@ -29,6 +41,10 @@
 //      * alteration of name for these:
 //          unsigned -> u (__is_uchar, __is_ushort, __is_uint, __is_ulong, __is_ullong)
 //          long -> l (__is_llong, __is_ullong, __is_ldouble)
+//    __is_bitset(VARIABLE) -> bool(0 or 1)
+//      * a bitset_array* of <florestan/bitset.h>, const or not
+//    __is_ring(VARIABLE) -> bool(0 or 1)
+//      * a spsc_ring* or mpmc_ring* of <florestan/ring.h>
 // 5. __pointer_depth(VARIABLE) -> bool(0 or 1)
 //      * depth is supported until 4th one
 // 5. __is_const(VARIABLE) -> bool(0 or 1)
@@ -38,557 +54,164 @@
 //      * tracks its type at the final pointer
 // 8. alloc_sizeof -> size_t
 //      * OS-specific function (supports Apple, Win,  but not unix?)
-// ( 9. __type_num: for debugging )
+// 9. type_id(VARIABLE) -> int
+//      * a stable number for every type shape above (0 for anything else), the same as __type_num always gave
+//      * top-level const is invisible to it, as it is to _Generic: "const int" is the id of "int"
+//    type_info(VARIABLE) -> type_descriptor (one entry of a static table, indexed by type_id)
+//      .name           (const char*) "unsigned int", "const char **", ...
+//      .size           (size_t) same as __sizeof
+//      .pointer_depth  (unsigned char)
+//      .type_class     (enum: unknown_type, void_type, bool_type, integer_type, floating_type)
+//      .is_signed      (bool)
+//      .is_const       (bool) the final pointee is const
+//      .is_const_pointer (bool)
+//    type_name(VARIABLE) -> const char* (= type_info(VARIABLE).name)
+// 10. #define FLORESTAN_TRACKED_ALLOC before including this header
+//      * allocated_info() asks <florestan/alloc_registry.h> first (link florestan/alloc_registry.c),
+//        so blocks from tracked_malloc/calloc/realloc show their exact sizes,
+//        and an interior pointer shows the rest of its block from that pointer
+// 11. #define FLORESTAN_SIZED_ALLOC before including this header
+//      * alloc_sizeof(), __is_allocated() and allocated_info() read the header that <florestan/sized_alloc.h> puts before
+//        every block of sized_malloc/calloc/new/realloc, inline and on every platform, instead of asking the OS allocator
+//      * with FLORESTAN_TRACKED_ALLOC as well, the registry is still asked first
 
 #ifndef FLORESTAN_TYPE_TRAITS_H
 #define FLORESTAN_TYPE_TRAITS_H
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 
-#define __is_void(...) _Generic((&__VA_ARGS__), \
-    void*: 1,     const void*: 1, \
-    void**: 1,    const void**: 1, \
-    void***: 1,   const void***: 1, \
-    void****: 1,  const void****: 1, \
-    void*****: 1, const void*****: 1, \
-    default: 0 )
-#define __is_bool(...) _Generic((__VA_ARGS__), \
-    bool: 1,     const bool: 1, \
-    bool*: 1,    const bool*: 1, \
-    bool**: 1,   const bool**: 1, \
-    bool***: 1,  const bool***: 1, \
-    bool****: 1, const bool****: 1, \
-    default: 0 )
-#define __is_char(...) _Generic((__VA_ARGS__), \
-    char: 1,     const char: 1, \
-    char*: 1,    const char*: 1, \
-    char**: 1,   const char**: 1, \
-    char***: 1,  const char***: 1, \
-    char****: 1, const char****: 1, \
-    default: 0 )
-#define __is_short(...) _Generic((__VA_ARGS__), \
-    short: 1,     const short: 1, \
-    short*: 1,    const short*: 1, \
-    short**: 1,   const short**: 1, \
-    short***: 1,  const short***: 1, \
-    short****: 1, const short****: 1, \
-    default: 0 )
-#define __is_int(...) _Generic((__VA_ARGS__), \
-    int: 1,     const int: 1, \
-    int*: 1,    const int*: 1, \
-    int**: 1,   const int**: 1, \
-    int***: 1,  const int***: 1, \
-    int****: 1, const int****: 1, \
-    default: 0 )
-#define __is_long(...) _Generic((__VA_ARGS__), \
-    long: 1,     const long: 1, \
-    long*: 1,    const long*: 1, \
-    long**: 1,   const long**: 1, \
-    long***: 1,  const long***: 1, \
-    long****: 1, const long****: 1, \
-    default: 0 )
-#define __is_llong(...) _Generic((__VA_ARGS__), \
-    long long: 1,     const long long: 1, \
-    long long*: 1,    const long long*: 1, \
-    long long**: 1,   const long long**: 1, \
-    long long***: 1,  const long long***: 1, \
-    long long****: 1, const long long****: 1, \
-    default: 0 )
-#define __is_double(...) _Generic((__VA_ARGS__), \
-    double: 1,    const double: 1, \
-    double*: 1,   const double*: 1, \
-    double**: 1,  const double**: 1, \
-    double***: 1, const double***: 1, \
-    double****: 1, const double****: 1, \
-    default: 0 )
-#define __is_float(...) _Generic((__VA_ARGS__), \
-    float: 1,    const float: 1, \
-    float*: 1,   const float*: 1, \
-    float**: 1,  const float**: 1, \
-    float***: 1, const float***: 1, \
-    float****: 1, const float****: 1, \
-    default: 0 )
-#define __is_ldouble(...) _Generic((__VA_ARGS__), \
-    long double: 1,    const long double: 1, \
-    long double*: 1,   const long double*: 1, \
-    long double**: 1,  const long double**: 1, \
-    long double***: 1, const long double***: 1, \
-    long double****: 1, const long double****: 1, \
-    default: 0 )
-#define __is_schar(...) _Generic((__VA_ARGS__), \
-    signed char: 1,     const signed char: 1, \
-    signed char*: 1,    const signed char*: 1, \
-    signed char**: 1,   const signed char**: 1, \
-    signed char***: 1,  const signed char***: 1, \
-    signed char****: 1, const signed char****: 1, \
-    default: 0 )
-#define __is_uchar(...) _Generic((__VA_ARGS__), \
-    unsigned char: 1,     const unsigned char: 1, \
-    unsigned char*: 1,    const unsigned char*: 1, \
-    unsigned char**: 1,   const unsigned char**: 1, \
-    unsigned char***: 1,  const unsigned char***: 1, \
-    unsigned char****: 1, const unsigned char****: 1, \
-    default: 0 )
-#define __is_ushort(...) _Generic((__VA_ARGS__), \
-    unsigned short: 1,     const unsigned short: 1, \
-    unsigned short*: 1,    const unsigned short*: 1, \
-    unsigned short**: 1,   const unsigned short**: 1, \
-    unsigned short***: 1,  const unsigned short***: 1, \
-    unsigned short****: 1, const unsigned short****: 1, \
-    default: 0 )
-#define __is_uint(...) _Generic((__VA_ARGS__), \
-    unsigned int: 1,     const unsigned int: 1, \
-    unsigned int*: 1,    const unsigned int*: 1, \
-    unsigned int**: 1,   const unsigned int**: 1, \
-    unsigned int***: 1,  const unsigned int***: 1, \
-    unsigned int****: 1, const unsigned int****: 1, \
-    default: 0 )
-#define __is_ulong(...) _Generic((__VA_ARGS__), \
-    unsigned long: 1,     const unsigned long: 1, \
-    unsigned long*: 1,    const unsigned long*: 1, \
-    unsigned long**: 1,   const unsigned long**: 1, \
-    unsigned long***: 1,  const unsigned long***: 1, \
-    unsigned long****: 1, const unsigned long****: 1, \
-    default: 0 )
-#define __is_ullong(...) _Generic((__VA_ARGS__), \
-    unsigned long long: 1,     const unsigned long long: 1, \
-    unsigned long long*: 1,    const unsigned long long*: 1, \
-    unsigned long long**: 1,   const unsigned long long**: 1, \
-    unsigned long long***: 1,  const unsigned long long***: 1, \
-    unsigned long long****: 1, const unsigned long long****: 1, \
-    default: 0 )
-#define __pointer_depth(...) _Generic((__VA_ARGS__), \
-    bool: 0,                const bool: 0, \
-    char: 0,                const char: 0, \
-    short: 0,               const short: 0, \
-    int: 0,                 const int: 0, \
-    long: 0,                const long: 0, \
-    long long: 0,           const long long: 0, \
-    double: 0,              const double: 0, \
-    float: 0,               const float: 0, \
-    long double: 0,         const long double: 0, \
-    signed char: 0,         const signed char: 0, \
-    unsigned char: 0,       const unsigned char: 0, \
-    unsigned short: 0,      const unsigned short: 0, \
-    unsigned int: 0,        const unsigned int: 0, \
-    unsigned long: 0,       const unsigned long: 0, \
-    unsigned long long: 0,  const unsigned long long: 0, \
-    void*: 1,               const void*: 1, \
-    bool*: 1,               const bool*: 1, \
-    char*: 1,               const char*: 1, \
-    short*: 1,              const short*: 1, \
-    int*: 1,                const int*: 1, \
-    long*: 1,               const long*: 1, \
-    long long*: 1,          const long long*: 1, \
-    double*: 1,             const double*: 1, \
-    float*: 1,              const float*: 1, \
-    long double*: 1,        const long double*: 1, \
-    signed char*: 1,        const signed char*: 1, \
-    unsigned char*: 1,      const unsigned char*: 1, \
-    unsigned short*: 1,     const unsigned short*: 1, \
-    unsigned int*: 1,       const unsigned int*: 1, \
-    unsigned long*: 1,      const unsigned long*: 1, \
-    unsigned long long*: 1, const unsigned long long*: 1, \
-    void**: 2,               const void**: 2, \
-    bool**: 2,               const bool**: 2, \
-    char**: 2,               const char**: 2, \
-    short**: 2,              const short**: 2, \
-    int**: 2,                const int**: 2, \
-    long**: 2,               const long**: 2, \
-    long long**: 2,          const long long**: 2, \
-    double**: 2,             const double**: 2, \
-    float**: 2,              const float**: 2, \
-    long double**: 2,        const long double**: 2, \
-    signed char**: 2,        const signed char**: 2, \
-    unsigned char**: 2,      const unsigned char**: 2, \
-    unsigned short**: 2,     const unsigned short**: 2, \
-    unsigned int**: 2,       const unsigned int**: 2, \
-    unsigned long**: 2,      const unsigned long**: 2, \
-    unsigned long long**: 2, const unsigned long long**: 2, \
-    void***: 3,               const void***: 3, \
-    bool***: 3,               const bool***: 3, \
-    char***: 3,               const char***: 3, \
-    short***: 3,              const short***: 3, \
-    int***: 3,                const int***: 3, \
-    long***: 3,               const long***: 3, \
-    long long***: 3,          const long long***: 3, \
-    double***: 3,             const double***: 3, \
-    float***: 3,              const float***: 3, \
-    long double***: 3,        const long double***: 3, \
-    signed char***: 3,        const signed char***: 3, \
-    unsigned char***: 3,      const unsigned char***: 3, \
-    unsigned short***: 3,     const unsigned short***: 3, \
-    unsigned int***: 3,       const unsigned int***: 3, \
-    unsigned long***: 3,      const unsigned long***: 3, \
-    unsigned long long***: 3, const unsigned long long***: 3, \
-    void****: 4,               const void****: 4, \
-    bool****: 4,               const bool****: 4, \
-    char****: 4,               const char****: 4, \
-    short****: 4,              const short****: 4, \
-    int****: 4,                const int****: 4, \
-    long****: 4,               const long****: 4, \
-    long long****: 4,          const long long****: 4, \
-    double****: 4,             const double****: 4, \
-    float****: 4,              const float****: 4, \
-    long double****: 4,        const long double****: 4, \
-    signed char****: 4,        const signed char****: 4, \
-    unsigned char****: 4,      const unsigned char****: 4, \
-    unsigned short****: 4,     const unsigned short****: 4, \
-    unsigned int****: 4,       const unsigned int****: 4, \
-    unsigned long****: 4,      const unsigned long****: 4, \
-    unsigned long long****: 4, const unsigned long long****: 4, \
-    default: 0 )
-#define __is_const(...) (_Generic((&__VA_ARGS__), \
-    void*: 0,               const void*: 1, \
-    bool*: 0,               const bool*: 1, \
-    char*: 0,               const char*: 1, \
-    short*: 0,              const short*: 1, \
-    int*: 0,                const int*: 1, \
-    long*: 0,               const long*: 1, \
-    long long*: 0,          const long long*: 1, \
-    double*: 0,             const double*: 1, \
-    float*: 0,              const float*: 1, \
-    long double*: 0,        const long double*: 1, \
-    signed char*: 0,        const signed char*: 1, \
-    unsigned char*: 0,      const unsigned char*: 1, \
-    unsigned short*: 0,     const unsigned short*: 1, \
-    unsigned int*: 0,       const unsigned int*: 1, \
-    unsigned long*: 0,      const unsigned long*: 1, \
-    unsigned long long*: 0, const unsigned long long*: 1, \
-    default: 0 ) || _Generic((__VA_ARGS__), \
-    void*: 0,               const void*: 1, \
-    bool*: 0,               const bool*: 1, \
-    char*: 0,               const char*: 1, \
-    short*: 0,              const short*: 1, \
-    int*: 0,                const int*: 1, \
-    long*: 0,               const long*: 1, \
-    long long*: 0,          const long long*: 1, \
-    double*: 0,             const double*: 1, \
-    float*: 0,              const float*: 1, \
-    long double*: 0,        const long double*: 1, \
-    signed char*: 0,        const signed char*: 1, \
-    unsigned char*: 0,      const unsigned char*: 1, \
-    unsigned short*: 0,     const unsigned short*: 1, \
-    unsigned int*: 0,       const unsigned int*: 1, \
-    unsigned long*: 0,      const unsigned long*: 1, \
-    unsigned long long*: 0, const unsigned long long*: 1, \
-    void**: 0,               const void**: 1, \
-    bool**: 0,               const bool**: 1, \
-    char**: 0,               const char**: 1, \
-    short**: 0,              const short**: 1, \
-    int**: 0,                const int**: 1, \
-    long**: 0,               const long**: 1, \
-    long long**: 0,          const long long**: 1, \
-    double**: 0,             const double**: 1, \
-    float**: 0,              const float**: 1, \
-    long double**: 0,        const long double**: 1, \
-    signed char**: 0,        const signed char**: 1, \
-    unsigned char**: 0,      const unsigned char**: 1, \
-    unsigned short**: 0,     const unsigned short**: 1, \
-    unsigned int**: 0,       const unsigned int**: 1, \
-    unsigned long**: 0,      const unsigned long**: 1, \
-    unsigned long long**: 0, const unsigned long long**: 1, \
-    void***: 0,               const void***: 1, \
-    bool***: 0,               const bool***: 1, \
-    char***: 0,               const char***: 1, \
-    short***: 0,              const short***: 1, \
-    int***: 0,                const int***: 1, \
-    long***: 0,               const long***: 1, \
-    long long***: 0,          const long long***: 1, \
-    double***: 0,             const double***: 1, \
-    float***: 0,              const float***: 1, \
-    long double***: 0,        const long double***: 1, \
-    signed char***: 0,        const signed char***: 1, \
-    unsigned char***: 0,      const unsigned char***: 1, \
-    unsigned short***: 0,     const unsigned short***: 1, \
-    unsigned int***: 0,       const unsigned int***: 1, \
-    unsigned long***: 0,      const unsigned long***: 1, \
-    unsigned long long***: 0, const unsigned long long***: 1, \
-    void****: 0,               const void****: 1, \
-    bool****: 0,               const bool****: 1, \
-    char****: 0,               const char****: 1, \
-    short****: 0,              const short****: 1, \
-    int****: 0,                const int****: 1, \
-    long****: 0,               const long****: 1, \
-    long long****: 0,          const long long****: 1, \
-    double****: 0,             const double****: 1, \
-    float****: 0,              const float****: 1, \
-    long double****: 0,        const long double****: 1, \
-    signed char****: 0,        const signed char****: 1, \
-    unsigned char****: 0,      const unsigned char****: 1, \
-    unsigned short****: 0,     const unsigned short****: 1, \
-    unsigned int****: 0,       const unsigned int****: 1, \
-    unsigned long****: 0,      const unsigned long****: 1, \
-    unsigned long long****: 0, const unsigned long long****: 1, \
-    default: 0 ))
+// C23 gives an enum its underlying type (GCC 13, Clang 18); older compilers keep the enums below as large as an int.
+#if (defined(__STDC_VERSION__) && __STDC_VERSION__ >= 202311L) || \
+    (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 13 && __STDC_VERSION__ > 201710L)
+    #define __ENUM_TYPE(T) : T
+#else
+    #define __ENUM_TYPE(T)
+#endif
+
+// Every _Generic table below is generated from this one list: NAME (as in __is_NAME), TYPE, INDEX (the order of __type_num), CLASS.
+// void only lives behind pointers, so each table spells its void arms out by itself (with INDEX -1).
+//      * _Generic drops the top-level qualifiers of what it inspects (lvalue conversion),
+//        so arms like "const int" or "int* const" could never be picked and are not listed.
+//        Those are read through (&VARIABLE) instead, as __is_const and __is_const_pointer do.
+//      * each table lists only the arms whose value differs from its default
+#define __FLORESTAN_TYPES(X) \
+    X(bool,    bool,               0,  bool_type) \
+    X(char,    char,               1,  integer_type) \
+    X(short,   short,              2,  integer_type) \
+    X(int,     int,                3,  integer_type) \
+    X(long,    long,               4,  integer_type) \
+    X(llong,   long long,          5,  integer_type) \
+    X(double,  double,             6,  floating_type) \
+    X(float,   float,              7,  floating_type) \
+    X(ldouble, long double,        8,  floating_type) \
+    X(schar,   signed char,        9,  integer_type) \
+    X(uchar,   unsigned char,      10, integer_type) \
+    X(ushort,  unsigned short,     11, integer_type) \
+    X(uint,    unsigned int,       12, integer_type) \
+    X(ulong,   unsigned long,      13, integer_type) \
+    X(ullong,  unsigned long long, 14, integer_type)
+
+#define __POINTER_ARMS(T, V) \
+    T*: V, const T*: V, T**: V, const T**: V, T***: V, const T***: V, T****: V, const T****: V,
+#define __IS_ARMS(T) T: 1, __POINTER_ARMS(T, 1)
+
+#define __is_void(...) _Generic((&__VA_ARGS__), __POINTER_ARMS(void, 1) void*****: 1, const void*****: 1, default: 0)
+#define __is_bool(...) _Generic((__VA_ARGS__), __IS_ARMS(bool) default: 0)
+#define __is_char(...) _Generic((__VA_ARGS__), __IS_ARMS(char) default: 0)
+#define __is_short(...) _Generic((__VA_ARGS__), __IS_ARMS(short) default: 0)
+#define __is_int(...) _Generic((__VA_ARGS__), __IS_ARMS(int) default: 0)
+#define __is_long(...) _Generic((__VA_ARGS__), __IS_ARMS(long) default: 0)
+#define __is_llong(...) _Generic((__VA_ARGS__), __IS_ARMS(long long) default: 0)
+#define __is_double(...) _Generic((__VA_ARGS__), __IS_ARMS(double) default: 0)
+#define __is_float(...) _Generic((__VA_ARGS__), __IS_ARMS(float) default: 0)
+#define __is_ldouble(...) _Generic((__VA_ARGS__), __IS_ARMS(long double) default: 0)
+#define __is_schar(...) _Generic((__VA_ARGS__), __IS_ARMS(signed char) default: 0)
+#define __is_uchar(...) _Generic((__VA_ARGS__), __IS_ARMS(unsigned char) default: 0)
+#define __is_ushort(...) _Generic((__VA_ARGS__), __IS_ARMS(unsigned short) default: 0)
+#define __is_uint(...) _Generic((__VA_ARGS__), __IS_ARMS(unsigned int) default: 0)
+#define __is_ulong(...) _Generic((__VA_ARGS__), __IS_ARMS(unsigned long) default: 0)
+#define __is_ullong(...) _Generic((__VA_ARGS__), __IS_ARMS(unsigned long long) default: 0)
+
+#define __DEPTH_ARMS(NAME, T, INDEX, CLASS) \
+    T*: 1, const T*: 1, T**: 2, const T**: 2, T***: 3, const T***: 3, T****: 4, const T****: 4,
+#define __pointer_depth(...) _Generic((__VA_ARGS__), __DEPTH_ARMS(void, void, -1, void_type) __FLORESTAN_TYPES(__DEPTH_ARMS) default: 0)
+
+#define __CONST_OBJECT_ARM(NAME, T, INDEX, CLASS) const T*: 1,
+#define __CONST_POINTEE_ARMS(NAME, T, INDEX, CLASS) const T*: 1, const T**: 1, const T***: 1, const T****: 1,
+#define __is_const_object(...) _Generic((&__VA_ARGS__), __FLORESTAN_TYPES(__CONST_OBJECT_ARM) default: 0)
+#define __is_const(...) (__is_const_object(__VA_ARGS__) || \
+    _Generic((__VA_ARGS__), __CONST_POINTEE_ARMS(void, void, -1, void_type) __FLORESTAN_TYPES(__CONST_POINTEE_ARMS) default: 0))
+
+#define __CONST_POINTER_ARMS(NAME, T, INDEX, CLASS) \
+    T* const*: 1,    const T* const*: 1, \
+    T** const*: 1,   const T** const*: 1, \
+    T*** const*: 1,  const T*** const*: 1, \
+    T**** const*: 1, const T**** const*: 1,
 #define __is_const_pointer(...) _Generic((&__VA_ARGS__), \
-    void*: 0,               const void*: 0, \
-    bool*: 0,               const bool*: 0, \
-    char*: 0,               const char*: 0, \
-    short*: 0,              const short*: 0, \
-    int*: 0,                const int*: 0, \
-    long*: 0,               const long*: 0, \
-    long long*: 0,          const long long*: 0, \
-    double*: 0,             const double*: 0, \
-    float*: 0,              const float*: 0, \
-    long double*: 0,        const long double*: 0, \
-    signed char*: 0,        const signed char*: 0, \
-    unsigned char*: 0,      const unsigned char*: 0, \
-    unsigned short*: 0,     const unsigned short*: 0, \
-    unsigned int*: 0,       const unsigned int*: 0, \
-    unsigned long*: 0,      const unsigned long*: 0, \
-    unsigned long long*: 0, const unsigned long long*: 0, \
-    void**: 0,               const void**: 0,               void* const*: 1,               const void* const*: 1, \
-    bool**: 0,               const bool**: 0,               bool* const*: 1,               const bool* const*: 1, \
-    char**: 0,               const char**: 0,               char* const*: 1,               const char* const*: 1, \
-    short**: 0,              const short**: 0,              short* const*: 1,              const short* const*: 1, \
-    int**: 0,                const int**: 0,                int* const*: 1,                const int* const*: 1, \
-    long**: 0,               const long**: 0,               long* const*: 1,               const long* const*: 1, \
-    long long**: 0,          const long long**: 0,          long long* const*: 1,          const long long* const*: 1, \
-    double**: 0,             const double**: 0,             double* const*: 1,             const double* const*: 1, \
-    float**: 0,              const float**: 0,              float* const*: 1,              const float* const*: 1, \
-    long double**: 0,        const long double**: 0,        long double* const*: 1,        const long double* const*: 1, \
-    signed char**: 0,        const signed char**: 0,        signed char* const*: 1,        const signed char* const*: 1, \
-    unsigned char**: 0,      const unsigned char**: 0,      unsigned char* const*: 1,      const unsigned char* const*: 1, \
-    unsigned short**: 0,     const unsigned short**: 0,     unsigned short* const*: 1,     const unsigned short* const*: 1, \
-    unsigned int**: 0,       const unsigned int**: 0,       unsigned int* const*: 1,       const unsigned int* const*: 1, \
-    unsigned long**: 0,      const unsigned long**: 0,      unsigned long* const*: 1,      const unsigned long* const*: 1, \
-    unsigned long long**: 0, const unsigned long long**: 0, unsigned long long* const*: 1, const unsigned long long* const*: 1, \
-    void***: 0,               const void***: 0,               void** const*: 1,               const void** const*: 1, \
-    bool***: 0,               const bool***: 0,               bool** const*: 1,               const bool** const*: 1, \
-    char***: 0,               const char***: 0,               char** const*: 1,               const char** const*: 1, \
-    short***: 0,              const short***: 0,              short** const*: 1,              const short** const*: 1, \
-    int***: 0,                const int***: 0,                int** const*: 1,                const int** const*: 1, \
-    long***: 0,               const long***: 0,               long** const*: 1,               const long** const*: 1, \
-    long long***: 0,          const long long***: 0,          long long** const*: 1,          const long long** const*: 1, \
-    double***: 0,             const double***: 0,             double** const*: 1,             const double** const*: 1, \
-    float***: 0,              const float***: 0,              float** const*: 1,              const float** const*: 1, \
-    long double***: 0,        const long double***: 0,        long double** const*: 1,        const long double** const*: 1, \
-    signed char***: 0,        const signed char***: 0,        signed char** const*: 1,        const signed char** const*: 1, \
-    unsigned char***: 0,      const unsigned char***: 0,      unsigned char** const*: 1,      const unsigned char** const*: 1, \
-    unsigned short***: 0,     const unsigned short***: 0,     unsigned short** const*: 1,     const unsigned short** const*: 1, \
-    unsigned int***: 0,       const unsigned int***: 0,       unsigned int** const*: 1,       const unsigned int** const*: 1, \
-    unsigned long***: 0,      const unsigned long***: 0,      unsigned long** const*: 1,      const unsigned long** const*: 1, \
-    unsigned long long***: 0, const unsigned long long***: 0, unsigned long long** const*: 1, const unsigned long long** const*: 1, \
-    void****: 0,               const void****: 0,               void*** const*: 1,               const void*** const*: 1, \
-    bool****: 0,               const bool****: 0,               bool*** const*: 1,               const bool*** const*: 1, \
-    char****: 0,               const char****: 0,               char*** const*: 1,               const char*** const*: 1, \
-    short****: 0,              const short****: 0,              short*** const*: 1,              const short*** const*: 1, \
-    int****: 0,                const int****: 0,                int*** const*: 1,                const int*** const*: 1, \
-    long****: 0,               const long****: 0,               long*** const*: 1,               const long*** const*: 1, \
-    long long****: 0,          const long long****: 0,          long long*** const*: 1,          const long long*** const*: 1, \
-    double****: 0,             const double****: 0,             double*** const*: 1,             const double*** const*: 1, \
-    float****: 0,              const float****: 0,              float*** const*: 1,              const float*** const*: 1, \
-    long double****: 0,        const long double****: 0,        long double*** const*: 1,        const long double*** const*: 1, \
-    signed char****: 0,        const signed char****: 0,        signed char*** const*: 1,        const signed char*** const*: 1, \
-    unsigned char****: 0,      const unsigned char****: 0,      unsigned char*** const*: 1,      const unsigned char*** const*: 1, \
-    unsigned short****: 0,     const unsigned short****: 0,     unsigned short*** const*: 1,     const unsigned short*** const*: 1, \
-    unsigned int****: 0,       const unsigned int****: 0,       unsigned int*** const*: 1,       const unsigned int*** const*: 1, \
-    unsigned long****: 0,      const unsigned long****: 0,      unsigned long*** const*: 1,      const unsigned long*** const*: 1, \
-    unsigned long long****: 0, const unsigned long long****: 0, unsigned long long*** const*: 1, const unsigned long long*** const*: 1, \
-    void*****: 0,               const void*****: 0,               void**** const*: 1,               const void**** const*: 1, \
-    bool*****: 0,               const bool*****: 0,               bool**** const*: 1,               const bool**** const*: 1, \
-    char*****: 0,               const char*****: 0,               char**** const*: 1,               const char**** const*: 1, \
-    short*****: 0,              const short*****: 0,              short**** const*: 1,              const short**** const*: 1, \
-    int*****: 0,                const int*****: 0,                int**** const*: 1,                const int**** const*: 1, \
-    long*****: 0,               const long*****: 0,               long**** const*: 1,               const long**** const*: 1, \
-    long long*****: 0,          const long long*****: 0,          long long**** const*: 1,          const long long**** const*: 1, \
-    double*****: 0,             const double*****: 0,             double**** const*: 1,             const double**** const*: 1, \
-    float*****: 0,              const float*****: 0,              float**** const*: 1,              const float**** const*: 1, \
-    long double*****: 0,        const long double*****: 0,        long double**** const*: 1,        const long double**** const*: 1, \
-    signed char*****: 0,        const signed char*****: 0,        signed char**** const*: 1,        const signed char**** const*: 1, \
-    unsigned char*****: 0,      const unsigned char*****: 0,      unsigned char**** const*: 1,      const unsigned char**** const*: 1, \
-    unsigned short*****: 0,     const unsigned short*****: 0,     unsigned short**** const*: 1,     const unsigned short**** const*: 1, \
-    unsigned int*****: 0,       const unsigned int*****: 0,       unsigned int**** const*: 1,       const unsigned int**** const*: 1, \
-    unsigned long*****: 0,      const unsigned long*****: 0,      unsigned long**** const*: 1,      const unsigned long**** const*: 1, \
-    unsigned long long*****: 0, const unsigned long long*****: 0, unsigned long long**** const*: 1, const unsigned long long**** const*: 1, \
-default: 0 )
-#define __sizeof(...) _Generic((__VA_ARGS__), \
-    bool: sizeof(bool),                             const bool: sizeof(bool), \
-    char: sizeof(char),                             const char: sizeof(char), \
-    short: sizeof(short),                           const short: sizeof(short), \
-    int: sizeof(int),                               const int: sizeof(int), \
-    long: sizeof(long),                             const long: sizeof(long), \
-    long long: sizeof(long long),                   const long long: sizeof(long long), \
-    double: sizeof(double),                         const double: sizeof(double), \
-    float: sizeof(float),                           const float: sizeof(float), \
-    long double: sizeof(long double),               const long double: sizeof(long double), \
-    signed char: sizeof(signed char),               const signed char: sizeof(signed char), \
-    unsigned char: sizeof(unsigned char),           const unsigned char: sizeof(unsigned char), \
-    unsigned short: sizeof(unsigned short),         const unsigned short: sizeof(unsigned short), \
-    unsigned int: sizeof(unsigned int),             const unsigned int: sizeof(unsigned int), \
-    unsigned long: sizeof(unsigned long),           const unsigned long: sizeof(unsigned long), \
-    unsigned long long: sizeof(unsigned long long), const unsigned long long: sizeof(unsigned long long), \
-    void*: 0,                                        const void*: 0, \
-    bool*: sizeof(bool),                             const bool*: sizeof(bool), \
-    char*: sizeof(char),                             const char*: sizeof(char), \
-    short*: sizeof(short),                           const short*: sizeof(short), \
-    int*: sizeof(int),                               const int*: sizeof(int), \
-    long*: sizeof(long),                             const long*: sizeof(long), \
-    long long*: sizeof(long long),                   const long long*: sizeof(long long), \
-    double*: sizeof(double),                         const double*: sizeof(double), \
-    float*: sizeof(float),                           const float*: sizeof(float), \
-    long double*: sizeof(long double),               const long double*: sizeof(long double), \
-    signed char*: sizeof(signed char),               const signed char*: sizeof(signed char), \
-    unsigned char*: sizeof(unsigned char),           const unsigned char*: sizeof(unsigned char), \
-    unsigned short*: sizeof(unsigned short),         const unsigned short*: sizeof(unsigned short), \
-    unsigned int*: sizeof(unsigned int),             const unsigned int*: sizeof(unsigned int), \
-    unsigned long*: sizeof(unsigned long),           const unsigned long*: sizeof(unsigned long), \
-    unsigned long long*: sizeof(unsigned long long), const unsigned long long*: sizeof(unsigned long long), \
-    void**: 0,                                        const void**: 0, \
-    bool**: sizeof(bool),                             const bool**: sizeof(bool), \
-    char**: sizeof(char),                             const char**: sizeof(char), \
-    short**: sizeof(short),                           const short**: sizeof(short), \
-    int**: sizeof(int),                               const int**: sizeof(int), \
-    long**: sizeof(long),                             const long**: sizeof(long), \
-    long long**: sizeof(long long),                   const long long**: sizeof(long long), \
-    double**: sizeof(double),                         const double**: sizeof(double), \
-    float**: sizeof(float),                           const float**: sizeof(float), \
-    long double**: sizeof(long double),               const long double**: sizeof(long double), \
-    signed char**: sizeof(signed char),               const signed char**: sizeof(signed char), \
-    unsigned char**: sizeof(unsigned char),           const unsigned char**: sizeof(unsigned char), \
-    unsigned short**: sizeof(unsigned short),         const unsigned short**: sizeof(unsigned short), \
-    unsigned int**: sizeof(unsigned int),             const unsigned int**: sizeof(unsigned int), \
-    unsigned long**: sizeof(unsigned long),           const unsigned long**: sizeof(unsigned long), \
-    unsigned long long**: sizeof(unsigned long long), const unsigned long long**: sizeof(unsigned long long), \
-    void***: 0,                                        const void***: 0, \
-    bool***: sizeof(bool),                             const bool***: sizeof(bool), \
-    char***: sizeof(char),                             const char***: sizeof(char), \
-    short***: sizeof(short),                           const short***: sizeof(short), \
-    int***: sizeof(int),                               const int***: sizeof(int), \
-    long***: sizeof(long),                             const long***: sizeof(long), \
-    long long***: sizeof(long long),                   const long long***: sizeof(long long), \
-    double***: sizeof(double),                         const double***: sizeof(double), \
-    float***: sizeof(float),                           const float***: sizeof(float), \
-    long double***: sizeof(long double),               const long double***: sizeof(long double), \
-    signed char***: sizeof(signed char),               const signed char***: sizeof(signed char), \
-    unsigned char***: sizeof(unsigned char),           const unsigned char***: sizeof(unsigned char), \
-    unsigned short***: sizeof(unsigned short),         const unsigned short***: sizeof(unsigned short), \
-    unsigned int***: sizeof(unsigned int),             const unsigned int***: sizeof(unsigned int), \
-    unsigned long***: sizeof(unsigned long),           const unsigned long***: sizeof(unsigned long), \
-    unsigned long long***: sizeof(unsigned long long), const unsigned long long***: sizeof(unsigned long long), \
-    void****: 0,                                        const void****: 0, \
-    bool****: sizeof(bool),                             const bool****: sizeof(bool), \
-    char****: sizeof(char),                             const char****: sizeof(char), \
-    short****: sizeof(short),                           const short****: sizeof(short), \
-    int****: sizeof(int),                               const int****: sizeof(int), \
-    long****: sizeof(long),                             const long****: sizeof(long), \
-    long long****: sizeof(long long),                   const long long****: sizeof(long long), \
-    double****: sizeof(double),                         const double****: sizeof(double), \
-    float****: sizeof(float),                           const float****: sizeof(float), \
-    long double****: sizeof(long double),               const long double****: sizeof(long double), \
-    signed char****: sizeof(signed char),               const signed char****: sizeof(signed char), \
-    unsigned char****: sizeof(unsigned char),           const unsigned char****: sizeof(unsigned char), \
-    unsigned short****: sizeof(unsigned short),         const unsigned short****: sizeof(unsigned short), \
-    unsigned int****: sizeof(unsigned int),             const unsigned int****: sizeof(unsigned int), \
-    unsigned long****: sizeof(unsigned long),           const unsigned long****: sizeof(unsigned long), \
-    unsigned long long****: sizeof(unsigned long long), const unsigned long long****: sizeof(unsigned long long), \
-default: sizeof(__VA_ARGS__) )
+    __CONST_POINTER_ARMS(void, void, -1, void_type) __FLORESTAN_TYPES(__CONST_POINTER_ARMS) default: 0)
+
+#define __SIZEOF_ARMS(NAME, T, INDEX, CLASS) __POINTER_ARMS(T, sizeof(T))
+#define __sizeof(...) _Generic((__VA_ARGS__), __POINTER_ARMS(void, 0) __FLORESTAN_TYPES(__SIZEOF_ARMS) default: sizeof(__VA_ARGS__))
+
+// The numbers are the same as they have always been: T is 1 + 2*INDEX,
+// and depth D pointers start at 31 + 64*(D-1) with 4 numbers per type (void first).
+// The numbers for "const T" and "T* const" are left unused, because those arms can never be picked.
+#define __TYPE_NUM_POINTER_ARMS(T, INDEX) \
+    T*: 35 + 4 * (INDEX),     const T*: 36 + 4 * (INDEX), \
+    T**: 99 + 4 * (INDEX),    const T**: 100 + 4 * (INDEX), \
+    T***: 163 + 4 * (INDEX),  const T***: 164 + 4 * (INDEX), \
+    T****: 227 + 4 * (INDEX), const T****: 228 + 4 * (INDEX),
+#define __TYPE_NUM_ARMS(NAME, T, INDEX, CLASS) T: 1 + 2 * (INDEX), __TYPE_NUM_POINTER_ARMS(T, INDEX)
+#define __type_num(...) _Generic((__VA_ARGS__), __TYPE_NUM_POINTER_ARMS(void, -1) __FLORESTAN_TYPES(__TYPE_NUM_ARMS) default: 0)
 
-#define __type_num(...) _Generic((__VA_ARGS__), \
-    bool: 1,                 const bool: 2, \
-    char: 3,                 const char: 4, \
-    short: 5,                const short: 6, \
-    int: 7,                  const int: 8, \
-    long: 9,                 const long: 10, \
-    long long: 11,           const long long: 12, \
-    double: 13,              const double: 14, \
-    float: 15,               const float: 16, \
-    long double: 17,         const long double: 18, \
-    signed char: 19,         const signed char: 20, \
-    unsigned char: 21,       const unsigned char: 22, \
-    unsigned short: 23,      const unsigned short: 24, \
-    unsigned int: 25,        const unsigned int: 26, \
-    unsigned long: 27,       const unsigned long: 28, \
-    unsigned long long: 29,  const unsigned long long: 30, \
-    void*: 31,               const void*: 32,               void* const: 33,               const void* const: 34, \
-    bool*: 35,               const bool*: 36,               bool* const: 37,               const bool* const: 38, \
-    char*: 39,               const char*: 40,               char* const: 41,               const char* const: 42, \
-    short*: 43,              const short*: 44,              short* const: 45,              const short* const: 46, \
-    int*: 47,                const int*: 48,                int* const: 49,                const int* const: 50, \
-    long*: 51,               const long*: 52,               long* const: 53,               const long* const: 54, \
-    long long*: 55,          const long long*: 56,          long long* const: 57,          const long long* const: 58, \
-    double*: 59,             const double*: 60,             double* const: 61,             const double* const: 62, \
-    float*: 63,              const float*: 64,              float* const: 65,              const float* const: 66, \
-    long double*: 67,        const long double*: 68,        long double* const: 69,        const long double* const: 70, \
-    signed char*: 71,        const signed char*: 72,        signed char* const: 73,        const signed char* const: 74, \
-    unsigned char*: 75,      const unsigned char*: 76,      unsigned char* const: 77,      const unsigned char* const: 78, \
-    unsigned short*: 79,     const unsigned short*: 80,     unsigned short* const: 81,     const unsigned short* const: 82, \
-    unsigned int*: 83,       const unsigned int*: 84,       unsigned int* const: 85,       const unsigned int* const: 86, \
-    unsigned long*: 87,      const unsigned long*: 88,      unsigned long* const: 89,      const unsigned long* const: 90, \
-    unsigned long long*: 91, const unsigned long long*: 92, unsigned long long* const: 93, const unsigned long long* const: 94, \
-    void**: 95,                const void**: 96,                void** const: 97,                const void** const: 98, \
-    bool**: 99,                const bool**: 100,               bool** const: 101,               const bool** const: 102, \
-    char**: 103,               const char**: 104,               char** const: 105,               const char** const: 106, \
-    short**: 107,              const short**: 108,              short** const: 109,              const short** const: 110, \
-    int**: 111,                const int**: 112,                int** const: 113,                const int** const: 114, \
-    long**: 115,               const long**: 116,               long** const: 117,               const long** const: 118, \
-    long long**: 119,          const long long**: 120,          long long** const: 121,          const long long** const: 122, \
-    double**: 123,             const double**: 124,             double** const: 125,             const double** const: 126, \
-    float**: 127,              const float**: 128,              float** const: 129,              const float** const: 130, \
-    long double**: 131,        const long double**: 132,        long double** const: 133,        const long double** const: 134, \
-    signed char**: 135,        const signed char**: 136,        signed char** const: 137,        const signed char** const: 138, \
-    unsigned char**: 139,      const unsigned char**: 140,      unsigned char** const: 141,      const unsigned char** const: 142, \
-    unsigned short**: 143,     const unsigned short**: 144,     unsigned short** const: 145,     const unsigned short** const: 146, \
-    unsigned int**: 147,       const unsigned int**: 148,       unsigned int** const: 149,       const unsigned int** const: 150, \
-    unsigned long**: 151,      const unsigned long**: 152,      unsigned long** const: 153,      const unsigned long** const: 154, \
-    unsigned long long**: 155, const unsigned long long**: 156, unsigned long long** const: 157, const unsigned long long** const: 158, \
-    void***: 159,               const void***: 160,               void*** const: 161,               const void*** const: 162, \
-    bool***: 163,               const bool***: 164,               bool*** const: 165,               const bool*** const: 166, \
-    char***: 167,               const char***: 168,               char*** const: 169,               const char*** const: 170, \
-    short***: 171,              const short***: 172,              short*** const: 173,              const short*** const: 174, \
-    int***: 175,                const int***: 176,                int*** const: 177,                const int*** const: 178, \
-    long***: 179,               const long***: 180,               long*** const: 181,               const long*** const: 182, \
-    long long***: 183,          const long long***: 184,          long long*** const: 185,          const long long*** const: 186, \
-    double***: 187,             const double***: 188,             double*** const: 189,             const double*** const: 190, \
-    float***: 191,              const float***: 192,              float*** const: 193,              const float*** const: 194, \
-    long double***: 195,        const long double***: 196,        long double*** const: 197,        const long double*** const: 198, \
-    signed char***: 199,        const signed char***: 200,        signed char*** const: 201,        const signed char*** const: 202, \
-    unsigned char***: 203,      const unsigned char***: 204,      unsigned char*** const: 205,      const unsigned char*** const: 206, \
-    unsigned short***: 207,     const unsigned short***: 208,     unsigned short*** const: 209,     const unsigned short*** const: 210, \
-    unsigned int***: 211,       const unsigned int***: 212,       unsigned int*** const: 213,       const unsigned int*** const: 214, \
-    unsigned long***: 215,      const unsigned long***: 216,      unsigned long*** const: 217,      const unsigned long*** const: 218, \
-    unsigned long long***: 219, const unsigned long long***: 220, unsigned long long*** const: 221, const unsigned long long*** const: 222, \
-    void****: 223,               const void****: 224,               void**** const: 225,               const void**** const: 226, \
-    bool****: 227,               const bool****: 228,               bool**** const: 229,               const bool**** const: 230, \
-    char****: 231,               const char****: 232,               char**** const: 233,               const char**** const: 234, \
-    short****: 235,              const short****: 236,              short**** const: 237,              const short**** const: 238, \
-    int****: 239,                const int****: 240,                int**** const: 241,                const int**** const: 242, \
-    long****: 243,               const long****: 244,               long**** const: 245,               const long**** const: 246, \
-    long long****: 247,          const long long****: 248,          long long**** const: 249,          const long long**** const: 250, \
-    double****: 251,             const double****: 252,             double**** const: 253,             const double**** const: 254, \
-    float****: 255,              const float****: 256,              float**** const: 257,              const float**** const: 258, \
-    long double****: 259,        const long double****: 260,        long double**** const: 261,        const long double**** const: 262, \
-    signed char****: 263,        const signed char****: 264,        signed char**** const: 265,        const signed char**** const: 266, \
-    unsigned char****: 267,      const unsigned char****: 268,      unsigned char**** const: 269,      const unsigned char**** const: 270, \
-    unsigned short****: 271,     const unsigned short****: 272,     unsigned short**** const: 273,     const unsigned short**** const: 274, \
-    unsigned int****: 275,       const unsigned int****: 276,       unsigned int**** const: 277,       const unsigned int**** const: 278, \
-    unsigned long****: 279,      const unsigned long****: 280,      unsigned long**** const: 281,      const unsigned long**** const: 282, \
-    unsigned long long****: 283, const unsigned long long****: 284, unsigned long long**** const: 285, const unsigned long long**** const: 286, \
-    default: 0 )
+#define type_id(...) __type_num(__VA_ARGS__)
+#define FLORESTAN_TYPE_COUNT 287
+
+typedef struct __type_descriptor {
+    const char* name;
+    size_t size;
+    unsigned char pointer_depth;
+    enum type_classes __ENUM_TYPE(unsigned char) { unknown_type, void_type, bool_type, integer_type, floating_type } type_class;
+    bool is_signed;
+    bool is_const;
+    bool is_const_pointer;
+} type_descriptor;
 
-#define printtype(...) printf("The type of the variable \"%s\": %s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s%s\n", #__VA_ARGS__, \
-    (__is_const(__VA_ARGS__)? "const " : ""), \
-    (__is_void(__VA_ARGS__)? "void" : ""), \
-    (__is_bool(__VA_ARGS__)? "bool" : ""), \
-    (__is_char(__VA_ARGS__)? "char" : ""), \
-    (__is_short(__VA_ARGS__)? "short" : ""), \
-    (__is_int(__VA_ARGS__)? "int" : ""), \
-    (__is_long(__VA_ARGS__)? "long" : ""), \
-    (__is_llong(__VA_ARGS__)? "long long" : ""), \
-    (__is_double(__VA_ARGS__)? "double" : ""), \
-    (__is_float(__VA_ARGS__)? "float" : ""), \
-    (__is_ldouble(__VA_ARGS__)? "long double" : ""), \
-    (__is_schar(__VA_ARGS__)? "signed char" : ""), \
-    (__is_uchar(__VA_ARGS__)? "unsigned char" : ""), \
-    (__is_ushort(__VA_ARGS__)? "unsigned short" : ""), \
-    (__is_uint(__VA_ARGS__)? "unsigned int" : ""), \
-    (__is_ulong(__VA_ARGS__)? "unsigned long" : ""), \
-    (__is_ullong(__VA_ARGS__)? "unsigned long long" : ""), \
-    (__pointer_depth(__VA_ARGS__) == 1? " *" : (__pointer_depth(__VA_ARGS__) == 2? " **" : (__pointer_depth(__VA_ARGS__) == 3? " ***" : ""))), \
+// One row per type_id, built from the same list as the _Generic tables.
+// The rows for "const T" and "T* const" are filled too, so the table has no holes.
+#define __DESCRIPTOR_QUAD(NAME, SIZE, DEPTH, CLASS, SIGNED, ID) \
+    [ID]     = { NAME,                   SIZE, DEPTH, CLASS, SIGNED, false, false }, \
+    [ID + 1] = { "const " NAME,          SIZE, DEPTH, CLASS, SIGNED, true,  false }, \
+    [ID + 2] = { NAME " const",          SIZE, DEPTH, CLASS, SIGNED, false, true  }, \
+    [ID + 3] = { "const " NAME " const", SIZE, DEPTH, CLASS, SIGNED, true,  true  },
+#define __DESCRIPTOR_POINTERS(NAME, SIZE, CLASS, SIGNED, INDEX) \
+    __DESCRIPTOR_QUAD(NAME " *",    SIZE, 1, CLASS, SIGNED, 35 + 4 * (INDEX)) \
+    __DESCRIPTOR_QUAD(NAME " **",   SIZE, 2, CLASS, SIGNED, 99 + 4 * (INDEX)) \
+    __DESCRIPTOR_QUAD(NAME " ***",  SIZE, 3, CLASS, SIGNED, 163 + 4 * (INDEX)) \
+    __DESCRIPTOR_QUAD(NAME " ****", SIZE, 4, CLASS, SIGNED, 227 + 4 * (INDEX))
+#define __DESCRIPTOR_ROWS(NAME, T, INDEX, CLASS) \
+    [1 + 2 * (INDEX)] = { #T,          sizeof(T), 0, CLASS, ((T)-1 < (T)1), false, false }, \
+    [2 + 2 * (INDEX)] = { "const " #T, sizeof(T), 0, CLASS, ((T)-1 < (T)1), true,  false }, \
+    __DESCRIPTOR_POINTERS(#T, sizeof(T), CLASS, ((T)-1 < (T)1), INDEX)
+static const type_descriptor __type_descriptors[FLORESTAN_TYPE_COUNT] = {
+    [0] = { "", 0, 0, unknown_type, false, false, false },
+    __DESCRIPTOR_POINTERS("void", 0, void_type, false, -1)
+    __FLORESTAN_TYPES(__DESCRIPTOR_ROWS)
+};
+#define type_info(...) (__type_descriptors[__type_num(__VA_ARGS__)])
+#define type_name(...) (__type_descriptors[__type_num(__VA_ARGS__)].name)
+
+// type_name already spells the pointee's const and the stars; only the variable's own qualifiers need (&VARIABLE).
+#define printtype(...) printf("The type of the variable \"%s\": %s%s%s\n", #__VA_ARGS__, \
+    (__is_const_object(__VA_ARGS__)? "const " : ""), \
+    type_name(__VA_ARGS__), \
     (__is_const_pointer(__VA_ARGS__)? " const" : ""))
 
+#if defined(FLORESTAN_SIZED_ALLOC) && !defined(alloc_sizeof)
+    #define alloc_sizeof(p) __sized_sizeof((const void*)(p))
+#endif
 #ifndef alloc_sizeof
     #if defined(__linux__)
         #include <malloc.h>
@@ -604,19 +227,28 @@ default: sizeof(__VA_ARGS__) )
     #endif
 #endif
 #define __fixed_arraysize(x) ((size_t)sizeof(x) / (size_t)sizeof(x[0]))
-#define __is_allocated(x) (alloc_sizeof(x) > 0)
+// A fixed array never reaches alloc_sizeof: it is no block of the allocator, and SIZED_ALLOC would read a header before it.
+#define __is_allocated(x) (!__is_fixed_array(x) && alloc_sizeof(x) > 0)
 #define __is_fixed_array(x)  ((size_t)sizeof(x) != (size_t)sizeof(void*))
 // Node: the checking method of __is_fixed_array(x) CONFUSES the cases of fixed 8-byte arrays like char[8], short[4], and int[2],
 // because it is ambiguous that 8 bytes are the same size of one pointer variable.
 // But, you must already know what kind of 8-byte array you have!
 
+#define __ALIGNMENT_LIMIT 4096 // a page; no load or store cares about more
+static inline size_t __address_alignment(const void* p) {
+    uintptr_t address = (uintptr_t)p | __ALIGNMENT_LIMIT;
+    return p == NULL ? 0 : (size_t)(address & (0 - address));
+}
+
 typedef struct __allocated_record {
     const char* name;
-    enum methods: unsigned char { dynamic, allocated, fixed } method;
+    enum methods __ENUM_TYPE(unsigned char) { dynamic, allocated, fixed, arena, mapped, slab, ndarray, bitset, ring } method;
     unsigned char pointer_depth;
     size_t typesize;
     size_t totalsize;
     size_t arraysize;
+    size_t alignment;
+    const struct __ndarray_shape* shape;
 } allocated_record;
 #define __make_allocated_record(...) ((allocated_record){ \
     #__VA_ARGS__, \
@@ -624,7 +256,79 @@ typedef struct __allocated_record {
     __pointer_depth(__VA_ARGS__), \
     (__is_fixed_array(__VA_ARGS__) ? sizeof(*__VA_ARGS__) : __sizeof(*__VA_ARGS__)), \
     (__is_fixed_array(__VA_ARGS__) ? sizeof(__VA_ARGS__) : alloc_sizeof(__VA_ARGS__)), \
-    (__is_fixed_array(__VA_ARGS__) ? __fixed_arraysize(__VA_ARGS__) : alloc_sizeof(__VA_ARGS__) / __sizeof(*__VA_ARGS__)) })
-#define allocated_info(...) __make_allocated_record(__VA_ARGS__)
+    (__is_fixed_array(__VA_ARGS__) ? __fixed_arraysize(__VA_ARGS__) : alloc_sizeof(__VA_ARGS__) / __sizeof(*__VA_ARGS__)), \
+    __address_alignment((const void*)(__VA_ARGS__)), \
+    NULL })
+
+// The handle of <florestan/bitset.h> lives here, so allocated_info() can tell it from any other pointer.
+typedef struct __bitset_array {
+    size_t size; // bits
+    uint64_t* words;
+} bitset_array;
+#define __is_bitset(...) _Generic((__VA_ARGS__), bitset_array*: 1, const bitset_array*: 1, default: 0)
+static inline allocated_record __make_bitset_record(const char* name, const bitset_array* b) {
+    if (b == NULL) return (allocated_record){ name, dynamic, 1, 0, 0, 0, 0, NULL };
+    size_t totalsize = (b->size + 63) / 64 * sizeof(uint64_t);
+    return (allocated_record){ name, bitset, 1, 0, totalsize, b->size, __address_alignment(b->words), NULL };
+}
+#define __allocated_info_bitset(...) __make_bitset_record(#__VA_ARGS__, (const bitset_array*)(__VA_ARGS__))
+
+// The handles of <florestan/ring.h> start with a ring_shape, and are complete only there.
+typedef struct __ring_shape {
+    size_t capacity;
+    size_t typesize;
+} ring_shape;
+struct __spsc_ring;
+struct __mpmc_ring;
+#define __is_ring(...) _Generic((__VA_ARGS__), struct __spsc_ring*: 1, const struct __spsc_ring*: 1, \
+    struct __mpmc_ring*: 1, const struct __mpmc_ring*: 1, default: 0)
+static inline allocated_record __make_ring_record(const char* name, const ring_shape* shape) {
+    if (shape == NULL) return (allocated_record){ name, dynamic, 1, 0, 0, 0, 0, NULL };
+    return (allocated_record){ name, ring, 1, shape->typesize, shape->capacity * shape->typesize, shape->capacity, __address_alignment(shape), NULL };
+}
+
+// Handles that are not arrays of their pointee, so allocated_info() reads their own fields instead.
+#define __is_handle(...) (__is_bitset(__VA_ARGS__) || __is_ring(__VA_ARGS__))
+#define __allocated_info_handle(...) (__is_bitset(__VA_ARGS__) ? __allocated_info_bitset(__VA_ARGS__) : \
+    __make_ring_record(#__VA_ARGS__, (const ring_shape*)(__VA_ARGS__)))
+
+#ifdef FLORESTAN_SIZED_ALLOC
+#include "sized_alloc.h"
+#endif
+
+#ifdef FLORESTAN_TRACKED_ALLOC
+#include "alloc_registry.h"
+#include "counters.h"
+// Never calls alloc_sizeof on a registered pointer, because an interior pointer would crash the OS allocator.
+static inline allocated_record __lookup_tracked_record(const char* name, const void* p, unsigned char pointer_depth, size_t typesize) {
+    allocated_block block;
+    if (__registry_lookup(p, &block)) {
+        size_t offset = (size_t)((const char*)p - (const char*)block.base);
+        if (typesize == 0) typesize = block.typesize;
+        return (allocated_record){ name, block.method, pointer_depth, typesize, block.size - offset, typesize ? (block.size - offset) / typesize : 0, __address_alignment(p), block.shape };
+    }
+    size_t totalsize = alloc_sizeof(p);
+    return (allocated_record){ name, (totalsize > 0 ? allocated : dynamic), pointer_depth, typesize, totalsize, typesize ? totalsize / typesize : 0, __address_alignment(p), NULL };
+}
+static inline allocated_record __make_tracked_record(const char* name, const void* p, unsigned char pointer_depth, size_t typesize) {
+    __COUNTER_BEGIN("allocated_info", "")
+    allocated_record record = __lookup_tracked_record(name, p, pointer_depth, typesize);
+    __COUNTER_END(0);
+    return record;
+}
+#define allocated_info(...) (__is_handle(__VA_ARGS__) ? __allocated_info_handle(__VA_ARGS__) : __is_fixed_array(__VA_ARGS__) ? \
+    (allocated_record){ #__VA_ARGS__, fixed, __pointer_depth(__VA_ARGS__), sizeof(*(__VA_ARGS__)), sizeof(__VA_ARGS__), (size_t)sizeof(__VA_ARGS__) / (size_t)sizeof(*(__VA_ARGS__)), \
+        __address_alignment((const void*)(__VA_ARGS__)), NULL } : \
+    __make_tracked_record(#__VA_ARGS__, (const void*)(__VA_ARGS__), __pointer_depth(__VA_ARGS__), \
+        _Generic((__VA_ARGS__), void*: 0, const void*: 0, default: __sizeof(*(__VA_ARGS__)))))
+#elif defined(FLORESTAN_SIZED_ALLOC)
+#define allocated_info(...) (__is_handle(__VA_ARGS__) ? __allocated_info_handle(__VA_ARGS__) : __is_fixed_array(__VA_ARGS__) ? \
+    (allocated_record){ #__VA_ARGS__, fixed, __pointer_depth(__VA_ARGS__), sizeof(*(__VA_ARGS__)), sizeof(__VA_ARGS__), (size_t)sizeof(__VA_ARGS__) / (size_t)sizeof(*(__VA_ARGS__)), \
+        __address_alignment((const void*)(__VA_ARGS__)), NULL } : \
+    __make_sized_record(#__VA_ARGS__, (const void*)(__VA_ARGS__), __pointer_depth(__VA_ARGS__), \
+        _Generic((__VA_ARGS__), void*: 0, const void*: 0, default: __sizeof(*(__VA_ARGS__)))))
+#else
+#define allocated_info(...) (__is_handle(__VA_ARGS__) ? __allocated_info_handle(__VA_ARGS__) : __make_allocated_record(__VA_ARGS__))
+#endif
 
 #endif
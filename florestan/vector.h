@@ -0,0 +1,108 @@
+// Florestan's Vector
+//
+// © dongwanpianist
+//
+// A growable array of any element type, for append-heavy buffers.
+// The allocator usually hands out a little more than was asked for (alloc_sizeof tells how much),
+// so the vector counts that slack as capacity and only calls realloc once it is really full.
+// Growth is geometric (twice the capacity), so pushing n elements copies O(n) elements in total.
+//
+// 1. vector(TYPE)      -> an anonymous struct type; start it empty with = {0}
+//      .data           (TYPE*) NULL while the vector owns no memory
+//      .length         (size_t)
+//      .capacity       (size_t) elements that fit before the next realloc, slack included
+// 2. vector_push(VECTOR_POINTER, VALUE) -> bool
+//      * false when out of memory, and the vector is left as it was
+// 3. vector_pop(VECTOR_POINTER) -> TYPE
+//      * the vector must not be empty
+// 4. vector_reserve(VECTOR_POINTER, COUNT) -> bool
+//      * makes room for COUNT elements in total, not COUNT more
+// 5. vector_shrink(VECTOR_POINTER) -> bool
+//      * gives back the memory beyond .length (the allocator may still keep some slack)
+// 6. vector_free(VECTOR_POINTER)
+// 7. allocated_info(VECTOR.data) -> allocated_record
+//      * .arraysize is the capacity, because .data is always the start of its own block
+//      * with FLORESTAN_TRACKED_ALLOC, the block is registered with its capacity and element size
+//      * with FLORESTAN_SIZED_ALLOC, the block comes from <florestan/sized_alloc.h>, so the capacity has no slack
+//
+// VECTOR_POINTER is evaluated more than once; VALUE and COUNT are evaluated once.
+
+#ifndef FLORESTAN_VECTOR_H
+#define FLORESTAN_VECTOR_H
+#include "type_traits.h"
+#include "heap_profile.h"
+#include <stdint.h>
+#include <string.h>
+
+#define vector(T) struct { T* data; size_t length; size_t capacity; }
+
+// data points at the vector's .data, whatever its element type, so it is read and written through memcpy.
+// Returns false, leaving the vector untouched, when realloc fails.
+static inline bool __vector_resize(void* data, size_t* capacity, size_t typesize, size_t count) {
+    void* old;
+    memcpy(&old, data, sizeof old);
+    if (count > SIZE_MAX / typesize) return false;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    if (old) __registry_remove(old);
+#endif
+#ifdef FLORESTAN_SIZED_ALLOC
+    void* block = __sized_resize(old, count, typesize, 0);
+#else
+    void* block = realloc(old, count * typesize);
+#endif
+    if (block == NULL) {
+#ifdef FLORESTAN_TRACKED_ALLOC
+        if (old) __registry_insert(old, *capacity * typesize, typesize, allocated, NULL);
+#endif
+        return false;
+    }
+    size_t usable = alloc_sizeof(block) / typesize;
+    *capacity = usable > count ? usable : count;
+#ifdef FLORESTAN_TRACKED_ALLOC
+    __registry_insert(block, *capacity * typesize, typesize, allocated, NULL);
+#endif
+    memcpy(data, &block, sizeof block);
+    return true;
+}
+
+// Slow path of vector_reserve: the current capacity, slack included, is too small.
+static inline bool __vector_grow(void* data, size_t* capacity, size_t typesize, size_t count, const char* site) {
+    size_t grown = *capacity > SIZE_MAX / 2 ? SIZE_MAX : *capacity * 2;
+    if (grown < 8) grown = 8;
+    if (!__vector_resize(data, capacity, typesize, count > grown ? count : grown)) return false;
+    __heap_profile_note(*capacity * typesize, typesize, allocated, site);
+    return true;
+}
+
+#define vector_reserve(v, count) __vector_reserve((void*)&(v)->data, &(v)->capacity, sizeof(*(v)->data), (count), FLORESTAN_CALL_SITE)
+static inline bool __vector_reserve(void* data, size_t* capacity, size_t typesize, size_t count, const char* site) {
+    return count <= *capacity || __vector_grow(data, capacity, typesize, count, site);
+}
+
+#define vector_push(v, value) (vector_reserve((v), (v)->length + 1) ? ((v)->data[(v)->length++] = (value), true) : false)
+#define vector_pop(v) ((v)->data[--(v)->length])
+
+#define vector_shrink(v) __vector_shrink((void*)&(v)->data, &(v)->length, &(v)->capacity, sizeof(*(v)->data))
+static inline bool __vector_shrink(void* data, const size_t* length, size_t* capacity, size_t typesize) {
+    if (*length == 0) {
+        void* old;
+        memcpy(&old, data, sizeof old);
+#ifdef FLORESTAN_TRACKED_ALLOC
+        if (old) __registry_remove(old);
+#endif
+#ifdef FLORESTAN_SIZED_ALLOC
+        __sized_free(old);
+#else
+        free(old);
+#endif
+        old = NULL;
+        memcpy(data, &old, sizeof old);
+        *capacity = 0;
+        return true;
+    }
+    return *length == *capacity || __vector_resize(data, capacity, typesize, *length);
+}
+
+#define vector_free(v) ((v)->length = 0, (void)vector_shrink(v))
+
+#endif
@@ -0,0 +1,57 @@
+// Florestan's Tests
+//
+// © dongwanpianist
+//
+// Every test_<name>.c is one executable for ctest: main() runs its checks, and returns nonzero if any failed.
+// Each element type is checked on its own, against a plain loop written out in the test.
+//
+// 1. CHECK(CONDITION)
+//      * prints the file, line and condition when it is false, and counts the failure; the test goes on
+// 2. TEST_TYPES(X, ...)
+//      * X(NAME, TYPE, ...) for the 14 element types the array_* functions support
+// 3. TEST_RESULT -> int
+//      * what main() returns: EXIT_SUCCESS when every CHECK held
+// 4. test_random(STATE_POINTER) -> uint64_t
+//      * splitmix64, the same numbers in every run for one seed
+
+#ifndef FLORESTAN_TEST_H
+#define FLORESTAN_TEST_H
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+static int __test_failures;
+
+#define CHECK(...) do { \
+    if (!(__VA_ARGS__)) { \
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #__VA_ARGS__); \
+        __test_failures++; \
+    } \
+} while (0)
+#define TEST_RESULT (__test_failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#define TEST_TYPES(X, ...) \
+    X(char,    char,               __VA_ARGS__) \
+    X(schar,   signed char,        __VA_ARGS__) \
+    X(uchar,   unsigned char,      __VA_ARGS__) \
+    X(short,   short,              __VA_ARGS__) \
+    X(ushort,  unsigned short,     __VA_ARGS__) \
+    X(int,     int,                __VA_ARGS__) \
+    X(uint,    unsigned int,       __VA_ARGS__) \
+    X(long,    long,               __VA_ARGS__) \
+    X(ulong,   unsigned long,      __VA_ARGS__) \
+    X(llong,   long long,          __VA_ARGS__) \
+    X(ullong,  unsigned long long, __VA_ARGS__) \
+    X(float,   float,              __VA_ARGS__) \
+    X(double,  double,             __VA_ARGS__) \
+    X(ldouble, long double,        __VA_ARGS__)
+
+static inline uint64_t test_random(uint64_t* state) {
+    uint64_t z = (*state += 0x9E3779B97F4A7C15u);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9u;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBu;
+    return z ^ (z >> 31);
+}
+
+#endif
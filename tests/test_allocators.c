@@ -0,0 +1,98 @@
+// Florestan's Tests: allocators
+//
+// The arena, slab, aligned, ndarray and array file allocators in the default mode, where allocated_info() only
+// asks the OS allocator; test_tracked.c checks what they report with FLORESTAN_TRACKED_ALLOC.
+
+#include "test.h"
+#include "florestan/arena.h"
+#include "florestan/slab.h"
+#include "florestan/aligned_array.h"
+#include "florestan/ndarray.h"
+#include "florestan/array_file.h"
+#include <stdint.h>
+#include <string.h>
+
+typedef struct __test_node {
+    struct __test_node* next;
+    double value;
+} test_node;
+typedef struct __test_big {
+    char bytes[5000];
+} test_big;
+
+int main(void) {
+    memory_arena arena;
+    arena_init(&arena, 4096);
+    for (int round = 0; round < 3; round++) {
+        char* last = NULL;
+        for (int i = 0; i < 500; i++) {
+            int* block = arena_new(&arena, int, (size_t)i % 37 + 1);
+            CHECK(block && (uintptr_t)block % _Alignof(max_align_t) == 0 && (char*)block != last);
+            for (int j = 0; j < i % 37 + 1; j++) block[j] = j;
+            last = (char*)block;
+        }
+        CHECK(arena_new(&arena, char, 100000) != NULL);
+        arena_reset(&arena);
+    }
+    arena_destroy(&arena);
+
+    test_node* nodes[1000];
+    for (int i = 0; i < 1000; i++) {
+        nodes[i] = slab_new(test_node);
+        CHECK(nodes[i] != NULL && (uintptr_t)nodes[i] % _Alignof(test_node) == 0);
+        nodes[i]->value = i;
+    }
+    bool distinct = true;
+    for (int i = 1; i < 1000; i++) distinct = distinct && nodes[i] != nodes[i - 1] && nodes[i - 1]->value == i - 1;
+    CHECK(distinct);
+    for (int i = 0; i < 1000; i++) slab_free(nodes[i]);
+    test_big* big = slab_new(test_big);
+    CHECK(big != NULL);
+    slab_free(big);
+    // a slab of pointers goes back to the size class of the pointer, which the next slab_new of it takes again
+    char** cell = slab_new(char*);
+    CHECK(cell != NULL);
+    slab_free(cell);
+    CHECK(slab_new(char*) == cell);
+    slab_free(cell);
+
+    for (size_t alignment = 1; alignment <= 4096; alignment *= 2) {
+        double* a = aligned_array_alloc(double, 100, alignment);
+        CHECK(a && (uintptr_t)a % alignment == 0 && allocated_info(a).alignment >= alignment);
+        aligned_array_free(a);
+    }
+    CHECK(aligned_array_alloc(int, 4, 24) == NULL);
+    CHECK(aligned_array_alloc(double, 4, 3) == NULL && aligned_array_calloc(double, 4, 0) == NULL);
+    float* zeros = aligned_array_calloc(float, 1000, 64);
+    CHECK(zeros && zeros[999] == 0);
+    aligned_array_free(zeros);
+
+    int*** cube = ndarray_alloc(int, 3, 4, 5);
+    CHECK(cube != NULL);
+    for (int i = 0; i < 3; i++) for (int j = 0; j < 4; j++) for (int k = 0; k < 5; k++) cube[i][j][k] = i * 100 + j * 10 + k;
+    const ndarray_shape* shape = ndarray_info(cube);
+    CHECK(shape && shape->rank == 3 && shape->count == 60 && shape->strides[0] == 20 && shape->strides[2] == 1);
+    CHECK(((int*)ndarray_data(cube))[1 * 20 + 2 * 5 + 3] == 123);
+    ndarray_free(cube);
+    CHECK(ndarray_info((int**)NULL) == NULL && ndarray_data((int**)NULL) == NULL);
+
+    char path[] = "/tmp/florestan_test_XXXXXX";
+    int descriptor = mkstemp(path);
+    CHECK(descriptor >= 0);
+    close(descriptor);
+    long long values[300];
+    for (int i = 0; i < 300; i++) values[i] = (long long)i * i - 5000;
+    CHECK(array_save(path, values));
+    const long long* mapped = array_map(path, long long);
+    CHECK(mapped && array_mapped_count(mapped) == 300 && memcmp(mapped, values, sizeof values) == 0);
+    CHECK(array_map(path, double) == NULL);
+    array_unmap(mapped);
+    // a file of pointers records the size of a pointer, which array_map checks against its own type
+    const char* words[3] = { "one", "two", "three" };
+    CHECK(array_save(path, words));
+    const char* const* reloaded = array_map(path, const char*);
+    CHECK(reloaded && array_mapped_count(reloaded) == 3);
+    array_unmap(reloaded);
+    remove(path);
+    return TEST_RESULT;
+}
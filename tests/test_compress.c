@@ -0,0 +1,48 @@
+// Florestan's Tests: compression
+//
+// Round trips of every type: a smooth series, random bits, and lengths around the 256-element blocks.
+
+#include "test.h"
+#include "florestan/array_compress.h"
+#include <string.h>
+
+#define __TEST_COMPRESS(NAME, T, ...) { \
+    static const size_t sizes[] = { 0, 1, 9, 255, 256, 257, 1000, 4096 }; \
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) { \
+        for (int random = 0; random < 2; random++) { \
+            size_t n = sizes[k]; \
+            uint64_t state = n; \
+            T* a = calloc(n ? n : 1, sizeof(T)); \
+            T* back = calloc(n ? n : 1, sizeof(T)); \
+            for (size_t i = 0; i < n; i++) { \
+                uint64_t bits = test_random(&state); \
+                if (!random) a[i] = (T)(i / 7 % 50 + i % 3); \
+                else if ((T)0.5) a[i] = (T)(long long)bits; \
+                else memcpy(&a[i], &bits, sizeof(T) < sizeof bits ? sizeof(T) : sizeof bits); \
+            } \
+            size_t bound = array_compress_bound(a, n); \
+            unsigned char* buffer = malloc(bound); \
+            size_t size = array_compress(buffer, a, n); \
+            CHECK(size > 0 && size <= bound); \
+            CHECK(array_compressed_count(buffer) == n && array_compressed_size(buffer) == size); \
+            CHECK(array_decompress(back, buffer, size)); \
+            CHECK(memcmp(a, back, n * sizeof(T)) == 0); \
+            if (size > 0) CHECK(!array_decompress(back, buffer, size - 1)); \
+            free(buffer); \
+            free(a); \
+            free(back); \
+        } \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_COMPRESS, )
+    int ramp[1024];
+    for (int i = 0; i < 1024; i++) ramp[i] = 1000 + i;
+    unsigned char buffer[8192];
+    size_t size = array_compress(buffer, ramp);
+    CHECK(size < sizeof ramp / 8);
+    float wrong[1024];
+    CHECK(!array_decompress(wrong, buffer, size));
+    return TEST_RESULT;
+}
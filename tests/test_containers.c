@@ -0,0 +1,83 @@
+// Florestan's Tests: vector, rings and bitsets
+
+#include "test.h"
+#include "florestan/vector.h"
+#include "florestan/ring.h"
+#include "florestan/bitset.h"
+
+#define __TEST_VECTOR(NAME, T, ...) { \
+    vector(T) v = { 0 }; \
+    bool right = true; \
+    for (int i = 0; i < 1000; i++) right = right && vector_push(&v, (T)(i % 100)); \
+    CHECK(right && v.length == 1000 && v.capacity >= 1000); \
+    CHECK(allocated_info(v.data).arraysize >= v.length); \
+    for (int i = 999; i >= 500; i--) right = right && vector_pop(&v) == (T)(i % 100); \
+    CHECK(right && v.length == 500); \
+    CHECK(vector_shrink(&v) && v.capacity >= 500 && v.data[499] == (T)99); \
+    vector_free(&v); \
+    CHECK(v.length == 0); \
+}
+
+#define __TEST_RING(NAME, T, ...) { \
+    spsc_ring* s = ring_new(T, 5); \
+    mpmc_ring* m = ring_new_mpmc(T, 5); \
+    CHECK(s && m && allocated_info(s).arraysize == 8 && allocated_info(m).typesize == sizeof(T)); \
+    T in[20], out[20]; \
+    for (int i = 0; i < 20; i++) in[i] = (T)i; \
+    CHECK(ring_push_batch(s, in, 20) == 8 && ring_push_batch(m, in, 20) == 8); \
+    CHECK(!ring_push(s, &in[0]) && ring_size(s) == 8); \
+    CHECK(ring_pop_batch(s, out, 3) == 3 && out[2] == (T)2); \
+    T one; \
+    CHECK(ring_pop(m, &one) && one == (T)0); \
+    CHECK(ring_pop_batch(m, out, 20) == 7 && out[6] == (T)7 && !ring_pop(m, &one)); \
+    int wrong = 0; \
+    if (sizeof(int) != sizeof(T)) CHECK(!ring_push(s, &wrong)); \
+    ring_free(s); \
+    ring_free(m); \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_VECTOR, )
+    TEST_TYPES(__TEST_RING, )
+
+    // the elements of a vector of pointers are the pointers themselves, not what they point to
+    vector(const char*) words = { 0 };
+    CHECK(vector_push(&words, "one") && vector_push(&words, "two") && vector_shrink(&words));
+    CHECK(words.capacity * sizeof(const char*) <= alloc_sizeof(words.data) && words.data[1][0] == 't');
+    vector_free(&words);
+    // a ring of pointers moves the pointers, so its element size is the pointer's
+    spsc_ring* names = ring_new(const char*, 4);
+    const char* name = "ring";
+    CHECK(names && ring_push(names, &name) && ring_pop(names, &name) && name[0] == 'r');
+    ring_free(names);
+
+    enum { bits = 1000 };
+    bool flags[bits];
+    uint64_t state = 9;
+    for (size_t i = 0; i < bits; i++) flags[i] = test_random(&state) % 5 == 0;
+    bitset_array* b = bitset_from_bools(flags);
+    bitset_array* c = bitset_new(bits);
+    CHECK(b && c && allocated_info(b).arraysize == bits && allocated_info(b).method == bitset);
+    size_t count = 0, first = bits;
+    bool right = true;
+    for (size_t i = 0; i < bits; i++) {
+        right = right && bitset_get(b, i) == flags[i];
+        if (flags[i] && first == bits) first = i;
+        if (flags[i]) right = right && bitset_select(b, count) == i;
+        count += flags[i];
+    }
+    CHECK(right && bitset_count(b) == count && bitset_find_first(b) == first && bitset_select(b, count) == bits);
+    CHECK(bitset_find_first(b, first + 1) > first);
+    for (size_t i = 0; i < bits; i += 3) bitset_set(c, i);
+    bitset_and(c, c, b);
+    size_t both = 0;
+    for (size_t i = 0; i < bits; i += 3) both += flags[i];
+    CHECK(bitset_count(c) == both);
+    bitset_xor(c, c, c);
+    CHECK(bitset_count(c) == 0 && !bitset_get(c, bits));
+    bitset_set(c, bits);
+    CHECK(bitset_count(c) == 0);
+    bitset_free(b);
+    bitset_free(c);
+    return TEST_RESULT;
+}
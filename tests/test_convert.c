@@ -0,0 +1,52 @@
+// Florestan's Tests: conversions
+//
+// Every pair of types on values that fit all of them, then the saturating edges of the pairs with vector kernels.
+
+#include "test.h"
+#include "florestan/array_convert.h"
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+
+#define __TEST_CONVERT_PAIR(D, S) { \
+    enum { n = 77 }; \
+    S source[n]; \
+    D destination[n], saturated[n]; \
+    for (size_t i = 0; i < n; i++) source[i] = (S)(i * 37 % 100); \
+    array_convert(destination, source, n); \
+    array_convert_saturate(saturated, source, n); \
+    bool same = true; \
+    for (size_t i = 0; i < n; i++) same = same && destination[i] == (D)source[i] && saturated[i] == (D)source[i]; \
+    CHECK(same); \
+}
+#define __TEST_CONVERT_ROW(NAME, D, ...) \
+    __TEST_CONVERT_PAIR(D, char) __TEST_CONVERT_PAIR(D, signed char) __TEST_CONVERT_PAIR(D, unsigned char) \
+    __TEST_CONVERT_PAIR(D, short) __TEST_CONVERT_PAIR(D, unsigned short) __TEST_CONVERT_PAIR(D, int) \
+    __TEST_CONVERT_PAIR(D, unsigned int) __TEST_CONVERT_PAIR(D, long) __TEST_CONVERT_PAIR(D, unsigned long) \
+    __TEST_CONVERT_PAIR(D, long long) __TEST_CONVERT_PAIR(D, unsigned long long) __TEST_CONVERT_PAIR(D, float) \
+    __TEST_CONVERT_PAIR(D, double) __TEST_CONVERT_PAIR(D, long double)
+
+int main(void) {
+    TEST_TYPES(__TEST_CONVERT_ROW, )
+
+    float floats[40];
+    int ints[40];
+    for (int i = 0; i < 40; i++) floats[i] = i % 4 == 0 ? 3e9f : i % 4 == 1 ? -3e9f : i % 4 == 2 ? NAN : (float)i - 20.5f;
+    array_convert_saturate(ints, floats, 40);
+    for (int i = 0; i < 40; i++) {
+        int expected = i % 4 == 0 ? INT_MAX : i % 4 == 1 ? INT_MIN : i % 4 == 2 ? 0 : (int)((float)i - 20.5f);
+        CHECK(ints[i] == expected);
+    }
+    short shorts[40];
+    for (int i = 0; i < 40; i++) ints[i] = (i - 20) * 4000;
+    array_convert_saturate(shorts, ints, 40);
+    for (int i = 0; i < 40; i++) CHECK(shorts[i] == (ints[i] > SHRT_MAX ? SHRT_MAX : ints[i] < SHRT_MIN ? SHRT_MIN : ints[i]));
+    double doubles[40] = { 1e300, -1e300, INFINITY };
+    array_convert_saturate(floats, doubles, 40);
+    CHECK(floats[0] == FLT_MAX && floats[1] == -FLT_MAX && floats[2] == INFINITY && floats[3] == 0);
+    unsigned char bytes[40];
+    for (int i = 0; i < 40; i++) ints[i] = i * 10 - 100;
+    array_convert_saturate(bytes, ints, 40);
+    for (int i = 0; i < 40; i++) CHECK(bytes[i] == (ints[i] < 0 ? 0 : ints[i] > UCHAR_MAX ? UCHAR_MAX : ints[i]));
+    return TEST_RESULT;
+}
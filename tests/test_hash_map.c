@@ -0,0 +1,65 @@
+// Florestan's Tests: hash maps
+//
+// Inserts, finds and erases of every key type against a plain array of what should be there,
+// through several rehashes and with enough erasing to leave deleted slots behind.
+
+#include "test.h"
+#include "florestan/hash_map.h"
+
+#define __TEST_HASH_MAP(NAME, T, ...) { \
+    enum { keys = 100 }; \
+    hash_map(T, int) map = { 0 }; \
+    int expected[keys]; \
+    for (int i = 0; i < keys; i++) expected[i] = -1; \
+    uint64_t state = sizeof(T); \
+    bool right = true; \
+    for (int step = 0; step < 3000; step++) { \
+        int key = (int)(test_random(&state) % keys); \
+        if (step % 3 == 2) { \
+            right = right && hash_map_erase(&map, (T)key) == (expected[key] >= 0); \
+            expected[key] = -1; \
+        } else { \
+            right = right && hash_map_insert(&map, (T)key, step); \
+            expected[key] = step; \
+        } \
+    } \
+    size_t present = 0; \
+    for (int key = 0; key < keys; key++) { \
+        size_t slot = hash_map_find(&map, (T)key); \
+        right = right && (expected[key] < 0 ? slot == map.capacity : slot < map.capacity && map.values[slot] == expected[key]); \
+        present += expected[key] >= 0; \
+    } \
+    CHECK(right && map.count == present); \
+    size_t walked = 0; \
+    for (size_t i = 0; i < map.capacity; i++) if (hash_map_occupied(&map, i)) walked++; \
+    CHECK(walked == present); \
+    T batch[keys]; \
+    int values[keys]; \
+    size_t slots[keys]; \
+    for (int i = 0; i < keys; i++) { batch[i] = (T)i; values[i] = i; } \
+    CHECK(hash_map_insert_batch(&map, batch, values, keys)); \
+    CHECK(hash_map_find_batch(&map, batch, slots, keys) == keys); \
+    right = true; \
+    for (int i = 0; i < keys; i++) right = right && map.values[slots[i]] == i; \
+    CHECK(right && map.count == keys); \
+    hash_map_free(&map); \
+    CHECK(map.count == 0 && map.capacity == 0 && !hash_map_contains(&map, (T)1)); \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_HASH_MAP, )
+    hash_map(double, char) signs = { 0 };
+    CHECK(hash_map_insert(&signs, 0.0, 'z') && hash_map_insert(&signs, -0.0, 'n'));
+    CHECK(signs.count == 1 && signs.values[hash_map_find(&signs, 0.0)] == 'n');
+    CHECK(hash_map_reserve(&signs, 1000) && signs.growth >= 999);
+    hash_map_free(&signs);
+    // pointer values keep all their bytes through the rehashes
+    static const char* const words[] = { "zero", "one", "two", "three" };
+    hash_map(int, const char*) names = { 0 };
+    bool right = true;
+    for (int i = 0; i < 500; i++) right = right && hash_map_insert(&names, i, words[i % 4]);
+    for (int i = 0; i < 500; i++) right = right && names.values[hash_map_find(&names, i)] == words[i % 4];
+    CHECK(right && names.count == 500);
+    hash_map_free(&names);
+    return TEST_RESULT;
+}
@@ -0,0 +1,47 @@
+// Florestan's Tests: layouts
+//
+// Shapes that are not multiples of the 8 x 8 tiles, and records of 1 to 9 fields.
+
+#include "test.h"
+#include "florestan/array_layout.h"
+
+#define __TEST_LAYOUT(NAME, T, ...) { \
+    static const size_t shapes[][2] = { { 1, 1 }, { 3, 5 }, { 8, 8 }, { 9, 17 }, { 64, 3 }, { 100, 130 } }; \
+    for (size_t k = 0; k < sizeof(shapes) / sizeof(shapes[0]); k++) { \
+        size_t rows = shapes[k][0], cols = shapes[k][1]; \
+        T* a = malloc(rows * cols * sizeof(T)); \
+        T* b = malloc(rows * cols * sizeof(T)); \
+        for (size_t i = 0; i < rows * cols; i++) a[i] = (T)(i % 101); \
+        array_transpose(b, a, rows, cols); \
+        bool same = true; \
+        for (size_t i = 0; i < rows; i++) for (size_t j = 0; j < cols; j++) same = same && b[j * rows + i] == a[i * cols + j]; \
+        CHECK(same); \
+        free(a); \
+        free(b); \
+    } \
+    for (size_t stride = 1; stride <= 9; stride++) { \
+        size_t n = 37 + stride * 5; \
+        T* records = malloc(n * stride * sizeof(T)); \
+        T* back = malloc(n * stride * sizeof(T)); \
+        for (size_t i = 0; i < n * stride; i++) records[i] = (T)(i % 97); \
+        T** columns = array_columns_alloc(T, stride, n); \
+        CHECK(columns != NULL); \
+        array_deinterleave(columns, records, n, stride); \
+        bool same = true; \
+        for (size_t i = 0; i < n; i++) for (size_t c = 0; c < stride; c++) same = same && columns[c][i] == records[i * stride + c]; \
+        CHECK(same); \
+        array_interleave(back, columns, n, stride); \
+        same = true; \
+        for (size_t i = 0; i < n * stride; i++) same = same && back[i] == records[i]; \
+        CHECK(same); \
+        CHECK(allocated_info(columns[0]).alignment >= FLORESTAN_LAYOUT_ALIGN); \
+        array_columns_free(columns); \
+        free(records); \
+        free(back); \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_LAYOUT, )
+    return TEST_RESULT;
+}
@@ -0,0 +1,61 @@
+// Florestan's Tests: thread pool and parallel arrays
+//
+// ctest runs this with FLORESTAN_THREADS=4, so the default pool has workers even on a single CPU.
+
+#include "test.h"
+#include "florestan/parallel.h"
+#include <stdatomic.h>
+
+static atomic_int __test_hits[100000];
+
+static void __test_mark(void* context, size_t begin, size_t end, size_t worker) {
+    CHECK(worker < thread_pool_threads((thread_pool*)context));
+    for (size_t i = begin; i < end; i++) atomic_fetch_add_explicit(&__test_hits[i], 1, memory_order_relaxed);
+}
+
+static double __test_twice(double x) {
+    return 2 * x;
+}
+
+// A task of the default pool that runs the default pool again, through parallel_reduce().
+typedef struct __test_nested { const int* numbers; size_t count; long long sums[16]; } test_nested;
+static void __test_nest(void* context, size_t begin, size_t end, size_t worker) {
+    (void)worker;
+    test_nested* c = context;
+    for (size_t i = begin; i < end; i++) c->sums[i] = parallel_reduce(sum, c->numbers, c->count);
+}
+
+int main(void) {
+    thread_pool* pool = thread_pool_create(3);
+    CHECK(pool && thread_pool_threads(pool) == 3);
+    thread_pool_run(pool, __test_mark, pool, 100000, 1000);
+    thread_pool_run(pool, __test_mark, pool, 100000, 0);
+    bool twice = true;
+    for (size_t i = 0; i < 100000; i++) twice = twice && atomic_load(&__test_hits[i]) == 2;
+    CHECK(twice);
+    thread_pool_destroy(pool);
+
+    size_t n = 4 * FLORESTAN_PARALLEL_MIN + 3;
+    int* numbers = malloc(n * sizeof(int));
+    double* doubles = malloc(n * sizeof(double));
+    CHECK(thread_pool_threads(thread_pool_default()) == 4);
+    parallel_fill(numbers, -2, n);
+    CHECK(parallel_reduce(sum, numbers, n) == -2 * (long long)n);
+    for (size_t i = 0; i < n; i++) numbers[i] = (int)(i % 1000) - 500;
+    numbers[n / 3] = -7777;
+    numbers[n - 1] = 8888;
+    CHECK(parallel_reduce(sum, numbers, n) == array_sum(numbers, n));
+    CHECK(parallel_reduce(min, numbers, n) == -7777 && parallel_reduce(max, numbers, n) == 8888);
+    test_nested nested = { numbers, n, { 0 } };
+    thread_pool_run(thread_pool_default(), __test_nest, &nested, 16, 1);
+    bool same = true;
+    for (size_t i = 0; i < 16; i++) same = same && nested.sums[i] == array_sum(numbers, n);
+    CHECK(same);
+    for (size_t i = 0; i < n; i++) doubles[i] = (double)(i % 100);
+    double before = array_sum(doubles, n);
+    parallel_map(doubles, doubles, __test_twice, n);
+    CHECK(parallel_reduce(sum, doubles, n) == 2 * before && doubles[n - 1] == 2.0 * ((n - 1) % 100));
+    free(numbers);
+    free(doubles);
+    return TEST_RESULT;
+}
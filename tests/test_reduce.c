@@ -0,0 +1,45 @@
+// Florestan's Tests: reductions
+
+#include "test.h"
+#include "florestan/array_reduce.h"
+
+// Small values (negative ones too, for the signed types), so every sum is exact in every type, floats included.
+#define __TEST_REDUCE(NAME, T, ...) { \
+    static const size_t sizes[] = { 1, 3, 8, 17, 33, 64, 100, 1001 }; \
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) { \
+        size_t n = sizes[k]; \
+        uint64_t state = n; \
+        T* a = malloc(n * sizeof(T)); \
+        T* b = malloc(n * sizeof(T)); \
+        long double sum = 0, dot = 0; \
+        T low = 0, high = 0; \
+        for (size_t i = 0; i < n; i++) { \
+            a[i] = (T)((long long)(test_random(&state) % 100) - ((T)-1 < (T)1 ? 50 : 0)); \
+            b[i] = (T)(test_random(&state) % 10); \
+            sum += a[i]; \
+            dot += (long double)a[i] * b[i]; \
+            if (i == 0 || a[i] < low) low = a[i]; \
+            if (i == 0 || a[i] > high) high = a[i]; \
+        } \
+        CHECK((long double)array_sum(a, n) == sum); \
+        CHECK((long double)array_dot(a, b, n) == dot); \
+        CHECK(array_min(a, n) == low); \
+        CHECK(array_max(a, n) == high); \
+        /* an unaligned start, so the vector kernels begin with a scalar head */ \
+        if (n > 1) CHECK((long double)array_sum(a + 1, n - 1) == sum - a[0]); \
+        T m1, m2; \
+        array_minmax(a, n, &m1, &m2); \
+        CHECK(m1 == low && m2 == high); \
+        free(a); \
+        free(b); \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_REDUCE, )
+    float empty[1] = { 0 };
+    CHECK(array_min(empty, 0) > 1e30f && array_max(empty, 0) < -1e30f);
+    int numbers[] = { 3, -1, 4, -1, 5 };
+    CHECK(array_sum(numbers) == 10);
+    return TEST_RESULT;
+}
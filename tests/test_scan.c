@@ -0,0 +1,82 @@
+// Florestan's Tests: scans
+
+#include "test.h"
+#include "florestan/array_scan.h"
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#define __TEST_HISTOGRAM(T, a, n, LOW, HIGH, BINS) do { \
+    size_t bins[BINS] = { 0 }, expected[BINS] = { 0 }, inside = 0; \
+    const T low = (T)LOW; /* not the literal: a[i] < 0 warns for unsigned T */ \
+    for (size_t i = 0; i < n; i++) { \
+        if (a[i] < low || a[i] >= HIGH) continue; \
+        size_t bin = (T)0.5 ? (size_t)((a[i] - (T)LOW) * ((T)BINS / (T)(HIGH - LOW))) \
+                            : (size_t)((a[i] - LOW) * BINS / (HIGH - LOW)); \
+        expected[bin < BINS ? bin : BINS - 1]++; \
+        inside++; \
+    } \
+    CHECK(array_histogram(a, n, bins, (T)LOW, (T)HIGH, BINS) == inside); \
+    CHECK(memcmp(bins, expected, sizeof bins) == 0); \
+} while (0)
+
+#define __TEST_SCAN(NAME, T, ...) { \
+    static const size_t sizes[] = { 1, 5, 8, 16, 31, 64, 257, 3000 }; \
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) { \
+        size_t n = sizes[k]; \
+        uint64_t state = 3 * n + 5; \
+        T* a = malloc(n * sizeof(T)); \
+        T* sums = malloc(n * sizeof(T)); \
+        for (size_t i = 0; i < n; i++) a[i] = (T)(test_random(&state) % 100); \
+        /* prefix sums, wrapping in the type itself for integers (unsigned arithmetic, so the test wraps too) */ \
+        array_prefix_sum(sums, a, n); \
+        bool same = true; \
+        T running = 0; \
+        for (size_t i = 0; i < n; i++) { \
+            running = (T)0.5 ? (T)(running + a[i]) : (T)(unsigned long long)((unsigned long long)running + (unsigned long long)a[i]); \
+            same = same && sums[i] == running; \
+        } \
+        CHECK(same); \
+        /* in place, the same sums (compared by value: long double has padding bytes) */ \
+        array_prefix_sum(a, a, n); \
+        same = true; \
+        for (size_t i = 0; i < n; i++) same = same && a[i] == sums[i]; \
+        CHECK(same); \
+        for (size_t i = 0; i < n; i++) a[i] = (T)(test_random(&state) % 100); \
+        /* histograms against the same bin arithmetic written out: for integers, bins of a whole width, */ \
+        /* of a power-of-two width, and neither */ \
+        __TEST_HISTOGRAM(T, a, n, 10, 90, 16); \
+        __TEST_HISTOGRAM(T, a, n, 0, 64, 8); \
+        __TEST_HISTOGRAM(T, a, n, 3, 98, 7); \
+        /* a partition around 50: the same elements, the smaller ones first */ \
+        long double before = 0, after = 0; \
+        size_t less = 0; \
+        for (size_t i = 0; i < n; i++) { before += a[i]; less += a[i] < (T)50; } \
+        size_t split = array_partition(a, n, (T)50); \
+        CHECK(split == less); \
+        bool ordered = true; \
+        for (size_t i = 0; i < n; i++) { after += a[i]; ordered = ordered && (i < split ? a[i] < (T)50 : a[i] >= (T)50); } \
+        CHECK(ordered && before == after); \
+        free(a); \
+        free(sums); \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_SCAN, )
+    float values[] = { 1, NAN, -3, 7, NAN, 2 };
+    CHECK(array_partition(values, 2.5f) == 3);
+    CHECK(isnan(values[3]) + isnan(values[4]) + isnan(values[5]) == 2);
+    size_t bins[4] = { 0 };
+    CHECK(array_histogram(values, 6, bins, 0.0f, 8.0f) == 3);
+    // HIGH - LOW overflows: each bin is still a quarter of the range
+    float wide[] = { -FLT_MAX, FLT_MAX * -0.125f, 1, FLT_MAX * 0.75f, FLT_MAX, 0 };
+    size_t wide_bins[4] = { 0 };
+    CHECK(array_histogram(wide, 6, wide_bins, -FLT_MAX, FLT_MAX) == 5);
+    CHECK(wide_bins[0] == 1 && wide_bins[1] == 1 && wide_bins[2] == 2 && wide_bins[3] == 1);
+    double wider[] = { -DBL_MAX, DBL_MAX * -0.25, DBL_MAX * 0.25, DBL_MAX * 0.5 };
+    size_t wider_bins[4] = { 0 };
+    CHECK(array_histogram(wider, 4, wider_bins, -DBL_MAX, DBL_MAX) == 4);
+    CHECK(wider_bins[0] == 1 && wider_bins[1] == 1 && wider_bins[2] == 1 && wider_bins[3] == 1);
+    return TEST_RESULT;
+}
@@ -0,0 +1,40 @@
+// Florestan's Tests: searches
+
+#include "test.h"
+#include "florestan/array_sort.h"
+#include "florestan/array_search.h"
+
+// Even numbers from a sorted random walk, so that every odd key falls between two elements.
+#define __TEST_SEARCH(NAME, T, ...) { \
+    static const size_t sizes[] = { 0, 1, 2, 7, 16, 33, 100, 1000 }; \
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) { \
+        size_t n = sizes[k]; \
+        uint64_t state = n + 11; \
+        T* a = malloc((n ? n : 1) * sizeof(T)); \
+        T* e = malloc((n ? n : 1) * sizeof(T)); \
+        for (size_t i = 0; i < n; i++) a[i] = (T)(2 * (test_random(&state) % 60)); \
+        array_sort(a, n); \
+        array_eytzinger_build(e, a, n); \
+        bool right = true; \
+        for (int key = -1; key <= 121; key++) { \
+            if ((T)-1 > (T)0 && key < 0) continue; \
+            size_t expected = 0; \
+            while (expected < n && a[expected] < (T)key) expected++; \
+            right = right && array_lower_bound(a, n, key) == expected; \
+            right = right && array_contains(a, n, key) == (expected < n && a[expected] == (T)key); \
+            size_t slot = array_eytzinger_lower_bound(e, n, key); \
+            right = right && (expected == n ? slot == n : slot < n && e[slot] == a[expected]); \
+            right = right && array_eytzinger_contains(e, n, key) == (expected < n && a[expected] == (T)key); \
+        } \
+        CHECK(right); \
+        free(a); \
+        free(e); \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_SEARCH, )
+    int sorted[] = { 1, 3, 3, 3, 9 };
+    CHECK(array_lower_bound(sorted, 3) == 1 && array_lower_bound(sorted, 10) == 5 && !array_contains(sorted, 4));
+    return TEST_RESULT;
+}
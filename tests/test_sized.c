@@ -0,0 +1,34 @@
+// Florestan's Tests: sized mode
+//
+// Built with FLORESTAN_SIZED_ALLOC: alloc_sizeof() and allocated_info() read the header of sized_ blocks.
+
+#include "test.h"
+#include "florestan/type_traits.h"
+#include "florestan/aligned_array.h"
+#include "florestan/vector.h"
+
+int main(void) {
+    long* numbers = sized_new(long, 33);
+    CHECK(alloc_sizeof(numbers) == 33 * sizeof(long));
+    allocated_record record = allocated_info(numbers);
+    CHECK(record.method == allocated && record.arraysize == 33 && record.typesize == sizeof(long));
+    CHECK(sized_info(numbers)->type_id == type_id((long)0) && sized_info(numbers)->count == 33);
+    numbers = sized_realloc(numbers, 50 * sizeof(long));
+    CHECK(sized_info(numbers)->count == 50 && sized_info(numbers)->typesize == sizeof(long));
+    sized_free(numbers);
+
+    void* bytes = sized_malloc(13);
+    CHECK(alloc_sizeof(bytes) == 13 && sized_info(bytes)->typesize == 1);
+    sized_free(bytes);
+    CHECK(alloc_sizeof((int*)NULL) == 0 && allocated_info((int*)NULL).method == dynamic);
+
+    double* aligned = aligned_array_alloc(double, 21, 256);
+    CHECK(allocated_info(aligned).arraysize == 21 && allocated_info(aligned).alignment >= 256);
+    aligned_array_free(aligned);
+
+    vector(short) v = { 0 };
+    for (int i = 0; i < 100; i++) vector_push(&v, (short)i);
+    CHECK(allocated_info(v.data).arraysize == v.capacity);
+    vector_free(&v);
+    return TEST_RESULT;
+}
@@ -0,0 +1,49 @@
+// Florestan's Tests: sorting
+//
+// Every type, at sizes on both sides of FLORESTAN_SORT_RADIX_MIN, against qsort of the same values.
+
+#include "test.h"
+#include "florestan/array_sort.h"
+#include <math.h>
+#include <string.h>
+
+#define __TEST_SORT_COMPARE(NAME, T, ...) \
+static int __test_compare_##NAME(const void* x, const void* y) { \
+    T a = *(const T*)x, b = *(const T*)y; \
+    return (a > b) - (a < b); \
+}
+TEST_TYPES(__TEST_SORT_COMPARE, )
+
+#define __TEST_SORT(NAME, T, ...) { \
+    static const size_t sizes[] = { 0, 1, 2, 15, 64, 255, 1000, 5000 }; \
+    for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) { \
+        size_t n = sizes[k]; \
+        uint64_t state = 7 * n + 1; \
+        T* a = malloc((n ? n : 1) * sizeof(T)); \
+        T* expected = malloc((n ? n : 1) * sizeof(T)); \
+        for (size_t i = 0; i < n; i++) { \
+            /* half of them full range, half small, so both the radix passes and their skipping are covered */ \
+            long long r = (long long)test_random(&state); \
+            a[i] = i % 2 ? (T)r : (T)(r % 1000); \
+        } \
+        memcpy(expected, a, n * sizeof(T)); \
+        qsort(expected, n, sizeof(T), __test_compare_##NAME); \
+        array_sort(a, n); \
+        bool same = true; \
+        for (size_t i = 0; i < n; i++) same = same && a[i] == expected[i]; \
+        CHECK(same); \
+        free(a); \
+        free(expected); \
+    } \
+}
+
+int main(void) {
+    TEST_TYPES(__TEST_SORT, )
+    double special[] = { 1.0, NAN, -0.0, INFINITY, -INFINITY, 0.0, -NAN, -2.5 };
+    array_sort(special);
+    CHECK(isnan(special[0]) && signbit(special[0]));
+    CHECK(special[1] == -INFINITY && special[2] == -2.5);
+    CHECK(special[3] == 0 && signbit(special[3]) && special[4] == 0 && !signbit(special[4]));
+    CHECK(special[5] == 1.0 && special[6] == INFINITY && isnan(special[7]) && !signbit(special[7]));
+    return TEST_RESULT;
+}
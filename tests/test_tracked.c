@@ -0,0 +1,107 @@
+// Florestan's Tests: tracked mode
+//
+// Built with FLORESTAN_TRACKED_ALLOC, FLORESTAN_HEAP_PROFILE and FLORESTAN_COUNTERS: what allocated_info() reports
+// for every florestan allocator through the registry, what the hooks count, and what the heap profile writes.
+
+#include "test.h"
+#include "florestan/type_traits.h"
+#include "florestan/arena.h"
+#include "florestan/slab.h"
+#include "florestan/ndarray.h"
+#include "florestan/array_file.h"
+#include "florestan/array_reduce.h"
+#include "florestan/counters.h"
+#include "florestan/heap_profile.h"
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct __test_node {
+    struct __test_node* next;
+    int value;
+} test_node;
+
+static bool __test_file_has(const char* path, const char* text) {
+    FILE* file = fopen(path, "r");
+    if (file == NULL) return false;
+    char line[512];
+    bool found = false;
+    while (!found && fgets(line, sizeof line, file)) found = strstr(line, text) != NULL;
+    fclose(file);
+    return found;
+}
+
+// The only allocation of its thread, so the first one its countdown sees; at 1 MiB, it is sampled almost surely.
+static const char* __test_first_site;
+static void* __test_first_allocation(void* unused) {
+    (void)unused;
+    __test_first_site = FLORESTAN_CALL_SITE; void* p = tracked_malloc(1 << 20);
+    tracked_free(p);
+    return NULL;
+}
+
+int main(void) {
+    heap_profile_rate(64);
+    counters_reset();
+
+    int* numbers = tracked_calloc(10, sizeof(int));
+    allocated_record record = allocated_info(numbers);
+    CHECK(record.method == allocated && record.arraysize == 10 && record.totalsize == 10 * sizeof(int));
+    CHECK(allocated_info(numbers + 3).arraysize == 7);
+    void* untyped = numbers;
+    CHECK(allocated_info(untyped).typesize == sizeof(int));
+    numbers = tracked_realloc(numbers, 1000 * sizeof(int));
+    CHECK(allocated_info(numbers).arraysize == 1000 && allocated_info(numbers + 999).arraysize == 1);
+    for (int i = 0; i < 1000; i++) numbers[i] = i;
+    CHECK(array_sum(numbers) == 999 * 1000 / 2);
+    CHECK(counters_get("array_sum", "int").calls == 1 && counters_get("array_sum", "int").bytes == 1000 * sizeof(int));
+    CHECK(counters_get("allocated_info", NULL).calls >= 5);
+    tracked_free(numbers);
+    void* gone = tracked_malloc(64);
+    allocated_block freed;
+    CHECK(tracked_realloc(gone, 0) == NULL && !__registry_lookup(gone, &freed));
+
+    memory_arena scratch;
+    arena_init(&scratch, 0);
+    double* block = arena_new(&scratch, double, 40);
+    record = allocated_info(block + 10);
+    CHECK(record.method == arena && record.arraysize == 30 && record.typesize == sizeof(double));
+    arena_destroy(&scratch);
+
+    test_node* node = slab_new(test_node);
+    record = allocated_info(node);
+    CHECK(record.method == slab && record.totalsize >= sizeof(test_node));
+    slab_free(node);
+
+    float** grid = ndarray_alloc(float, 16, 32);
+    record = allocated_info(grid);
+    CHECK(record.method == ndarray && record.arraysize == 16 * 32 && record.shape == ndarray_info(grid));
+    CHECK(allocated_info(&grid[1][0]).arraysize == 15 * 32 && allocated_info(&grid[1][0]).shape == NULL);
+    ndarray_free(grid);
+
+    char path[] = "/tmp/florestan_test_XXXXXX";
+    int descriptor = mkstemp(path);
+    close(descriptor);
+    short values[77] = { 1, 2, 3 };
+    CHECK(array_save(path, values));
+    const short* saved = array_map(path, short);
+    CHECK(saved && allocated_info(saved).method == mapped && allocated_info(saved).arraysize == 77);
+    array_unmap(saved);
+
+    char profile[] = "/tmp/florestan_profile_XXXXXX";
+    descriptor = mkstemp(profile);
+    close(descriptor);
+    for (int i = 0; i < 200; i++) tracked_free(tracked_malloc(4096));
+    CHECK(heap_profile_dump(profile));
+    CHECK(__test_file_has(profile, "test_tracked.c"));
+    heap_profile_reset();
+    pthread_t thread;
+    CHECK(pthread_create(&thread, NULL, __test_first_allocation, NULL) == 0);
+    pthread_join(thread, NULL);
+    CHECK(heap_profile_dump(profile));
+    CHECK(__test_first_site && __test_file_has(profile, __test_first_site));
+    heap_profile_reset();
+    remove(profile);
+    remove(path);
+    return TEST_RESULT;
+}
@@ -0,0 +1,41 @@
+// Florestan's Tests: type traits
+
+#include "test.h"
+#include "florestan/type_traits.h"
+#include <string.h>
+
+int main(void) {
+    int i = 0;
+    const int c = 0;
+    unsigned long long u = 0;
+    long double ld = 0;
+    char** strings = NULL;
+    const void* raw = NULL;
+    CHECK(__is_int(i) && !__is_uint(i));
+    CHECK(__is_ullong(u) && __is_ldouble(ld));
+    CHECK(__is_const(c) && !__is_const(i));
+    CHECK(__pointer_depth(i) == 0 && __pointer_depth(strings) == 2 && __pointer_depth(raw) == 1);
+    CHECK(__sizeof(strings) == sizeof(char) && __sizeof(ld) == sizeof(long double) && __sizeof(raw) == 0);
+    CHECK(type_id(i) == type_id(c) && type_id(i) != type_id(u) && type_id(i) != 0);
+    CHECK(type_id((struct { int x; }){ 0 }) == 0);
+    CHECK(strcmp(type_name(i), "int") == 0);
+    CHECK(strcmp(type_name(strings), "char **") == 0);
+    CHECK(strcmp(type_name(raw), "const void *") == 0);
+    CHECK(type_info(u).type_class == integer_type && !type_info(u).is_signed);
+    CHECK(type_info(ld).type_class == floating_type && type_info(ld).size == sizeof(long double));
+    CHECK(type_info(raw).type_class == void_type && type_info(raw).is_const);
+    for (int id = 1; id < FLORESTAN_TYPE_COUNT; id++) CHECK(__type_descriptors[id].name != NULL);
+
+    int numbers[12] = { 0 };
+    allocated_record record = allocated_info(numbers);
+    CHECK(record.method == fixed && record.arraysize == 12 && record.typesize == sizeof(int) && record.totalsize == sizeof numbers);
+    CHECK(!__is_allocated(numbers));
+    double* heap = malloc(100 * sizeof(double));
+    record = allocated_info(heap);
+#if defined(__linux__) || defined(__APPLE__) || defined(_WIN32)
+    CHECK(record.method == allocated && record.arraysize >= 100 && record.typesize == sizeof(double));
+#endif
+    CHECK(record.alignment >= _Alignof(double) && record.pointer_depth == 1);
+    free(heap);
+    return TEST_RESULT;
+}